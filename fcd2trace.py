@@ -0,0 +1,206 @@
+#!/usr/bin/env python
+
+#
+# fcd2trace.py -- converts SUMO FCD output to a binary mobility trace
+# Copyright (C) 2019 The Veins authors
+#
+# Documentation for these modules is at http://veins.car2x.org/
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+#
+
+"""
+Converts floating car data written by SUMO (sumo --fcd-output) to a binary
+mobility trace that can be played back by TraCIScenarioManagerTrace.
+
+FCD output does not contain vehicle dimensions, so these are read from the
+vType definitions in the given route or additional files (falling back to
+SUMO's defaults for passenger cars). Likewise, the network boundary is read
+from the given network (falling back to the bounding box of all positions in
+the trace), so it should be given to get the same coordinates as when
+connecting to SUMO.
+
+The layout of the trace is documented in TraCIScenarioManagerTrace.cc.
+"""
+
+import argparse
+import struct
+import sys
+
+try:
+    import xml.etree.cElementTree as ElementTree
+except ImportError:
+    import xml.etree.ElementTree as ElementTree
+
+TRACE_MAGIC = b'VEINSTRC'
+TRACE_VERSION = 1
+TRACE_BYTE_ORDER_MARK = 0x01020304
+
+HEADER = struct.Struct('<8sII4dIIIIQQQQQ')
+VEHICLE_RECORD = struct.Struct('<dddII')
+STEP_RECORD = struct.Struct('<dIIQ')
+
+DEFAULT_LENGTH = 5.0
+DEFAULT_WIDTH = 1.8
+DEFAULT_HEIGHT = 1.5
+
+
+class StringTable(object):
+    """
+    NUL-terminated strings, each stored once
+    """
+
+    def __init__(self):
+        self.offsets = {}
+        self.data = bytearray()
+
+    def add(self, s):
+        if s not in self.offsets:
+            self.offsets[s] = len(self.data)
+            self.data += s.encode('utf-8') + b'\0'
+        return self.offsets[s]
+
+
+def read_vtypes(file_names):
+    """
+    returns a map from vType id to (length, width, height)
+    """
+    vtypes = {}
+    for file_name in file_names:
+        for _, elem in ElementTree.iterparse(file_name):
+            if elem.tag == 'vType':
+                vtypes[elem.get('id')] = (float(elem.get('length', DEFAULT_LENGTH)), float(elem.get('width', DEFAULT_WIDTH)), float(elem.get('height', DEFAULT_HEIGHT)))
+            elem.clear()
+    return vtypes
+
+
+def read_net_boundary(file_name):
+    """
+    returns the boundary (x1, y1, x2, y2) of a network, as reported by TraCI
+    """
+    for _, elem in ElementTree.iterparse(file_name):
+        if elem.tag == 'location':
+            return tuple(float(v) for v in elem.get('convBoundary').split(','))
+    raise ValueError('network %s does not specify its boundary' % file_name)
+
+
+def edge_of(elem):
+    """
+    returns the edge a vehicle of the FCD output is on
+    """
+    lane = elem.get('lane')
+    if lane is None:
+        # mesoscopic simulation
+        return elem.get('edge', '')
+    return lane.rsplit('_', 1)[0]
+
+
+def pad(out):
+    """
+    pads the output to a multiple of 8 bytes
+    """
+    position = out.tell()
+    if position % 8 != 0:
+        out.write(b'\0' * (8 - position % 8))
+
+
+def convert(fcd_file, out, vtypes, net_boundary):
+    strings = StringTable()
+    vehicles = {}  # vehicle id -> (index, type id)
+    vehicle_records = []
+    edges = {}  # edge name -> index
+    edge_offsets = []
+    steps = []
+    bounds = [float('inf'), float('inf'), float('-inf'), float('-inf')]
+
+    out.write(b'\0' * HEADER.size)
+
+    for _, elem in ElementTree.iterparse(fcd_file):
+        if elem.tag != 'timestep':
+            continue
+
+        columns = ([], [], [], [], [], [])
+        for v in elem.iter('vehicle'):
+            vehicle_id = v.get('id')
+            if vehicle_id not in vehicles:
+                type_id = v.get('type', 'DEFAULT_VEHTYPE')
+                length, width, height = vtypes.get(type_id, (DEFAULT_LENGTH, DEFAULT_WIDTH, DEFAULT_HEIGHT))
+                vehicles[vehicle_id] = len(vehicle_records)
+                vehicle_records.append((length, width, height, strings.add(vehicle_id), strings.add(type_id)))
+            edge = edge_of(v)
+            if edge not in edges:
+                edges[edge] = len(edge_offsets)
+                edge_offsets.append(strings.add(edge))
+
+            x = float(v.get('x'))
+            y = float(v.get('y'))
+            bounds = [min(bounds[0], x), min(bounds[1], y), max(bounds[2], x), max(bounds[3], y)]
+            columns[0].append(x)
+            columns[1].append(y)
+            columns[2].append(float(v.get('angle')))
+            columns[3].append(float(v.get('speed')))
+            columns[4].append(vehicles[vehicle_id])
+            columns[5].append(edges[edge])
+
+        count = len(columns[0])
+        pad(out)
+        steps.append((float(elem.get('time')), count, out.tell()))
+        for column in columns[:4]:
+            out.write(struct.pack('<%dd' % count, *column))
+        for column in columns[4:]:
+            out.write(struct.pack('<%dI' % count, *column))
+        elem.clear()
+
+    if net_boundary is None:
+        if not vehicle_records:
+            raise ValueError('trace is empty, cannot determine network boundary')
+        net_boundary = bounds
+
+    pad(out)
+    vehicle_table_offset = out.tell()
+    for record in vehicle_records:
+        out.write(VEHICLE_RECORD.pack(*record))
+    edge_table_offset = out.tell()
+    out.write(struct.pack('<%dI' % len(edge_offsets), *edge_offsets))
+    strings.add('')
+    strings_offset = out.tell()
+    out.write(strings.data)
+    step_table_offset = out.tell()
+    for step in steps:
+        out.write(STEP_RECORD.pack(step[0], step[1], 0, step[2]))
+
+    out.seek(0)
+    out.write(HEADER.pack(TRACE_MAGIC, TRACE_VERSION, TRACE_BYTE_ORDER_MARK, net_boundary[0], net_boundary[1], net_boundary[2], net_boundary[3], len(vehicle_records), len(edge_offsets), len(steps), 0, vehicle_table_offset, edge_table_offset, strings_offset, len(strings.data), step_table_offset))
+
+    return len(vehicle_records), len(steps)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Converts SUMO FCD output to a binary mobility trace for TraCIScenarioManagerTrace.')
+    parser.add_argument('fcd', help='FCD output of SUMO (sumo --fcd-output)')
+    parser.add_argument('trace', help='binary mobility trace to write')
+    parser.add_argument('-n', '--net', help='SUMO network the FCD output was recorded in (to read the network boundary from)')
+    parser.add_argument('-a', '--vtypes', action='append', default=[], help='route or additional file to read vType dimensions from (can be given multiple times)')
+    args = parser.parse_args()
+
+    vtypes = read_vtypes(args.vtypes)
+    net_boundary = read_net_boundary(args.net) if args.net else None
+    with open(args.trace, 'wb') as out:
+        vehicle_count, step_count = convert(args.fcd, out, vtypes, net_boundary)
+    sys.stderr.write('wrote %d vehicles in %d timesteps to %s\n' % (vehicle_count, step_count, args.trace))
+
+
+if __name__ == '__main__':
+    main()
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "veins/base/connectionManager/BaseConnectionManager.h"
 
 #include "veins/base/connectionManager/NicEntryDebug.h"
@@ -203,6 +205,65 @@ void BaseConnectionManager::checkGrid(BaseConnectionManager::GridCoord& oldCell,
     }
 }
 
+bool BaseConnectionManager::hasNicsNear(const Coord& pos, int excludeNicID)
+{
+    // positions outside the playground count as being in the closest cell
+    GridCoord cell = getCellForCoordinate(pos);
+    cell.x = std::max(0, std::min(cell.x, gridDim.x - 1));
+    cell.y = std::max(0, std::min(cell.y, gridDim.y - 1));
+    cell.z = std::max(0, std::min(cell.z, gridDim.z - 1));
+
+    CoordSet gridUnion(74);
+    if ((gridDim.x == 1) && (gridDim.y == 1) && (gridDim.z == 1)) {
+        gridUnion.add(cell);
+    }
+    else {
+        fillUnionWithNeighbors(gridUnion, cell);
+    }
+
+    GridCoord* c = gridUnion.next();
+    while (c != nullptr) {
+        for (auto& entry : getCellEntries(*c)) {
+            if (entry.first != excludeNicID) return true;
+        }
+        c = gridUnion.next();
+    }
+    return false;
+}
+
+bool BaseConnectionManager::hasNicsWithin(const Coord& pos, double distance)
+{
+    double maxDistSquared = distance * distance;
+    if (useTorus) {
+        for (auto& entry : nics) {
+            if (entry.second->pos.sqrdist(pos) <= maxDistSquared) return true;
+        }
+        return false;
+    }
+
+    Coord extent(distance, distance, distance);
+    GridCoord first = getCellForCoordinate(pos - extent);
+    GridCoord last = getCellForCoordinate(pos + extent);
+    first.x = std::max(0, first.x);
+    first.y = std::max(0, first.y);
+    first.z = std::max(0, first.z);
+    last.x = std::min(last.x, gridDim.x - 1);
+    last.y = std::min(last.y, gridDim.y - 1);
+    last.z = std::min(last.z, gridDim.z - 1);
+
+    for (int x = first.x; x <= last.x; ++x) {
+        for (int y = first.y; y <= last.y; ++y) {
+            for (int z = first.z; z <= last.z; ++z) {
+                GridCoord cell(x, y, z);
+                for (auto& entry : getCellEntries(cell)) {
+                    if (entry.second->pos.sqrdist(pos) <= maxDistSquared) return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
 int BaseConnectionManager::wrapIfTorus(int value, int max)
 {
     if (value < 0) {
@@ -399,6 +399,21 @@ public:
     /** @brief Updates the position information of a registered nic.*/
     void updateNicPos(int nicID, Coord newPos, Heading heading);
 
+    /**
+     * @brief Returns whether any registered nic (other than the one with id excludeNicID) is in the grid cell of pos or a neighboring one.
+     *
+     * Grid cells are at least as large as the maximum interference distance, so this is a cheap, conservative check
+     * of whether a nic at pos could interfere with any other.
+     */
+    bool hasNicsNear(const Coord& pos, int excludeNicID = -1);
+
+    /**
+     * @brief Returns whether any registered nic is at most distance away from pos.
+     *
+     * Only visits the grid cells overlapping the square around pos (or, on a torus, all nics).
+     */
+    bool hasNicsWithin(const Coord& pos, double distance);
+
     /** @brief Returns the ingates of all nics in range*/
     const NicEntry::GateList& getGateList(int nicID) const;
 
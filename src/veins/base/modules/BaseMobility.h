@@ -185,6 +185,12 @@ public:
         return move.getDirection();
     }
 
+    /** @brief Returns the rate at which the current direction turns (in radians per second). */
+    virtual double getCurrentYawRate() const
+    {
+        return move.getYawRate();
+    }
+
 protected:
     /**
      * @brief Maps the passed icon size tag (is) to an actual size in pixels.
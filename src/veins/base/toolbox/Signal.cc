@@ -38,6 +38,7 @@ Signal::Signal(const Signal& other)
     , propagationDelay(other.propagationDelay)
     , analogueModelList(other.analogueModelList)
     , numAnalogueModelsApplied(other.numAnalogueModelsApplied)
+    , undecodable(other.undecodable)
     , senderPoa(other.senderPoa)
     , receiverPoa(other.receiverPoa)
 {
@@ -177,36 +178,74 @@ void Signal::setCenterFrequencyIndex(size_t index)
 
 bool Signal::greaterAtCenterFrequency(double threshold)
 {
-    if (values[centerFrequencyIndex] < threshold) return false;
+    if (undecodable || (values[centerFrequencyIndex] < threshold)) return false;
 
     uint16_t maxAnalogueModels = analogueModelList->size();
 
+    powerThreshold = threshold;
     while (numAnalogueModelsApplied < maxAnalogueModels) {
         // Apply filter here
         (*analogueModelList)[numAnalogueModelsApplied]->filterSignal(this);
+        if (undecodable) {
+            // the model left the signal unchanged, so it is applied again (exactly) once the signal's power is needed
+            powerThreshold = 0;
+            return false;
+        }
         numAnalogueModelsApplied++;
 
-        if (values[centerFrequencyIndex] < threshold) return false;
+        if (values[centerFrequencyIndex] < threshold) {
+            powerThreshold = 0;
+            return false;
+        }
     }
+    powerThreshold = 0;
     return true;
 }
 
 bool Signal::smallerAtCenterFrequency(double threshold)
 {
-    if (values[centerFrequencyIndex] < threshold) return true;
+    if (undecodable || (values[centerFrequencyIndex] < threshold)) return true;
 
     uint16_t maxAnalogueModels = analogueModelList->size();
 
+    powerThreshold = threshold;
     while (numAnalogueModelsApplied < maxAnalogueModels) {
         // Apply filter here
         (*analogueModelList)[numAnalogueModelsApplied]->filterSignal(this);
+        if (undecodable) {
+            // the model left the signal unchanged, so it is applied again (exactly) once the signal's power is needed
+            powerThreshold = 0;
+            return true;
+        }
         numAnalogueModelsApplied++;
 
-        if (values[centerFrequencyIndex] < threshold) return true;
+        if (values[centerFrequencyIndex] < threshold) {
+            powerThreshold = 0;
+            return true;
+        }
     }
+    powerThreshold = 0;
     return false;
 }
 
+double Signal::getAttenuationBudget() const
+{
+    if (powerThreshold <= 0) return 0;
+    double power = values[centerFrequencyIndex];
+    if (power <= 0) return 0;
+    return powerThreshold / power;
+}
+
+void Signal::markUndecodable()
+{
+    undecodable = true;
+}
+
+bool Signal::isUndecodable() const
+{
+    return undecodable;
+}
+
 uint16_t Signal::getNumAnalogueModelsApplied() const
 {
     return numAnalogueModelsApplied;
@@ -331,6 +370,7 @@ Signal& Signal::operator=(const Signal& other)
 
     analogueModelList = other.getAnalogueModelList();
     numAnalogueModelsApplied = other.getNumAnalogueModelsApplied();
+    undecodable = other.isUndecodable();
     senderPoa = other.getSenderPoa();
     receiverPoa = other.getReceiverPoa();
 
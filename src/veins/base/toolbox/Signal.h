@@ -284,6 +284,29 @@ public:
      * @see AnalogueModel::filterSignal()
      */
     void applyAllAnalogueModels();
+
+    /**
+     * Get the attenuation factor below which this signal drops under the threshold it is currently tested against.
+     *
+     * Only known while smallerAtCenterFrequency() or greaterAtCenterFrequency() apply
+     * (thresholding) AnalogueModels, which never increase power; returns 0 otherwise.
+     * Models may stop computing attenuation exactly once it exceeds this budget.
+     */
+    double getAttenuationBudget() const;
+
+    /**
+     * Mark this signal as undecodable, e.g., because an AnalogueModel found it to be below the threshold.
+     *
+     * Only to be called by an AnalogueModel that leaves the signal unchanged instead of applying itself.
+     * Remaining thresholding AnalogueModels are then skipped; the model is applied again (without budget)
+     * once the signal's power is needed, e.g., for CCA or as interference.
+     */
+    void markUndecodable();
+
+    /**
+     * Returns true if an AnalogueModel marked this signal as undecodable.
+     */
+    bool isUndecodable() const;
     ///@}
 
     /**
@@ -510,6 +533,10 @@ private:
 
     AnalogueModelList* analogueModelList = nullptr;
     uint16_t numAnalogueModelsApplied = 0;
+    /** @brief power threshold thresholding models are currently being applied for (0 if none) */
+    double powerThreshold = 0;
+    /** @brief whether an AnalogueModel found this signal to be undecodable */
+    bool undecodable = false;
 
     POA senderPoa;
     POA receiverPoa;
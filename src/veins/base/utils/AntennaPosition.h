@@ -3,11 +3,12 @@
 #include "veins/veins.h"
 
 #include "veins/base/utils/Coord.h"
+#include "veins/base/utils/Move.h"
 
 namespace Veins {
 
 /**
- * Stores the position of the host's antenna along with its speed, so that it can be linearly extrapolated.
+ * Stores the position of the host's antenna along with its speed (and how fast it turns), so that it can be extrapolated.
  */
 class VEINS_API AntennaPosition {
 
@@ -17,31 +18,51 @@ public:
         , p()
         , v()
         , t()
+        , yawRate(0)
         , undef(true)
     {
     }
 
     /**
-     * Store a position p that changes by v for every second after t.
+     * Store a position p that changes by v for every second after t, with v turning by yawRate radians per second.
      */
-    AntennaPosition(int id, Coord p, Coord v, simtime_t t)
+    AntennaPosition(int id, Coord p, Coord v, simtime_t t, double yawRate = 0)
         : id(id)
         , p(p)
         , v(v)
         , t(t)
+        , yawRate(yawRate)
         , undef(false)
     {
     }
 
     /**
-     * Get the (linearly extrapolated) position at time t.
+     * Get the (extrapolated) position at time t.
      */
     Coord getPositionAt(simtime_t t = simTime()) const
     {
         ASSERT(t >= this->t);
         ASSERT(!undef);
         auto dt = t - this->t;
-        return p + v * dt.dbl();
+        return Move::extrapolatePosition(p, v, yawRate, dt.dbl());
+    }
+
+    /**
+     * Get the time the position was taken at, i.e., the earliest time it can be extrapolated to.
+     */
+    simtime_t getTime() const
+    {
+        ASSERT(!undef);
+        return t;
+    }
+
+    /**
+     * Get the identifier of the antenna (the id of its ChannelAccess module).
+     */
+    int getId() const
+    {
+        ASSERT(!undef);
+        return id;
     }
 
     bool isSameAntenna(const AntennaPosition& o) const
@@ -53,9 +74,10 @@ public:
 
 protected:
     int id; /**< unique identifier of antenna returned by ChannelAccess::getId() */
-    Coord p; /**< position for linear extrapolation */
-    Coord v; /**< speed for linear extrapolation */
-    simtime_t t; /**< time for linear extrapolation */
+    Coord p; /**< position for extrapolation */
+    Coord v; /**< speed for extrapolation */
+    simtime_t t; /**< time for extrapolation */
+    double yawRate; /**< rate at which v turns (in radians per second) */
     bool undef; /**< true if created using default constructor */
 };
 
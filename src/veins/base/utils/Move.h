@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <cmath>
 #include <string>
 
 #include "veins/veins.h"
@@ -49,6 +50,8 @@ protected:
     Coord direction;
     /** @brief speed of the host in meters per second **/
     double speed;
+    /** @brief rate at which direction turns (counterclockwise, i.e., from x towards y) in radians per second **/
+    double yawRate;
 
 public:
     Move()
@@ -58,6 +61,7 @@ public:
         , orientation()
         , direction()
         , speed(0.0)
+        , yawRate(0.0)
     {
     }
     Move(const Move& mSrc)
@@ -67,6 +71,7 @@ public:
         , orientation(mSrc.orientation)
         , direction(mSrc.direction)
         , speed(mSrc.speed)
+        , yawRate(mSrc.yawRate)
     {
     }
 
@@ -86,6 +91,22 @@ public:
         this->speed = speed;
     }
 
+    /**
+     * @brief Returns the rate at which the direction turns in radians per second.
+     */
+    double getYawRate() const
+    {
+        return yawRate;
+    }
+
+    /**
+     * @brief Sets the rate at which the direction turns in radians per second (0: move in a straight line).
+     */
+    void setYawRate(double yawRate)
+    {
+        this->yawRate = yawRate;
+    }
+
     /**
      * @brief Returns the start position.
      */
@@ -203,8 +224,22 @@ public:
         // if speed is very close to 0.0, the host is practically standing still
         if (math::almost_equal(speed, 0.0)) return startPos;
 
-        // otherwise: actualPos = startPos + ( direction * v * t )
-        return startPos + (direction * speed * SIMTIME_DBL(actualTime - startTime));
+        return extrapolatePosition(startPos, direction * speed, yawRate, SIMTIME_DBL(actualTime - startTime));
+    }
+
+    /**
+     * @brief Returns where a host at position p, moving by v per second and turning by yawRate radians per second, is dt seconds later.
+     *
+     * Without turning, this is p + v * dt. Otherwise, the host moves along a circular arc (at constant speed).
+     */
+    static Coord extrapolatePosition(const Coord& p, const Coord& v, double yawRate, double dt)
+    {
+        if (yawRate == 0) return p + v * dt;
+
+        // integrate v, rotated by yawRate * t, over [0, dt]
+        double angle = yawRate * dt;
+        Coord normal(-v.y, v.x, 0);
+        return p + (v * std::sin(angle) + normal * (1 - std::cos(angle))) / yawRate;
     }
     virtual const Coord& getStartPosition() const
     {
@@ -220,7 +255,7 @@ public:
     {
         std::ostringstream ost;
         ost << " HostMove "
-            << " startPos: " << startPos.info() << " direction: " << direction.info() << " orientation: " << orientation.info() << " startTime: " << startTime << " speed: " << speed;
+            << " startPos: " << startPos.info() << " direction: " << direction.info() << " orientation: " << orientation.info() << " startTime: " << startTime << " speed: " << speed << " yawRate: " << yawRate;
         return ost.str();
     }
 };
@@ -18,17 +18,23 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
 
+#include <algorithm>
+
 #include "veins/modules/analogueModel/SimpleObstacleShadowing.h"
+#include "veins/base/connectionManager/BaseConnectionManager.h"
+#include "veins/base/connectionManager/ChannelAccess.h"
 
 using namespace Veins;
 
 using Veins::AirFrame;
 
-SimpleObstacleShadowing::SimpleObstacleShadowing(cComponent* owner, ObstacleControl& obstacleControl, bool useTorus, const Coord& playgroundSize)
+SimpleObstacleShadowing::SimpleObstacleShadowing(cComponent* owner, ObstacleControl& obstacleControl, bool useTorus, const Coord& playgroundSize, bool batchReceivers, bool useAttenuationBudget)
     : AnalogueModel(owner)
     , obstacleControl(obstacleControl)
     , useTorus(useTorus)
     , playgroundSize(playgroundSize)
+    , batchReceivers(batchReceivers)
+    , useAttenuationBudget(useAttenuationBudget)
 {
     if (useTorus) throw cRuntimeError("SimpleObstacleShadowing does not work on torus-shaped playgrounds");
 }
@@ -38,9 +44,81 @@ void SimpleObstacleShadowing::filterSignal(Signal* signal)
     auto senderPos = signal->getSenderPoa().pos.getPositionAt();
     auto receiverPos = signal->getReceiverPoa().pos.getPositionAt();
 
-    double factor = obstacleControl.calculateAttenuation(senderPos, receiverPos);
+    double factor = batchReceivers ? getBatchedAttenuation(*signal, senderPos, receiverPos) : -1;
+    if (factor < 0) {
+        // when applied as a thresholding model, there is no need to compute attenuation beyond what renders the signal undecodable
+        double budget = useAttenuationBudget ? signal->getAttenuationBudget() : 0;
+        factor = obstacleControl.calculateAttenuation(senderPos, receiverPos, budget);
+
+        if (factor < budget) {
+            // factor is only an upper bound: leave the signal unchanged, so the exact attenuation is computed should its power still matter (for CCA or as interference)
+            EV_TRACE << "value is below: " << factor << ", signal is undecodable" << endl;
+            signal->markUndecodable();
+            return;
+        }
+    }
 
     EV_TRACE << "value is: " << factor << endl;
 
     *signal *= factor;
 }
+
+double SimpleObstacleShadowing::getBatchedAttenuation(const Signal& signal, const Coord& senderCoord, const Coord& receiverCoord)
+{
+    AntennaPosition senderPos = signal.getSenderPoa().pos;
+    simtime_t sendStart = signal.getSendingStart();
+
+    // the first receiver of a broadcast resolves all others, too
+    const ObstacleControl::TransmissionAttenuations* factors = obstacleControl.findTransmissionAttenuations(senderPos.getId(), sendStart);
+    if (!factors) {
+        if (!prefetchReceivers(senderPos, sendStart)) return -1;
+        factors = obstacleControl.findTransmissionAttenuations(senderPos.getId(), sendStart);
+        ASSERT(factors);
+    }
+
+    auto i = factors->find(signal.getReceiverPoa().pos.getId());
+    if (i == factors->end()) return -1;
+
+    // only use the factor if it was calculated for where sender and receiver actually are (the receiver might have moved differently than predicted)
+    const ObstacleControl::Link& link = i->second.first;
+    if ((link.first != senderCoord) || (link.second != receiverCoord)) return -1;
+    return i->second.second;
+}
+
+bool SimpleObstacleShadowing::prefetchReceivers(const AntennaPosition& senderPos, simtime_t sendStart)
+{
+    auto sender = dynamic_cast<ChannelAccess*>(getSimulation()->getModule(senderPos.getId()));
+    if (!sender) return false;
+
+    cModule* nic = sender->getParentModule();
+    BaseConnectionManager* cc = ChannelAccess::getConnectionManager(nic);
+    if (!cc) return false;
+
+    // each receiver evaluates the signal when it starts receiving it, i.e., after the propagation delay the sender calculated from the positions at sendStart (if propagation delay is used at all)
+    bool usePropagationDelay = (simTime() > sendStart);
+    Coord senderAtSendStart = senderPos.getPositionAt(sendStart);
+
+    std::vector<std::pair<int, ObstacleControl::Link>> receivers;
+    simtime_t lastReceptionStart = simTime();
+    const NicEntry::GateList& gateList = cc->getGateList(nic->getId());
+    receivers.reserve(gateList.size());
+    for (auto& entry : gateList) {
+        AntennaPosition receiverPos = entry.first->chAccess->getAntennaPosition();
+
+        // receivers that moved since the transmission started are left to compute their attenuation on their own
+        if (receiverPos.getTime() > sendStart) continue;
+
+        simtime_t receptionStart = sendStart;
+        if (usePropagationDelay) {
+            simtime_t delay = receiverPos.getPositionAt(sendStart).distance(senderAtSendStart) / BaseWorldUtility::speedOfLight();
+            receptionStart += delay;
+        }
+        if (receptionStart < simTime()) continue;
+
+        receivers.emplace_back(receiverPos.getId(), ObstacleControl::Link(senderPos.getPositionAt(receptionStart), receiverPos.getPositionAt(receptionStart)));
+        lastReceptionStart = std::max(lastReceptionStart, receptionStart);
+    }
+
+    obstacleControl.calculateTransmissionAttenuations(senderPos.getId(), sendStart, lastReceptionStart, receivers);
+    return true;
+}
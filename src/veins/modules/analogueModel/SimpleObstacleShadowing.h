@@ -51,6 +51,33 @@ protected:
     /** @brief The size of the playground.*/
     const Coord& playgroundSize;
 
+    /** @brief whether to resolve all receivers of a transmission in one batch query */
+    const bool batchReceivers;
+
+    /** @brief whether to stop computing attenuation once a signal is known to be undecodable */
+    const bool useAttenuationBudget;
+
+    /**
+     * @brief Computes (and keeps in ObstacleControl) the attenuation of a
+     * transmission to every NIC currently connected to its sender, using a
+     * single batch query.
+     *
+     * Each receiver is evaluated at the positions of sender and receiver
+     * at the time it will start receiving the transmission.
+     *
+     * Returns false if the sender could not be resolved (e.g., because it
+     * has already been removed from the simulation).
+     */
+    bool prefetchReceivers(const AntennaPosition& senderPos, simtime_t sendStart);
+
+    /**
+     * @brief Returns the attenuation of signal as computed for all receivers
+     * of its transmission at once (computing it, if this is the first
+     * receiver), or a negative value if it is not known for the link
+     * from senderCoord to receiverCoord.
+     */
+    double getBatchedAttenuation(const Signal& signal, const Coord& senderCoord, const Coord& receiverCoord);
+
 public:
     /**
      * @brief Initializes the analogue model. myMove and playgroundSize
@@ -63,8 +90,10 @@ public:
      * @param obstacleControl the parent module
      * @param useTorus information about the playground the host is moving in
      * @param playgroundSize information about the playground the host is moving in
+     * @param batchReceivers on a cache miss, resolve the attenuation towards all receivers of the sender at once
+     * @param useAttenuationBudget defer the exact attenuation of signals found to be undecodable until their power is needed
      */
-    SimpleObstacleShadowing(cComponent* owner, ObstacleControl& obstacleControl, bool useTorus, const Coord& playgroundSize);
+    SimpleObstacleShadowing(cComponent* owner, ObstacleControl& obstacleControl, bool useTorus, const Coord& playgroundSize, bool batchReceivers = false, bool useAttenuationBudget = false);
 
     /**
      * @brief Filters a specified Signal by adding an attenuation
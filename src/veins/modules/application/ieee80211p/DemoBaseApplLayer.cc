@@ -259,6 +259,50 @@ void DemoBaseApplLayer::finish()
     recordScalar("receivedWSAs", receivedWSAs);
 }
 
+void DemoBaseApplLayer::prepareForReuse()
+{
+    finish();
+
+    cancelEvent(sendBeaconEvt);
+    cancelEvent(sendWSAEvt);
+}
+
+void DemoBaseApplLayer::reinitialize(int stage)
+{
+    if (stage == 0) {
+        // pointers to other modules and most parameters stay valid, so only reset what belongs to the vehicle
+        if (mobility) {
+            traciVehicle = mobility->getVehicleCommandInterface();
+        }
+
+        dataOnSch = par("dataOnSch").boolValue();
+        currentOfferedServiceId = -1;
+
+        isParked = false;
+
+        generatedBSMs = 0;
+        generatedWSAs = 0;
+        generatedWSMs = 0;
+        receivedBSMs = 0;
+        receivedWSAs = 0;
+        receivedWSMs = 0;
+    }
+    else if (stage == 1) {
+        // only looks up the MAC and schedules the first beacon
+        DemoBaseApplLayer::initialize(stage);
+    }
+}
+
+void DemoBaseApplLayer::handleMessage(cMessage* msg)
+{
+    if (isForPreviousVehicle(msg)) {
+        EV_TRACE << "Dropping " << msg->getName() << ", which was meant for the previous vehicle" << endl;
+        delete msg;
+        return;
+    }
+    BaseApplLayer::handleMessage(msg);
+}
+
 DemoBaseApplLayer::~DemoBaseApplLayer()
 {
     cancelAndDelete(sendBeaconEvt);
@@ -31,6 +31,7 @@
 #include "veins/modules/mac/ieee80211p/DemoBaseApplLayerToMac1609_4Interface.h"
 #include "veins/modules/mobility/traci/TraCIMobility.h"
 #include "veins/modules/mobility/traci/TraCICommandInterface.h"
+#include "veins/modules/mobility/traci/TraCIReusableModule.h"
 
 namespace Veins {
 
@@ -53,13 +54,16 @@ using Veins::TraCIMobilityAccess;
  * @see PhyLayer80211p
  * @see Decider80211p
  */
-class VEINS_API DemoBaseApplLayer : public BaseApplLayer {
+class VEINS_API DemoBaseApplLayer : public BaseApplLayer, public TraCIReusableModule {
 
 public:
     ~DemoBaseApplLayer() override;
     void initialize(int stage) override;
     void finish() override;
 
+    void prepareForReuse() override;
+    void reinitialize(int stage) override;
+
     void receiveSignal(cComponent* source, simsignal_t signalID, cObject* obj, cObject* details) override;
 
     enum DemoApplMessageKinds {
@@ -68,6 +72,9 @@ public:
     };
 
 protected:
+    /** @brief drops messages meant for the vehicle this module was previously used for */
+    void handleMessage(cMessage* msg) override;
+
     /** @brief handle messages from below and calls the onWSM, onBSM, and onWSA functions accordingly */
     void handleLowerMsg(cMessage* msg) override;
 
@@ -136,7 +143,7 @@ protected:
     /* pointers ill be set when used with TraCIMobility */
     TraCIMobility* mobility;
     TraCICommandInterface* traci;
-    TraCICommandInterface::Vehicle* traciVehicle;
+    TraCICommandInterface::Vehicle* traciVehicle; /**< nullptr if the host is not a vehicle (e.g., a person) */
 
     AnnotationManager* annotations;
     DemoBaseApplLayerToMac1609_4Interface* mac;
@@ -36,6 +36,24 @@ void TraCIDemo11p::initialize(int stage)
     }
 }
 
+void TraCIDemo11p::prepareForReuse()
+{
+    DemoBaseApplLayer::prepareForReuse();
+
+    cancelAndDelete(scheduledWSM);
+    scheduledWSM = nullptr;
+}
+
+void TraCIDemo11p::reinitialize(int stage)
+{
+    DemoBaseApplLayer::reinitialize(stage);
+    if (stage == 0) {
+        sentMessage = false;
+        lastDroveAt = simTime();
+        currentSubscribedServiceId = -1;
+    }
+}
+
 void TraCIDemo11p::onWSA(DemoServiceAdvertisment* wsa)
 {
     if (currentSubscribedServiceId == -1) {
@@ -54,13 +72,14 @@ void TraCIDemo11p::onWSM(BaseFrame1609_4* frame)
 
     findHost()->getDisplayString().setTagArg("i", 1, "green");
 
-    if (mobility->getRoadId()[0] != ':') traciVehicle->changeRoute(wsm->getDemoData(), 9999);
+    if (traciVehicle && (mobility->getRoadId()[0] != ':')) traciVehicle->changeRoute(wsm->getDemoData(), 9999);
     if (!sentMessage) {
         sentMessage = true;
         // repeat the received traffic update once in 2 seconds plus some random delay
         wsm->setSenderAddress(myId);
         wsm->setSerial(3);
-        scheduleAt(simTime() + 2 + uniform(0.01, 0.2), wsm->dup());
+        scheduledWSM = wsm->dup();
+        scheduleAt(simTime() + 2 + uniform(0.01, 0.2), scheduledWSM);
     }
 }
 
@@ -74,6 +93,7 @@ void TraCIDemo11p::handleSelfMsg(cMessage* msg)
         if (wsm->getSerial() >= 3) {
             // stop service advertisements
             stopService();
+            scheduledWSM = nullptr;
             delete (wsm);
         }
         else {
@@ -103,7 +123,8 @@ void TraCIDemo11p::handlePositionUpdate(cObject* obj)
             if (dataOnSch) {
                 startService(Channel::sch2, 42, "Traffic Information Service");
                 // started service and server advertising, schedule message to self to send later
-                scheduleAt(computeAsynchronousSendingTime(1, ChannelType::service), wsm);
+                scheduledWSM = wsm;
+                scheduleAt(computeAsynchronousSendingTime(1, ChannelType::service), scheduledWSM);
             }
             else {
                 // send right away on CCH, because channel switching is disabled
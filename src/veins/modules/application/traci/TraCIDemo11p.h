@@ -42,10 +42,14 @@ class VEINS_API TraCIDemo11p : public DemoBaseApplLayer {
 public:
     void initialize(int stage) override;
 
+    void prepareForReuse() override;
+    void reinitialize(int stage) override;
+
 protected:
     simtime_t lastDroveAt;
     bool sentMessage;
     int currentSubscribedServiceId;
+    cMessage* scheduledWSM = nullptr; /**< traffic update scheduled to be sent (again), if any */
 
 protected:
     void onWSM(BaseFrame1609_4* wsm) override;
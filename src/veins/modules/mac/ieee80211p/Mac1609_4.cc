@@ -62,25 +62,6 @@ void Mac1609_4::initialize(int stage)
         waitUntilAckRXorTimeout = false;
         stopIgnoreChannelStateMsg = new cMessage("ChannelStateMsg");
 
-        myId = getParentModule()->getParentModule()->getFullPath();
-        // create two edca systems
-
-        myEDCA[ChannelType::control] = make_unique<EDCA>(this, ChannelType::control, par("queueSize"));
-        myEDCA[ChannelType::control]->myId = myId;
-        myEDCA[ChannelType::control]->myId.append(" CCH");
-        myEDCA[ChannelType::control]->createQueue(2, (((CWMIN_11P + 1) / 4) - 1), (((CWMIN_11P + 1) / 2) - 1), AC_VO);
-        myEDCA[ChannelType::control]->createQueue(3, (((CWMIN_11P + 1) / 2) - 1), CWMIN_11P, AC_VI);
-        myEDCA[ChannelType::control]->createQueue(6, CWMIN_11P, CWMAX_11P, AC_BE);
-        myEDCA[ChannelType::control]->createQueue(9, CWMIN_11P, CWMAX_11P, AC_BK);
-
-        myEDCA[ChannelType::service] = make_unique<EDCA>(this, ChannelType::service, par("queueSize"));
-        myEDCA[ChannelType::service]->myId = myId;
-        myEDCA[ChannelType::service]->myId.append(" SCH");
-        myEDCA[ChannelType::service]->createQueue(2, (((CWMIN_11P + 1) / 4) - 1), (((CWMIN_11P + 1) / 2) - 1), AC_VO);
-        myEDCA[ChannelType::service]->createQueue(3, (((CWMIN_11P + 1) / 2) - 1), CWMIN_11P, AC_VI);
-        myEDCA[ChannelType::service]->createQueue(6, CWMIN_11P, CWMAX_11P, AC_BE);
-        myEDCA[ChannelType::service]->createQueue(9, CWMIN_11P, CWMAX_11P, AC_BK);
-
         useSCH = par("useServiceChannel").boolValue();
         if (useSCH) {
             if (useAcks) throw cRuntimeError("Unicast model does not support channel switching");
@@ -108,48 +89,71 @@ void Mac1609_4::initialize(int stage)
         headerLength = par("headerLength");
 
         nextMacEvent = new cMessage("next Mac Event");
+        // only needed if channel switching is active
+        nextChannelSwitch = useSCH ? new cMessage("Channel Switch") : nullptr;
 
-        if (useSCH) {
-            uint64_t currenTime = simTime().raw();
-            uint64_t switchingTime = SWITCHING_INTERVAL_11P.raw();
-            double timeToNextSwitch = (double) (switchingTime - (currenTime % switchingTime)) / simTime().getScale();
-            if ((currenTime / switchingTime) % 2 == 0) {
-                setActiveChannel(ChannelType::control);
-            }
-            else {
-                setActiveChannel(ChannelType::service);
-            }
+        startChannelAccess();
+    }
+}
 
-            // channel switching active
-            nextChannelSwitch = new cMessage("Channel Switch");
-            // add a little bit of offset between all vehicles, but no more than syncOffset
-            simtime_t offset = dblrand() * par("syncOffset").doubleValue();
-            scheduleAt(simTime() + offset + timeToNextSwitch, nextChannelSwitch);
+void Mac1609_4::startChannelAccess()
+{
+    myId = getParentModule()->getParentModule()->getFullPath();
+    // create two edca systems
+
+    myEDCA[ChannelType::control] = make_unique<EDCA>(this, ChannelType::control, par("queueSize"));
+    myEDCA[ChannelType::control]->myId = myId;
+    myEDCA[ChannelType::control]->myId.append(" CCH");
+    myEDCA[ChannelType::control]->createQueue(2, (((CWMIN_11P + 1) / 4) - 1), (((CWMIN_11P + 1) / 2) - 1), AC_VO);
+    myEDCA[ChannelType::control]->createQueue(3, (((CWMIN_11P + 1) / 2) - 1), CWMIN_11P, AC_VI);
+    myEDCA[ChannelType::control]->createQueue(6, CWMIN_11P, CWMAX_11P, AC_BE);
+    myEDCA[ChannelType::control]->createQueue(9, CWMIN_11P, CWMAX_11P, AC_BK);
+
+    myEDCA[ChannelType::service] = make_unique<EDCA>(this, ChannelType::service, par("queueSize"));
+    myEDCA[ChannelType::service]->myId = myId;
+    myEDCA[ChannelType::service]->myId.append(" SCH");
+    myEDCA[ChannelType::service]->createQueue(2, (((CWMIN_11P + 1) / 4) - 1), (((CWMIN_11P + 1) / 2) - 1), AC_VO);
+    myEDCA[ChannelType::service]->createQueue(3, (((CWMIN_11P + 1) / 2) - 1), CWMIN_11P, AC_VI);
+    myEDCA[ChannelType::service]->createQueue(6, CWMIN_11P, CWMAX_11P, AC_BE);
+    myEDCA[ChannelType::service]->createQueue(9, CWMIN_11P, CWMAX_11P, AC_BK);
+
+    if (useSCH) {
+        uint64_t currenTime = simTime().raw();
+        uint64_t switchingTime = SWITCHING_INTERVAL_11P.raw();
+        double timeToNextSwitch = (double) (switchingTime - (currenTime % switchingTime)) / simTime().getScale();
+        if ((currenTime / switchingTime) % 2 == 0) {
+            setActiveChannel(ChannelType::control);
         }
         else {
-            // no channel switching
-            nextChannelSwitch = nullptr;
-            setActiveChannel(ChannelType::control);
+            setActiveChannel(ChannelType::service);
         }
 
-        // stats
-        statsReceivedPackets = 0;
-        statsReceivedBroadcasts = 0;
-        statsSentPackets = 0;
-        statsSentAcks = 0;
-        statsTXRXLostPackets = 0;
-        statsSNIRLostPackets = 0;
-        statsDroppedPackets = 0;
-        statsNumTooLittleTime = 0;
-        statsNumInternalContention = 0;
-        statsNumBackoff = 0;
-        statsSlotsBackoff = 0;
-        statsTotalBusyTime = 0;
-
-        idleChannel = true;
-        lastBusy = simTime();
-        channelIdle(true);
+        // add a little bit of offset between all vehicles, but no more than syncOffset
+        simtime_t offset = dblrand() * par("syncOffset").doubleValue();
+        scheduleAt(simTime() + offset + timeToNextSwitch, nextChannelSwitch);
     }
+    else {
+        // no channel switching
+        setActiveChannel(ChannelType::control);
+    }
+
+    // stats
+    statsReceivedPackets = 0;
+    statsReceivedBroadcasts = 0;
+    statsSentPackets = 0;
+    statsSentAcks = 0;
+    statsTXRXLostPackets = 0;
+    statsSNIRLostPackets = 0;
+    statsDroppedPackets = 0;
+    statsNumTooLittleTime = 0;
+    statsNumInternalContention = 0;
+    statsNumBackoff = 0;
+    statsSlotsBackoff = 0;
+    statsTotalBusyTime = 0;
+
+    idleChannel = true;
+    lastBusy = simTime();
+    channelIdle(true);
 }
 
 void Mac1609_4::handleSelfMsg(cMessage* msg)
@@ -438,6 +442,42 @@ void Mac1609_4::finish()
     recordScalar("totalBusyTime", statsTotalBusyTime.dbl());
 }
 
+void Mac1609_4::prepareForReuse()
+{
+    finish();
+
+    cancelEvent(stopIgnoreChannelStateMsg);
+    cancelEvent(nextMacEvent);
+    if (nextChannelSwitch) cancelEvent(nextChannelSwitch);
+
+    // deleting the EDCA systems cancels their ack timeouts and deletes all queued frames
+    myEDCA.clear();
+    lastWSM = nullptr;
+    lastMac.reset();
+    handledUnicastToApp.clear();
+}
+
+void Mac1609_4::reinitialize(int stage)
+{
+    if (stage == 0) {
+        rxStartIndication = false;
+        ignoreChannelState = false;
+        waitUntilAckRXorTimeout = false;
+
+        startChannelAccess();
+    }
+}
+
+void Mac1609_4::handleMessage(cMessage* msg)
+{
+    if (isForPreviousVehicle(msg)) {
+        EV_TRACE << "Dropping " << msg->getName() << ", which was meant for the previous vehicle" << endl;
+        delete msg;
+        return;
+    }
+    BaseMacLayer::handleMessage(msg);
+}
+
 Mac1609_4::~Mac1609_4()
 {
     if (nextMacEvent) {
@@ -39,6 +39,7 @@
 #include "veins/base/modules/BaseMacLayer.h"
 #include "veins/modules/utility/ConstsPhy.h"
 #include "veins/modules/utility/HasLogProxy.h"
+#include "veins/modules/mobility/traci/TraCIReusableModule.h"
 
 namespace Veins {
 
@@ -63,7 +64,7 @@ namespace Veins {
 
 class DeciderResult80211;
 
-class VEINS_API Mac1609_4 : public BaseMacLayer, public DemoBaseApplLayerToMac1609_4Interface {
+class VEINS_API Mac1609_4 : public BaseMacLayer, public DemoBaseApplLayerToMac1609_4Interface, public TraCIReusableModule {
 
 public:
     // tell to anybody which is interested when the channel turns busy or idle
@@ -184,6 +185,18 @@ protected:
     /** @brief Delete all dynamically allocated objects of the module.*/
     void finish() override;
 
+    /** @brief Record statistics, cancel timers, and drop all queued frames of a vehicle that left the simulation.*/
+    void prepareForReuse() override;
+
+    /** @brief Start channel access for a new vehicle from scratch.*/
+    void reinitialize(int stage) override;
+
+    /** @brief Drop messages meant for the vehicle this module was previously used for.*/
+    void handleMessage(cMessage* msg) override;
+
+    /** @brief Create the EDCA systems, start channel switching, and reset statistics and channel state.*/
+    void startChannelAccess();
+
     /** @brief Handle messages from lower layer.*/
     void handleLowerMsg(cMessage*) override;
 
@@ -18,30 +18,32 @@ TraCIBuffer::TraCIBuffer()
 }
 
 TraCIBuffer::TraCIBuffer(std::string buf)
-    : buf(buf)
+    : buf(buf.begin(), buf.end())
 {
     buf_index = 0;
 }
 
 bool TraCIBuffer::eof() const
 {
-    return buf_index == buf.length();
+    return buf_index == buf.size();
 }
 
 void TraCIBuffer::set(std::string buf)
 {
-    this->buf = buf;
+    this->buf.assign(buf.begin(), buf.end());
     buf_index = 0;
 }
 
 void TraCIBuffer::clear()
 {
-    set("");
+    // keep capacity, so the buffer can be reused without reallocating
+    buf.clear();
+    buf_index = 0;
 }
 
 std::string TraCIBuffer::str() const
 {
-    return buf;
+    return std::string(buf.begin(), buf.end());
 }
 
 template <>
@@ -61,7 +63,7 @@ std::vector<std::string> TraCIBuffer::readTypeChecked(int expectedTraCIType)
 std::string TraCIBuffer::hexStr() const
 {
     std::stringstream ss;
-    for (std::string::const_iterator i = buf.begin() + buf_index; i != buf.end(); ++i) {
+    for (auto i = buf.begin() + buf_index; i != buf.end(); ++i) {
         if (i != buf.begin()) ss << " ";
         ss << std::hex << std::setw(2) << std::setfill('0') << (int) (uint8_t) *i;
     }
@@ -72,26 +74,30 @@ template <>
 void TraCIBuffer::write(std::string inv)
 {
     uint32_t length = inv.length();
+    reserve(sizeof(length) + length);
     write<uint32_t>(length);
-    for (size_t i = 0; i < length; ++i) write<char>(inv[i]);
+    buf.insert(buf.end(), inv.begin(), inv.end());
 }
 
-template <>
-std::string TraCIBuffer::read()
+TraCIBuffer::StringRef TraCIBuffer::readStringRef()
 {
     uint32_t length = read<uint32_t>();
-    if (length == 0) return std::string();
-    char obuf[length + 1];
-
-    for (size_t i = 0; i < length; ++i) read<char>(obuf[i]);
-    obuf[length] = 0;
+    checkReadable(length);
+    StringRef s{reinterpret_cast<const char*>(buf.data() + buf_index), length};
+    buf_index += length;
+    return s;
+}
 
-    return std::string(obuf, length);
+template <>
+std::string TraCIBuffer::read()
+{
+    return readStringRef().str();
 }
 
 template <>
 void TraCIBuffer::write(TraCICoord inv)
 {
+    reserve(sizeof(uint8_t) + 2 * sizeof(double));
     write<uint8_t>(POSITION_2D);
     write<double>(inv.x);
     write<double>(inv.y);
@@ -140,9 +146,7 @@ simtime_t TraCIBuffer::read()
 
 bool isBigEndian()
 {
-    short a = 0x0102;
-    unsigned char* p_a = reinterpret_cast<unsigned char*>(&a);
-    return (p_a[0] == 0x01);
+    return hostIsBigEndian;
 }
 
 } // namespace Veins
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include "veins/veins.h"
 
@@ -9,13 +13,113 @@ namespace Veins {
 
 struct TraCICoord;
 
+/**
+ * byte order of the host, as known at compile time (TraCI itself uses network byte order, i.e., big endian)
+ */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+constexpr bool hostIsBigEndian = true;
+#else
+constexpr bool hostIsBigEndian = false;
+#endif
+
 bool isBigEndian();
 
+namespace TraCIBufferDetail {
+
+template <size_t Size>
+struct UnsignedOfSize;
+template <>
+struct UnsignedOfSize<1> {
+    using type = uint8_t;
+    static uint8_t swap(uint8_t v)
+    {
+        return v;
+    }
+};
+template <>
+struct UnsignedOfSize<2> {
+    using type = uint16_t;
+    static uint16_t swap(uint16_t v)
+    {
+#if defined(__GNUC__)
+        return __builtin_bswap16(v);
+#else
+        return static_cast<uint16_t>((v >> 8) | (v << 8));
+#endif
+    }
+};
+template <>
+struct UnsignedOfSize<4> {
+    using type = uint32_t;
+    static uint32_t swap(uint32_t v)
+    {
+#if defined(__GNUC__)
+        return __builtin_bswap32(v);
+#else
+        return ((v & 0xFF000000u) >> 24) | ((v & 0x00FF0000u) >> 8) | ((v & 0x0000FF00u) << 8) | ((v & 0x000000FFu) << 24);
+#endif
+    }
+};
+template <>
+struct UnsignedOfSize<8> {
+    using type = uint64_t;
+    static uint64_t swap(uint64_t v)
+    {
+#if defined(__GNUC__)
+        return __builtin_bswap64(v);
+#else
+        return (static_cast<uint64_t>(UnsignedOfSize<4>::swap(static_cast<uint32_t>(v))) << 32) | UnsignedOfSize<4>::swap(static_cast<uint32_t>(v >> 32));
+#endif
+    }
+};
+
+/**
+ * convert a scalar between host and TraCI byte order (the conversion is its own inverse)
+ */
+template <typename T>
+T toTraCIByteOrder(T value)
+{
+    if (hostIsBigEndian) return value;
+    using U = typename UnsignedOfSize<sizeof(T)>::type;
+    U u;
+    std::memcpy(&u, &value, sizeof(T));
+    u = UnsignedOfSize<sizeof(T)>::swap(u);
+    std::memcpy(&value, &u, sizeof(T));
+    return value;
+}
+
+} // namespace TraCIBufferDetail
+
 /**
  * Byte-buffer that stores values in TraCI byte-order
  */
 class VEINS_API TraCIBuffer {
 public:
+    /**
+     * non-owning reference to a string stored in a TraCIBuffer.
+     *
+     * Only valid as long as the buffer it was read from is neither modified nor destroyed.
+     */
+    struct StringRef {
+        const char* data;
+        size_t size;
+
+        std::string str() const
+        {
+            return std::string(data, size);
+        }
+
+        bool operator==(const std::string& o) const
+        {
+            return (o.size() == size) && (std::memcmp(o.data(), data, size) == 0);
+        }
+
+        bool operator!=(const std::string& o) const
+        {
+            return !(*this == o);
+        }
+    };
+
     TraCIBuffer();
     TraCIBuffer(std::string buf);
 
@@ -23,55 +127,66 @@ public:
     T read()
     {
         T buf_to_return;
-        unsigned char* p_buf_to_return = reinterpret_cast<unsigned char*>(&buf_to_return);
-
-        if (isBigEndian()) {
-            for (size_t i = 0; i < sizeof(buf_to_return); ++i) {
-                if (eof()) throw cRuntimeError("Attempted to read past end of byte buffer");
-                p_buf_to_return[i] = buf[buf_index++];
-            }
-        }
-        else {
-            for (size_t i = 0; i < sizeof(buf_to_return); ++i) {
-                if (eof()) throw cRuntimeError("Attempted to read past end of byte buffer");
-                p_buf_to_return[sizeof(buf_to_return) - 1 - i] = buf[buf_index++];
-            }
-        }
-
-        return buf_to_return;
+        checkReadable(sizeof(buf_to_return));
+        std::memcpy(&buf_to_return, buf.data() + buf_index, sizeof(buf_to_return));
+        buf_index += sizeof(buf_to_return);
+        return TraCIBufferDetail::toTraCIByteOrder(buf_to_return);
     }
 
     template <typename T>
     void write(T inv)
     {
-        unsigned char* p_buf_to_send = reinterpret_cast<unsigned char*>(&inv);
-
-        if (isBigEndian()) {
-            for (size_t i = 0; i < sizeof(inv); ++i) {
-                buf += p_buf_to_send[i];
-            }
-        }
-        else {
-            for (size_t i = 0; i < sizeof(inv); ++i) {
-                buf += p_buf_to_send[sizeof(inv) - 1 - i];
-            }
-        }
+        T v = TraCIBufferDetail::toTraCIByteOrder(inv);
+        const unsigned char* p_buf_to_send = reinterpret_cast<const unsigned char*>(&v);
+        buf.insert(buf.end(), p_buf_to_send, p_buf_to_send + sizeof(v));
     }
 
     void readBuffer(unsigned char* buffer, size_t size)
     {
-        if (isBigEndian()) {
-            for (size_t i = 0; i < size; ++i) {
-                if (eof()) throw cRuntimeError("Attempted to read past end of byte buffer");
-                buffer[i] = buf[buf_index++];
-            }
+        checkReadable(size);
+        if (hostIsBigEndian) {
+            std::memcpy(buffer, buf.data() + buf_index, size);
         }
         else {
             for (size_t i = 0; i < size; ++i) {
-                if (eof()) throw cRuntimeError("Attempted to read past end of byte buffer");
-                buffer[size - 1 - i] = buf[buf_index++];
+                buffer[size - 1 - i] = buf[buf_index + i];
             }
         }
+        buf_index += size;
+    }
+
+    /**
+     * @brief
+     * read an item located offset bytes past the current position, without advancing
+     */
+    template <typename T>
+    T peek(size_t offset = 0) const
+    {
+        T buf_to_return;
+        checkReadable(offset + sizeof(buf_to_return));
+        std::memcpy(&buf_to_return, buf.data() + buf_index + offset, sizeof(buf_to_return));
+        return TraCIBufferDetail::toTraCIByteOrder(buf_to_return);
+    }
+
+    /**
+     * @brief
+     * read the next size bytes as they are (i.e., still in TraCI byte order) into out, replacing its contents
+     */
+    void readRaw(TraCIBuffer& out, size_t size)
+    {
+        checkReadable(size);
+        uint8_t* dest = out.reset(size);
+        if (size > 0) std::memcpy(dest, buf.data() + buf_index, size);
+        buf_index += size;
+    }
+
+    /**
+     * @brief
+     * number of bytes that have not been read yet
+     */
+    size_t remaining() const
+    {
+        return buf.size() - buf_index;
     }
 
     template <typename T>
@@ -107,19 +222,82 @@ public:
         return read<T>();
     }
 
+    /**
+     * @brief
+     * read a string without copying it out of the buffer
+     */
+    StringRef readStringRef();
+
+    /**
+     * @brief
+     * make room for at least size more bytes to be written without reallocating
+     *
+     * Grows capacity geometrically, so repeated calls while appending stay amortized O(1) per byte.
+     */
+    void reserve(size_t size)
+    {
+        size_t needed = buf.size() + size;
+        if (needed > buf.capacity()) buf.reserve(std::max(2 * buf.capacity(), needed));
+    }
+
+    /**
+     * @brief
+     * append the raw contents of another buffer
+     */
+    void append(const TraCIBuffer& other)
+    {
+        buf.insert(buf.end(), other.buf.begin(), other.buf.end());
+    }
+
+    /**
+     * @brief
+     * discard contents and rewind, then hold size bytes to be filled in directly via the returned pointer
+     *
+     * Keeps the allocated capacity, so a buffer reused this way stops reallocating once it has seen the largest message.
+     */
+    uint8_t* reset(size_t size)
+    {
+        buf.resize(size);
+        buf_index = 0;
+        return buf.data();
+    }
+
     bool eof() const;
     void set(std::string buf);
     void clear();
     std::string str() const;
     std::string hexStr() const;
 
+    /**
+     * @brief
+     * raw contents of the buffer (including bytes that have already been read)
+     */
+    const uint8_t* data() const
+    {
+        return buf.data();
+    }
+
+    /**
+     * @brief
+     * size of the buffer in bytes (including bytes that have already been read)
+     */
+    size_t size() const
+    {
+        return buf.size();
+    }
+
     static void setTimeAsDouble(bool val)
     {
         timeAsDouble = val;
     }
 
 private:
-    std::string buf;
+    void checkReadable(size_t size) const
+    {
+        if (buf.size() - buf_index < size) throw cRuntimeError("Attempted to read past end of byte buffer");
+    }
+
+    std::vector<uint8_t> buf;
     size_t buf_index;
     static bool timeAsDouble;
 };
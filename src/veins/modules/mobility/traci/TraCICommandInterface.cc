@@ -25,6 +25,8 @@ TraCICommandInterface::TraCICommandInterface(cComponent* owner, TraCIConnection&
     : HasLogProxy(owner)
     , connection(c)
     , ignoreGuiCommands(ignoreGuiCommands)
+    , cacheGetters(false)
+    , dynamicCacheVersion(0)
 {
 }
 
@@ -33,6 +35,156 @@ bool TraCICommandInterface::isIgnoringGuiCommands()
     return ignoreGuiCommands;
 }
 
+void TraCICommandInterface::setCacheGetters(bool cache)
+{
+    cacheGetters = cache;
+    staticCache.clear();
+    dynamicCache.clear();
+}
+
+void TraCICommandInterface::forgetVehicle(const std::string& vehicleId)
+{
+    for (uint8_t variableId : {VAR_TYPE, VAR_LENGTH, VAR_WIDTH, VAR_HEIGHT, VAR_ACCEL, VAR_DECEL}) {
+        forgetStaticVariable(CMD_GET_VEHICLE_VARIABLE, vehicleId, variableId);
+    }
+}
+
+void TraCICommandInterface::forgetStaticVariable(uint8_t commandId, const std::string& objectId, uint8_t variableId)
+{
+    if (staticCache.empty()) return;
+    staticCache.erase(cacheKey(commandId, objectId, variableId));
+}
+
+void TraCICommandInterface::setCacheNetworkGeometry(bool cache)
+{
+    if (!cache) {
+        networkGeometry.reset();
+    }
+    else if (!networkGeometry) {
+        networkGeometry.reset(new TraCINetworkGeometry());
+    }
+}
+
+void TraCICommandInterface::loadNetworkGeometry()
+{
+    if (!networkGeometry) throw cRuntimeError("Cannot load network geometry: network geometry cache is disabled");
+
+    std::vector<std::string> laneIds;
+    for (auto& laneId : genericGetStringList(CMD_GET_LANE_VARIABLE, "", ID_LIST, RESPONSE_GET_LANE_VARIABLE)) laneIds.push_back(laneId);
+    std::vector<std::string> junctionIds;
+    for (auto& junctionId : genericGetStringList(CMD_GET_JUNCTION_VARIABLE, "", ID_LIST, RESPONSE_GET_JUNCTION_VARIABLE)) junctionIds.push_back(junctionId);
+
+    TraCIConnection::Batch batch;
+    for (auto& laneId : laneIds) batch.add(CMD_GET_LANE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_SHAPE) << laneId);
+    for (auto& junctionId : junctionIds) batch.add(CMD_GET_JUNCTION_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_POSITION) << junctionId);
+
+    connection.query(batch, [&](size_t index, TraCIBuffer& buf) {
+        if (index < laneIds.size()) {
+            const std::string& laneId = laneIds[index];
+            readGetterResponseHeader(buf, RESPONSE_GET_LANE_VARIABLE, laneId, VAR_SHAPE, TYPE_POLYGON);
+            uint8_t count;
+            buf >> count;
+            std::list<Coord> shape;
+            for (uint32_t i = 0; i < count; i++) {
+                double x;
+                buf >> x;
+                double y;
+                buf >> y;
+                shape.push_back(connection.traci2omnet(TraCICoord(x, y)));
+            }
+            networkGeometry->addLaneShape(laneId, shape);
+        }
+        else {
+            const std::string& junctionId = junctionIds[index - laneIds.size()];
+            readGetterResponseHeader(buf, RESPONSE_GET_JUNCTION_VARIABLE, junctionId, VAR_POSITION, POSITION_2D);
+            double x;
+            buf >> x;
+            double y;
+            buf >> y;
+            networkGeometry->addJunctionPosition(junctionId, connection.traci2omnet(TraCICoord(x, y)));
+        }
+        ASSERT(buf.eof());
+    });
+    networkGeometry->setComplete();
+}
+
+void TraCICommandInterface::readGetterResponseHeader(TraCIBuffer& buf, uint8_t responseId, const std::string& objectId, uint8_t variableId, uint8_t resultTypeId)
+{
+    uint8_t cmdLength;
+    buf >> cmdLength;
+    if (cmdLength == 0) {
+        uint32_t cmdLengthX;
+        buf >> cmdLengthX;
+    }
+    uint8_t commandId_r;
+    buf >> commandId_r;
+    ASSERT(commandId_r == responseId);
+    uint8_t varId;
+    buf >> varId;
+    ASSERT(varId == variableId);
+    std::string objectId_r;
+    buf >> objectId_r;
+    ASSERT(objectId_r == objectId);
+    uint8_t resType_r;
+    buf >> resType_r;
+    ASSERT(resType_r == resultTypeId);
+}
+
+bool TraCICommandInterface::isStaticVariable(uint8_t commandId, uint8_t variableId)
+{
+    switch (commandId) {
+    case CMD_GET_VEHICLE_VARIABLE:
+        // these only change via Vehicle::setType and the setters of the dimensions and acceleration, which drop them from the cache
+        return (variableId == VAR_TYPE) || (variableId == VAR_LENGTH) || (variableId == VAR_WIDTH) || (variableId == VAR_HEIGHT) || (variableId == VAR_ACCEL) || (variableId == VAR_DECEL);
+    case CMD_GET_LANE_VARIABLE:
+        // shapes are kept in the network geometry cache instead
+        return (variableId == VAR_LENGTH);
+    default:
+        return false;
+    }
+}
+
+std::string TraCICommandInterface::cacheKey(uint8_t commandId, const std::string& objectId, uint8_t variableId)
+{
+    std::string key;
+    key.reserve(2 + objectId.size());
+    key += static_cast<char>(commandId);
+    key += static_cast<char>(variableId);
+    key += objectId;
+    return key;
+}
+
+TraCIBuffer TraCICommandInterface::queryGetter(uint8_t commandId, const std::string& objectId, uint8_t variableId, TraCIConnection::Result* result)
+{
+    if (!cacheGetters) return connection.query(commandId, TraCIBuffer() << variableId << objectId, result);
+
+    if (connection.getStateVersion() != dynamicCacheVersion) {
+        dynamicCache.clear();
+        dynamicCacheVersion = connection.getStateVersion();
+    }
+
+    bool isStatic = isStaticVariable(commandId, variableId);
+    auto& cache = isStatic ? staticCache : dynamicCache;
+    std::string key = cacheKey(commandId, objectId, variableId);
+    auto i = cache.find(key);
+    if (i != cache.end()) {
+        if (isStatic) {
+            cacheStatistics.staticHits++;
+        }
+        else {
+            cacheStatistics.dynamicHits++;
+        }
+        if (result != nullptr) *result = TraCIConnection::Result(true, false, "");
+        return i->second;
+    }
+
+    cacheStatistics.misses++;
+    TraCIBuffer buf = connection.query(commandId, TraCIBuffer() << variableId << objectId, result);
+    // failed queries are not cached (with result set to nullptr, they throw)
+    if ((result == nullptr) || result->success) cache.emplace(std::move(key), buf);
+    return buf;
+}
+
 std::pair<uint32_t, std::string> TraCICommandInterface::getVersion()
 {
     TraCIConnection::Result result;
@@ -268,7 +420,12 @@ std::string TraCICommandInterface::Vehicle::getRouteId()
 
 std::list<std::string> TraCICommandInterface::Route::getRoadIds()
 {
-    return traci->genericGetStringList(CMD_GET_ROUTE_VARIABLE, routeId, VAR_EDGES, RESPONSE_GET_ROUTE_VARIABLE);
+    std::list<std::string> roadIds;
+    TraCINetworkGeometry* geometry = traci->getNetworkGeometry();
+    if (geometry && geometry->findRouteRoadIds(routeId, roadIds)) return roadIds;
+    roadIds = traci->genericGetStringList(CMD_GET_ROUTE_VARIABLE, routeId, VAR_EDGES, RESPONSE_GET_ROUTE_VARIABLE);
+    if (geometry) geometry->addRouteRoadIds(routeId, roadIds);
+    return roadIds;
 }
 
 void TraCICommandInterface::Vehicle::changeRoute(std::string roadId, simtime_t travelTime)
@@ -327,6 +484,51 @@ double TraCICommandInterface::Vehicle::getDeccel()
     return traci->genericGetDouble(CMD_GET_VEHICLE_VARIABLE, nodeId, VAR_DECEL, RESPONSE_GET_VEHICLE_VARIABLE);
 }
 
+void TraCICommandInterface::Vehicle::setType(std::string typeId)
+{
+    // the type determines all other static values of the vehicle
+    traci->forgetVehicle(nodeId);
+
+    uint8_t variableId = VAR_TYPE;
+    uint8_t variableType = TYPE_STRING;
+    TraCIBuffer buf = connection->query(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << typeId);
+    ASSERT(buf.eof());
+}
+
+void TraCICommandInterface::Vehicle::setLength(double length)
+{
+    setStaticDouble(VAR_LENGTH, length);
+}
+
+void TraCICommandInterface::Vehicle::setWidth(double width)
+{
+    setStaticDouble(VAR_WIDTH, width);
+}
+
+void TraCICommandInterface::Vehicle::setHeight(double height)
+{
+    setStaticDouble(VAR_HEIGHT, height);
+}
+
+void TraCICommandInterface::Vehicle::setAccel(double accel)
+{
+    setStaticDouble(VAR_ACCEL, accel);
+}
+
+void TraCICommandInterface::Vehicle::setDecel(double decel)
+{
+    setStaticDouble(VAR_DECEL, decel);
+}
+
+void TraCICommandInterface::Vehicle::setStaticDouble(uint8_t variableId, double value)
+{
+    traci->forgetStaticVariable(CMD_GET_VEHICLE_VARIABLE, nodeId, variableId);
+
+    uint8_t variableType = TYPE_DOUBLE;
+    TraCIBuffer buf = connection->query(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << value);
+    ASSERT(buf.eof());
+}
+
 double TraCICommandInterface::Vehicle::getCO2Emissions() const
 {
     return traci->genericGetDouble(CMD_GET_VEHICLE_VARIABLE, nodeId, VAR_CO2EMISSION, RESPONSE_GET_VEHICLE_VARIABLE);
@@ -761,6 +963,23 @@ void TraCICommandInterface::Polygon::setShape(const std::list<Coord>& points)
 }
 
 void TraCICommandInterface::addPolygon(std::string polyId, std::string polyType, const TraCIColor& color, bool filled, int32_t layer, const std::list<Coord>& points)
+{
+    TraCIBuffer buf = connection.query(CMD_SET_POLYGON_VARIABLE, makeAddPolygonParameters(polyId, polyType, color, filled, layer, points));
+    ASSERT(buf.eof());
+}
+
+void TraCICommandInterface::addPolygons(const std::vector<std::string>& polyIds, std::string polyType, const TraCIColor& color, bool filled, int32_t layer, const std::vector<std::list<Coord>>& points)
+{
+    ASSERT(polyIds.size() == points.size());
+
+    TraCIConnection::Batch batch;
+    for (size_t i = 0; i < polyIds.size(); ++i) {
+        batch.add(CMD_SET_POLYGON_VARIABLE, makeAddPolygonParameters(polyIds[i], polyType, color, filled, layer, points[i]));
+    }
+    connection.query(batch, [](size_t, TraCIBuffer& buf) { ASSERT(buf.eof()); });
+}
+
+TraCIBuffer TraCICommandInterface::makeAddPolygonParameters(const std::string& polyId, const std::string& polyType, const TraCIColor& color, bool filled, int32_t layer, const std::list<Coord>& points) const
 {
     TraCIBuffer p;
 
@@ -775,9 +994,7 @@ void TraCICommandInterface::addPolygon(std::string polyId, std::string polyType,
         const TraCICoord& pos = connection.omnet2traci(*i);
         p << static_cast<double>(pos.x) << static_cast<double>(pos.y);
     }
-
-    TraCIBuffer buf = connection.query(CMD_SET_POLYGON_VARIABLE, p);
-    ASSERT(buf.eof());
+    return p;
 }
 
 void TraCICommandInterface::Polygon::remove(int32_t layer)
@@ -825,12 +1042,18 @@ void TraCICommandInterface::Poi::remove(int32_t layer)
 
 std::list<std::string> TraCICommandInterface::getLaneIds()
 {
+    if (networkGeometry && networkGeometry->isComplete()) return networkGeometry->getLaneIds();
     return genericGetStringList(CMD_GET_LANE_VARIABLE, "", ID_LIST, RESPONSE_GET_LANE_VARIABLE);
 }
 
 std::list<Coord> TraCICommandInterface::Lane::getShape()
 {
-    return traci->genericGetCoordList(CMD_GET_LANE_VARIABLE, laneId, VAR_SHAPE, RESPONSE_GET_LANE_VARIABLE);
+    std::list<Coord> shape;
+    TraCINetworkGeometry* geometry = traci->getNetworkGeometry();
+    if (geometry && geometry->findLaneShape(laneId, shape)) return shape;
+    shape = traci->genericGetCoordList(CMD_GET_LANE_VARIABLE, laneId, VAR_SHAPE, RESPONSE_GET_LANE_VARIABLE);
+    if (geometry) geometry->addLaneShape(laneId, shape);
+    return shape;
 }
 
 std::string TraCICommandInterface::Lane::getRoadId()
@@ -863,14 +1086,50 @@ int TraCICommandInterface::LaneAreaDetector::getLastStepVehicleNumber()
     return traci->genericGetInt(CMD_GET_LANEAREA_VARIABLE, laneAreaDetectorId, LAST_STEP_VEHICLE_NUMBER, RESPONSE_GET_LANEAREA_VARIABLE);
 }
 
+std::list<std::string> TraCICommandInterface::getPersonIds()
+{
+    return genericGetStringList(CMD_GET_PERSON_VARIABLE, "", ID_LIST, RESPONSE_GET_PERSON_VARIABLE);
+}
+
+Coord TraCICommandInterface::Person::getPosition()
+{
+    return traci->genericGetCoord(CMD_GET_PERSON_VARIABLE, personId, VAR_POSITION, RESPONSE_GET_PERSON_VARIABLE);
+}
+
+std::string TraCICommandInterface::Person::getRoadId()
+{
+    return traci->genericGetString(CMD_GET_PERSON_VARIABLE, personId, VAR_ROAD_ID, RESPONSE_GET_PERSON_VARIABLE);
+}
+
+std::string TraCICommandInterface::Person::getTypeId()
+{
+    return traci->genericGetString(CMD_GET_PERSON_VARIABLE, personId, VAR_TYPE, RESPONSE_GET_PERSON_VARIABLE);
+}
+
+double TraCICommandInterface::Person::getSpeed()
+{
+    return traci->genericGetDouble(CMD_GET_PERSON_VARIABLE, personId, VAR_SPEED, RESPONSE_GET_PERSON_VARIABLE);
+}
+
+Heading TraCICommandInterface::Person::getHeading()
+{
+    return connection->traci2omnetHeading(traci->genericGetDouble(CMD_GET_PERSON_VARIABLE, personId, VAR_ANGLE, RESPONSE_GET_PERSON_VARIABLE));
+}
+
 std::list<std::string> TraCICommandInterface::getJunctionIds()
 {
+    if (networkGeometry && networkGeometry->isComplete()) return networkGeometry->getJunctionIds();
     return genericGetStringList(CMD_GET_JUNCTION_VARIABLE, "", ID_LIST, RESPONSE_GET_JUNCTION_VARIABLE);
 }
 
 Coord TraCICommandInterface::Junction::getPosition()
 {
-    return traci->genericGetCoord(CMD_GET_JUNCTION_VARIABLE, junctionId, VAR_POSITION, RESPONSE_GET_JUNCTION_VARIABLE);
+    Coord position;
+    TraCINetworkGeometry* geometry = traci->getNetworkGeometry();
+    if (geometry && geometry->findJunctionPosition(junctionId, position)) return position;
+    position = traci->genericGetCoord(CMD_GET_JUNCTION_VARIABLE, junctionId, VAR_POSITION, RESPONSE_GET_JUNCTION_VARIABLE);
+    if (geometry) geometry->addJunctionPosition(junctionId, position);
+    return position;
 }
 
 bool TraCICommandInterface::addVehicle(std::string vehicleId, std::string vehicleTypeId, std::string routeId, simtime_t emitTime_st, double emitPosition, double emitSpeed, int8_t emitLane)
@@ -881,6 +1140,7 @@ bool TraCICommandInterface::addVehicle(std::string vehicleId, std::string vehicl
     uint8_t variableType = TYPE_COMPOUND;
     int32_t count = 6;
     int32_t emitTime = (emitTime_st < 0) ? round(emitTime_st.dbl()) : (floor(emitTime_st.dbl() * 1000));
+    forgetVehicle(vehicleId);
     TraCIBuffer buf = connection.query(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << vehicleId << variableType << count << (uint8_t) TYPE_STRING << vehicleTypeId << (uint8_t) TYPE_STRING << routeId << (uint8_t) TYPE_INTEGER << emitTime << (uint8_t) TYPE_DOUBLE << emitPosition << (uint8_t) TYPE_DOUBLE << emitSpeed << (uint8_t) TYPE_BYTE << emitLane, &result);
     ASSERT(buf.eof());
 
@@ -1088,7 +1348,7 @@ std::string TraCICommandInterface::genericGetString(uint8_t commandId, std::stri
     uint8_t resultTypeId = TYPE_STRING;
     std::string res;
 
-    TraCIBuffer buf = connection.query(commandId, TraCIBuffer() << variableId << objectId, result);
+    TraCIBuffer buf = queryGetter(commandId, objectId, variableId, result);
 
     if ((result != nullptr) && (!result->success)) {
         return res;
@@ -1126,7 +1386,7 @@ Coord TraCICommandInterface::genericGetCoord(uint8_t commandId, std::string obje
     double x;
     double y;
 
-    TraCIBuffer buf = connection.query(commandId, TraCIBuffer() << variableId << objectId, result);
+    TraCIBuffer buf = queryGetter(commandId, objectId, variableId, result);
 
     if ((result != nullptr) && (!result->success)) {
         return Coord();
@@ -1164,7 +1424,7 @@ double TraCICommandInterface::genericGetDouble(uint8_t commandId, std::string ob
     uint8_t resultTypeId = TYPE_DOUBLE;
     double res;
 
-    TraCIBuffer buf = connection.query(commandId, TraCIBuffer() << variableId << objectId, result);
+    TraCIBuffer buf = queryGetter(commandId, objectId, variableId, result);
 
     if ((result != nullptr) && (!result->success)) {
         return 0;
@@ -1200,7 +1460,7 @@ simtime_t TraCICommandInterface::genericGetTime(uint8_t commandId, std::string o
     uint8_t resultTypeId = getTimeType();
     simtime_t res;
 
-    TraCIBuffer buf = connection.query(commandId, TraCIBuffer() << variableId << objectId, result);
+    TraCIBuffer buf = queryGetter(commandId, objectId, variableId, result);
 
     if ((result != nullptr) && (!result->success)) {
         return res;
@@ -1237,7 +1497,7 @@ int32_t TraCICommandInterface::genericGetInt(uint8_t commandId, std::string obje
     uint8_t resultTypeId = TYPE_INTEGER;
     int32_t res;
 
-    TraCIBuffer buf = connection.query(commandId, TraCIBuffer() << variableId << objectId, result);
+    TraCIBuffer buf = queryGetter(commandId, objectId, variableId, result);
 
     if ((result != nullptr) && (!result->success)) {
         return 0;
@@ -1274,7 +1534,7 @@ std::list<std::string> TraCICommandInterface::genericGetStringList(uint8_t comma
     uint8_t resultTypeId = TYPE_STRINGLIST;
     std::list<std::string> res;
 
-    TraCIBuffer buf = connection.query(commandId, TraCIBuffer() << variableId << objectId, result);
+    TraCIBuffer buf = queryGetter(commandId, objectId, variableId, result);
 
     if ((result != nullptr) && (!result->success)) {
         return res;
@@ -1317,7 +1577,7 @@ std::list<Coord> TraCICommandInterface::genericGetCoordList(uint8_t commandId, s
     uint8_t resultTypeId = TYPE_POLYGON;
     std::list<Coord> res;
 
-    TraCIBuffer buf = connection.query(commandId, TraCIBuffer() << variableId << objectId, result);
+    TraCIBuffer buf = queryGetter(commandId, objectId, variableId, result);
 
     if ((result != nullptr) && (!result->success)) {
         return res;
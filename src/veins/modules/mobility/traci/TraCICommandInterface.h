@@ -1,13 +1,16 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <stdint.h>
 
 #include "veins/modules/mobility/traci/TraCIColor.h"
 #include "veins/base/utils/Coord.h"
 #include "veins/modules/mobility/traci/TraCICoord.h"
 #include "veins/modules/mobility/traci/TraCIConnection.h"
+#include "veins/modules/mobility/traci/TraCINetworkGeometry.h"
 #include "veins/modules/world/traci/trafficLight/TraCITrafficLightProgram.h"
 #include "veins/modules/utility/HasLogProxy.h"
 
@@ -18,6 +21,52 @@ public:
     TraCICommandInterface(cComponent* owner, TraCIConnection& c, bool ignoreGuiCommands);
     bool isIgnoringGuiCommands();
 
+    /**
+     * number of getter calls answered from the cache (split by kind of value) or by asking the server
+     */
+    struct CacheStatistics {
+        uint64_t staticHits = 0; /**< values that only change via setters, e.g., the length of a vehicle */
+        uint64_t dynamicHits = 0; /**< values asked for again before the server could have changed them */
+        uint64_t misses = 0;
+    };
+
+    /**
+     * whether to remember the results of getters (off by default).
+     *
+     * Values that can change are kept until a command is sent that may change them (typically, the next simulation step, see TraCIConnection::getStateVersion).
+     * Values that rarely change for an object (e.g., the dimensions of a vehicle) are kept until forgetVehicle is called for it or they are changed by a setter of this class.
+     * Changing them by other means (e.g., a raw CMD_SET_VEHICLE_VARIABLE or CMD_SET_VEHICLETYPE_VARIABLE command) leaves stale values in the cache.
+     */
+    void setCacheGetters(bool cache);
+
+    const CacheStatistics& getCacheStatistics() const
+    {
+        return cacheStatistics;
+    }
+
+    /**
+     * drops all cached values of a vehicle, to be called when it leaves the simulation (as its id might get reused)
+     */
+    void forgetVehicle(const std::string& vehicleId);
+
+    /**
+     * whether to remember lane shapes, junction positions, and the edges of routes once they were asked for (off by default), see TraCINetworkGeometry
+     */
+    void setCacheNetworkGeometry(bool cache);
+
+    /**
+     * the cache of lane shapes, junction positions, and the edges of routes (nullptr if disabled)
+     */
+    TraCINetworkGeometry* getNetworkGeometry()
+    {
+        return networkGeometry.get();
+    }
+
+    /**
+     * fills the network geometry cache with the shapes of all lanes and the positions of all junctions, asking for all of them in a single message
+     */
+    void loadNetworkGeometry();
+
     enum DepartTime {
         DEPART_TIME_TRIGGERED = -1,
         DEPART_TIME_CONTAINER_TRIGGERED = -2,
@@ -138,6 +187,16 @@ public:
         double getAccel();
         double getDeccel();
 
+        /**
+         * changes the vehicle type, and with it all values that are taken from the type (e.g., the dimensions of the vehicle)
+         */
+        void setType(std::string typeId);
+        void setLength(double length);
+        void setWidth(double width);
+        void setHeight(double height);
+        void setAccel(double accel);
+        void setDecel(double decel);
+
         /**
          * Get the vehicle's CO2 emissions in mg during this time step.
          *
@@ -216,12 +275,44 @@ public:
         TraCICommandInterface* traci;
         TraCIConnection* connection;
         std::string nodeId;
+
+        /**
+         * sets a static variable of type double (see isStaticVariable), dropping its cached value
+         */
+        void setStaticDouble(uint8_t variableId, double value);
     };
     Vehicle vehicle(std::string nodeId)
     {
         return Vehicle(this, nodeId);
     }
 
+    // Person methods
+    std::list<std::string> getPersonIds();
+    class VEINS_API Person {
+    public:
+        Person(TraCICommandInterface* traci, std::string personId)
+            : traci(traci)
+            , personId(personId)
+        {
+            connection = &traci->connection;
+        }
+
+        Coord getPosition();
+        std::string getRoadId();
+        std::string getTypeId();
+        double getSpeed();
+        Heading getHeading();
+
+    protected:
+        TraCICommandInterface* traci;
+        TraCIConnection* connection;
+        std::string personId;
+    };
+    Person person(std::string personId)
+    {
+        return Person(this, personId);
+    }
+
     // Road methods
     class VEINS_API Road {
     public:
@@ -334,6 +425,10 @@ public:
     // Polygon methods
     std::list<std::string> getPolygonIds();
     void addPolygon(std::string polyId, std::string polyType, const TraCIColor& color, bool filled, int32_t layer, const std::list<Coord>& points);
+    /**
+     * adds one polygon per entry of polyIds (with the points at the same index of points) in a single message
+     */
+    void addPolygons(const std::vector<std::string>& polyIds, std::string polyType, const TraCIColor& color, bool filled, int32_t layer, const std::vector<std::list<Coord>>& points);
     class VEINS_API Polygon {
     public:
         Polygon(TraCICommandInterface* traci, std::string polyId)
@@ -480,6 +575,40 @@ private:
     static const std::map<uint32_t, VersionConfig> versionConfigs;
     VersionConfig versionConfig;
 
+    bool cacheGetters;
+    std::unordered_map<std::string, TraCIBuffer> staticCache; /**< responses to getters of values that only change via setters of this class, by cacheKey */
+    std::unordered_map<std::string, TraCIBuffer> dynamicCache; /**< responses to all other getters, by cacheKey */
+    uint64_t dynamicCacheVersion; /**< TraCIConnection::getStateVersion when dynamicCache was last valid */
+    CacheStatistics cacheStatistics;
+    std::unique_ptr<TraCINetworkGeometry> networkGeometry; /**< see setCacheNetworkGeometry */
+
+    /**
+     * sends a getter command for variableId of objectId and returns the response, or returns a cached copy of it (see setCacheGetters)
+     */
+    TraCIBuffer queryGetter(uint8_t commandId, const std::string& objectId, uint8_t variableId, TraCIConnection::Result* result);
+
+    /**
+     * whether variableId of an object queried via commandId only changes via setters of this class (which call forgetStaticVariable)
+     */
+    static bool isStaticVariable(uint8_t commandId, uint8_t variableId);
+
+    /**
+     * drops the cached value of variableId of an object queried via commandId, to be called by setters of static variables
+     */
+    void forgetStaticVariable(uint8_t commandId, const std::string& objectId, uint8_t variableId);
+
+    static std::string cacheKey(uint8_t commandId, const std::string& objectId, uint8_t variableId);
+
+    /**
+     * reads the header of the response to a getter command from buf, checking that it matches the command
+     */
+    static void readGetterResponseHeader(TraCIBuffer& buf, uint8_t responseId, const std::string& objectId, uint8_t variableId, uint8_t resultTypeId);
+
+    /**
+     * returns the parameters of a CMD_SET_POLYGON_VARIABLE command adding a polygon
+     */
+    TraCIBuffer makeAddPolygonParameters(const std::string& polyId, const std::string& polyType, const TraCIColor& color, bool filled, int32_t layer, const std::list<Coord>& points) const;
+
     std::string genericGetString(uint8_t commandId, std::string objectId, uint8_t variableId, uint8_t responseId, TraCIConnection::Result* result = nullptr);
     Coord genericGetCoord(uint8_t commandId, std::string objectId, uint8_t variableId, uint8_t responseId, TraCIConnection::Result* result = nullptr);
     double genericGetDouble(uint8_t commandId, std::string objectId, uint8_t variableId, uint8_t responseId, TraCIConnection::Result* result = nullptr);
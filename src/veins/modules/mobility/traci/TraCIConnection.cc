@@ -6,9 +6,11 @@
 #include <netinet/tcp.h>
 #include <netdb.h>
 #include <arpa/inet.h>
+#include <sys/un.h>
 #endif
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
 
 #include "veins/modules/mobility/traci/TraCIConnection.h"
@@ -32,6 +34,22 @@ struct traci2omnet_functor : public std::unary_function<TraCICoord, Coord> {
     const TraCIConnection& owner;
 };
 
+const char* const TraCIConnection::unixSocketPrefix = "unix:";
+
+namespace {
+
+/**
+ * first bytes of a session recording (version 1)
+ *
+ * Each message follows as one byte for its direction (sessionSent or sessionReceived), its length (4 bytes, TraCI byte order), and its contents.
+ * Sent messages include their length prefix, received ones do not.
+ */
+const char sessionMagic[] = "veins-traci-session-1\n";
+const char sessionSent = 'S';
+const char sessionReceived = 'R';
+
+} // namespace
+
 SOCKET socket(void* ptr)
 {
     ASSERT(ptr);
@@ -52,11 +70,124 @@ TraCIConnection::Result::Result(bool success, bool not_impl, std::string message
 {
 }
 
+namespace {
+
+/**
+ * store status response to command in result or, if result is nullptr, throw if it does not indicate success
+ */
+void handleStatus(uint8_t commandId, uint8_t resultCode, const std::string& description, TraCIConnection::Result* result)
+{
+    if (result != nullptr) {
+        result->success = (resultCode == RTYPE_OK);
+        result->not_impl = (resultCode == RTYPE_NOTIMPLEMENTED);
+        result->message = description;
+    }
+    else {
+        if (resultCode == RTYPE_NOTIMPLEMENTED) throw cRuntimeError("TraCI server reported command 0x%2x not implemented (\"%s\"). Might need newer version.", commandId, description.c_str());
+        if (resultCode != RTYPE_OK) throw cRuntimeError("TraCI server reported status %d executing command 0x%2x (\"%s\").", (int) resultCode, commandId, description.c_str());
+    }
+}
+
+/**
+ * number of responses the server sends after a successful status response to commandId with parameters buf (not applicable to CMD_SIMSTEP2)
+ */
+uint8_t countResponses(uint8_t commandId, const TraCIBuffer& buf)
+{
+    if (commandId == CMD_GETVERSION) return 1;
+    if ((commandId >= 0xa0) && (commandId <= 0xaf)) return 1; // variable retrieval
+
+    bool isContextSubscription = (commandId >= 0x80) && (commandId <= 0x8f);
+    bool isVariableSubscription = (commandId >= 0xd0) && (commandId <= 0xdf);
+    if (!isContextSubscription && !isVariableSubscription) return 0;
+
+    // subscribing to no variables cancels a subscription, which yields no response
+    TraCIBuffer parameters(buf);
+    parameters.read<simtime_t>(); // begin time
+    parameters.read<simtime_t>(); // end time
+    parameters.readStringRef(); // object id
+    if (isContextSubscription) {
+        parameters.read<uint8_t>(); // context domain
+        parameters.read<double>(); // context range
+    }
+    uint8_t variableCount = parameters.read<uint8_t>();
+    return (variableCount == 0) ? 0 : 1;
+}
+
+} // namespace
+
+void TraCIConnection::Batch::add(uint8_t commandId, const TraCIBuffer& buf)
+{
+    if (!commandIds.empty() && (commandIds.back() == CMD_SIMSTEP2)) throw cRuntimeError("CMD_SIMSTEP2 must be the last command of a TraCI command batch");
+    commands.reserve(traCICommandLength(buf));
+    appendTraCICommand(commands, commandId, buf);
+    commandIds.push_back(commandId);
+    responseCounts.push_back(countResponses(commandId, buf));
+    changesState = changesState || TraCIConnection::mayChangeState(commandId);
+}
+
+void TraCIConnection::Batch::clear()
+{
+    commands.clear();
+    commandIds.clear();
+    responseCounts.clear();
+    changesState = false;
+}
+
+void TraCIConnection::Batch::demultiplex(TraCIBuffer& response, const ResponseHandler& handler, std::vector<Result>* results) const
+{
+    if (results != nullptr) results->assign(commandIds.size(), Result());
+
+    TraCIBuffer commandResponse;
+    for (size_t i = 0; i < commandIds.size(); ++i) {
+        uint8_t commandId = commandIds[i];
+
+        // status response
+        uint8_t cmdLength;
+        response >> cmdLength;
+        if (cmdLength == 0) {
+            uint32_t cmdLengthExt;
+            response >> cmdLengthExt;
+        }
+        uint8_t commandResp;
+        response >> commandResp;
+        ASSERT(commandResp == commandId);
+        uint8_t resultCode;
+        response >> resultCode;
+        std::string description;
+        response >> description;
+        handleStatus(commandId, resultCode, description, (results != nullptr) ? &results->at(i) : nullptr);
+
+        // additional responses: none if the command failed, all of the rest for CMD_SIMSTEP2 (which is always last), else as many as recorded when it was queued
+        size_t length = 0;
+        if ((resultCode == RTYPE_OK) && (commandId == CMD_SIMSTEP2)) {
+            length = response.remaining();
+        }
+        else if (resultCode == RTYPE_OK) {
+            for (uint8_t j = 0; j < responseCounts[i]; ++j) {
+                if (length >= response.remaining()) throw cRuntimeError("TraCI response to command 0x%02x ends early", commandId);
+                uint32_t itemLength = response.peek<uint8_t>(length);
+                size_t headerLength = sizeof(uint8_t);
+                if (itemLength == 0) {
+                    itemLength = response.peek<uint32_t>(length + headerLength);
+                    headerLength += sizeof(uint32_t);
+                }
+                if (itemLength <= headerLength) throw cRuntimeError("Received invalid TraCI response of length %u", itemLength);
+                length += itemLength;
+            }
+        }
+        response.readRaw(commandResponse, length);
+        handler(i, commandResponse);
+    }
+}
+
 TraCIConnection::TraCIConnection(cComponent* owner, void* ptr)
     : HasLogProxy(owner)
     , socketPtr(ptr)
+    , stepState(StepState::none)
+    , stalledStepCount(0)
+    , sessionMessageCount(0)
+    , stateVersion(0)
 {
-    ASSERT(socketPtr);
 }
 
 TraCIConnection::~TraCIConnection()
@@ -67,8 +198,46 @@ TraCIConnection::~TraCIConnection()
     }
 }
 
+namespace {
+
+/**
+ * connects socketPtr to address, retrying for a while in case the server is still starting up
+ */
+void connectWithRetries(SOCKET* socketPtr, int domain, const sockaddr* address, socklen_t addressLength)
+{
+    EV_STATICCONTEXT;
+
+    for (int tries = 1; tries <= 10; ++tries) {
+        *socketPtr = ::socket(domain, SOCK_STREAM, 0);
+        if (*socketPtr < 0) throw cRuntimeError("Could not create socket to connect to TraCI server");
+        if (::connect(*socketPtr, address, addressLength) >= 0) break;
+        closesocket(*socketPtr);
+
+        std::stringstream ss;
+        ss << "Could not connect to TraCI server; error message: " << sock_errno() << ": " << strerror(sock_errno());
+        std::string msg = ss.str();
+
+        int sleepDuration = tries * .25 + 1;
+
+        if (tries >= 10) {
+            throw cRuntimeError(msg.c_str());
+        }
+        else if (tries == 3) {
+            EV_WARN << msg << " -- Will retry in " << sleepDuration << " second(s)." << std::endl;
+        }
+
+        sleep(sleepDuration);
+    }
+}
+
+} // namespace
+
 TraCIConnection* TraCIConnection::connect(cComponent* owner, const char* host, int port)
 {
+    if (std::strncmp(host, unixSocketPrefix, std::strlen(unixSocketPrefix)) == 0) {
+        return connectUnix(owner, host + std::strlen(unixSocketPrefix));
+    }
+
     EV_STATICCONTEXT;
     EV_INFO << "TraCIScenarioManager connecting to TraCI server" << endl;
 
@@ -98,42 +267,130 @@ TraCIConnection* TraCIConnection::connect(cComponent* owner, const char* host, i
     address.sin_addr.s_addr = addr.s_addr;
 
     SOCKET* socketPtr = new SOCKET();
-    if (*socketPtr < 0) throw cRuntimeError("Could not create socket to connect to TraCI server");
+    connectWithRetries(socketPtr, AF_INET, address_p, sizeof(address));
 
-    for (int tries = 1; tries <= 10; ++tries) {
-        *socketPtr = ::socket(AF_INET, SOCK_STREAM, 0);
-        if (::connect(*socketPtr, address_p, sizeof(address)) >= 0) break;
-        closesocket(socket(socketPtr));
+    {
+        int x = 1;
+        ::setsockopt(*socketPtr, IPPROTO_TCP, TCP_NODELAY, (const char*) &x, sizeof(x));
+    }
 
-        std::stringstream ss;
-        ss << "Could not connect to TraCI server; error message: " << sock_errno() << ": " << strerror(sock_errno());
-        std::string msg = ss.str();
+    return new TraCIConnection(owner, socketPtr);
+}
 
-        int sleepDuration = tries * .25 + 1;
+TraCIConnection* TraCIConnection::replay(cComponent* owner, const char* fileName)
+{
+    EV_STATICCONTEXT;
+    EV_INFO << "TraCIScenarioManager replaying TraCI session from " << fileName << endl;
 
-        if (tries >= 10) {
-            throw cRuntimeError(msg.c_str());
-        }
-        else if (tries == 3) {
-            EV_WARN << msg << " -- Will retry in " << sleepDuration << " second(s)." << std::endl;
-        }
+    std::unique_ptr<std::ifstream> stream(new std::ifstream(fileName, std::ios::in | std::ios::binary));
+    if (!stream->is_open()) throw cRuntimeError("Could not open recorded TraCI session \"%s\"", fileName);
+    char magic[sizeof(sessionMagic) - 1];
+    stream->read(magic, sizeof(magic));
+    if (!*stream || (std::memcmp(magic, sessionMagic, sizeof(magic)) != 0)) throw cRuntimeError("File \"%s\" is not a recorded TraCI session", fileName);
 
-        sleep(sleepDuration);
-    }
+    TraCIConnection* connection = new TraCIConnection(owner, nullptr);
+    connection->replayStream = std::move(stream);
+    return connection;
+}
 
-    {
-        int x = 1;
-        ::setsockopt(*socketPtr, IPPROTO_TCP, TCP_NODELAY, (const char*) &x, sizeof(x));
+void TraCIConnection::enableStatistics()
+{
+    if (!statistics) statistics.reset(new TraCIStatistics());
+}
+
+void TraCIConnection::startRecording(const char* fileName)
+{
+    if (replayStream) throw cRuntimeError("Cannot record a replayed TraCI session");
+    EV_INFO << "Recording TraCI session to " << fileName << endl;
+    recordStream.reset(new std::ofstream(fileName, std::ios::out | std::ios::binary | std::ios::trunc));
+    if (!recordStream->is_open()) throw cRuntimeError("Could not open \"%s\" for recording TraCI session", fileName);
+    recordStream->write(sessionMagic, sizeof(sessionMagic) - 1);
+}
+
+void TraCIConnection::recordMessage(char direction, const TraCIBuffer& buf)
+{
+    uint32_t length = TraCIBufferDetail::toTraCIByteOrder(static_cast<uint32_t>(buf.size()));
+    recordStream->put(direction);
+    recordStream->write(reinterpret_cast<const char*>(&length), sizeof(length));
+    recordStream->write(reinterpret_cast<const char*>(buf.data()), buf.size());
+    if (!*recordStream) throw cRuntimeError("Could not write recorded TraCI session");
+    sessionMessageCount++;
+}
+
+uint32_t TraCIConnection::replayMessageHeader(char direction)
+{
+    char recordedDirection;
+    uint32_t length;
+    replayStream->get(recordedDirection);
+    replayStream->read(reinterpret_cast<char*>(&length), sizeof(length));
+    if (!*replayStream) throw cRuntimeError("Replay of TraCI session diverged from recording: recording ends after %lu messages", static_cast<unsigned long>(sessionMessageCount));
+    if (recordedDirection != direction) {
+        throw cRuntimeError("Replay of TraCI session diverged from recording at message %lu: %s a message, but recording %s one", static_cast<unsigned long>(sessionMessageCount), (direction == sessionSent) ? "sending" : "receiving", (recordedDirection == sessionSent) ? "sent" : "received");
     }
+    sessionMessageCount++;
+    return TraCIBufferDetail::toTraCIByteOrder(length);
+}
+
+TraCIConnection* TraCIConnection::connectUnix(cComponent* owner, const char* path)
+{
+    EV_STATICCONTEXT;
+    EV_INFO << "TraCIScenarioManager connecting to TraCI server at Unix domain socket " << path << endl;
+
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32) || defined(__CYGWIN__) || defined(_WIN64)
+    throw cRuntimeError("Unix domain sockets are not supported on this platform");
+#else
+    sockaddr_un address;
+    if (std::strlen(path) >= sizeof(address.sun_path)) throw cRuntimeError("Unix domain socket path too long: %s", path);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
 
+    SOCKET* socketPtr = new SOCKET();
+    connectWithRetries(socketPtr, AF_UNIX, (sockaddr*) &address, sizeof(address));
+
+    // no Nagle's algorithm to disable: Unix domain sockets do not delay small writes
     return new TraCIConnection(owner, socketPtr);
+#endif
 }
 
 TraCIBuffer TraCIConnection::query(uint8_t commandId, const TraCIBuffer& buf, Result* result)
 {
-    sendMessage(makeTraCICommand(commandId, buf));
+    TraCIBuffer obuf;
+    query(commandId, buf, obuf, result);
+    return obuf;
+}
 
-    TraCIBuffer obuf(receiveMessage());
+bool TraCIConnection::mayChangeState(uint8_t commandId)
+{
+    if (commandId == CMD_GETVERSION) return false;
+    if ((commandId >= 0x80) && (commandId <= 0x8f)) return false; // context subscriptions
+    if ((commandId >= 0xa0) && (commandId <= 0xaf)) return false; // variable retrieval
+    if ((commandId >= 0xd0) && (commandId <= 0xdf)) return false; // variable subscriptions
+    return true;
+}
+
+void TraCIConnection::query(uint8_t commandId, const TraCIBuffer& buf, TraCIBuffer& obuf, Result* result)
+{
+    settlePendingStep();
+    if (mayChangeState(commandId)) stateVersion++;
+    TraCIStatistics::CommandStatistics* commandStatistics = statistics ? &statistics->getCommand(commandId) : nullptr;
+    TraCIStatistics::ScopedTimer timer(commandStatistics ? &commandStatistics->roundTrip : nullptr);
+
+    // assemble length prefix and command in one buffer, so the whole message goes out in a single call
+    uint32_t msgLength = sizeof(uint32_t) + traCICommandLength(buf);
+    sendBuffer.clear();
+    sendBuffer.reserve(msgLength);
+    sendBuffer << msgLength;
+    appendTraCICommand(sendBuffer, commandId, buf);
+    ASSERT(sendBuffer.size() == msgLength);
+    sendRaw(sendBuffer);
+
+    receiveMessage(obuf);
+    if (commandStatistics) {
+        commandStatistics->count++;
+        commandStatistics->bytesSent += msgLength;
+        commandStatistics->bytesReceived += sizeof(uint32_t) + obuf.size();
+    }
     uint8_t cmdLength;
     obuf >> cmdLength;
     uint8_t commandResp;
@@ -143,113 +400,233 @@ TraCIBuffer TraCIConnection::query(uint8_t commandId, const TraCIBuffer& buf, Re
     obuf >> resultCode;
     std::string description;
     obuf >> description;
-    if (result != nullptr) {
-        result->success = (resultCode == RTYPE_OK);
-        result->not_impl = (resultCode == RTYPE_NOTIMPLEMENTED);
-        result->message = description;
+    handleStatus(commandId, resultCode, description, result);
+}
+
+void TraCIConnection::query(const Batch& batch, const ResponseHandler& handler, std::vector<Result>* results)
+{
+    if (batch.empty()) {
+        if (results != nullptr) results->clear();
+        return;
+    }
+
+    settlePendingStep();
+    if (batch.mayChangeState()) stateVersion++;
+    TraCIStatistics::Clock::time_point sentAt = statistics ? TraCIStatistics::Clock::now() : TraCIStatistics::Clock::time_point();
+
+    const TraCIBuffer& commands = batch.getCommands();
+    uint32_t msgLength = sizeof(uint32_t) + commands.size();
+    sendBuffer.clear();
+    sendBuffer.reserve(msgLength);
+    sendBuffer << msgLength;
+    sendBuffer.append(commands);
+    sendRaw(sendBuffer);
+
+    // handlers may issue queries of their own, so the response cannot live in a member buffer
+    TraCIBuffer response;
+    receiveMessage(response);
+    if (statistics) {
+        for (uint8_t commandId : batch.getCommandIds()) statistics->getCommand(commandId).count++;
+        statistics->getBatches().count++;
+        statistics->getBatches().bytesSent += msgLength;
+        statistics->getBatches().bytesReceived += sizeof(uint32_t) + response.size();
+        // stop the clock before the handlers run, as they may issue queries of their own
+        statistics->getBatches().roundTrip.record(TraCIStatistics::Clock::now() - sentAt);
+    }
+    batch.demultiplex(response, handler, results);
+    ASSERT(response.eof());
+}
+
+void TraCIConnection::sendStep(const TraCIBuffer& buf)
+{
+    if (stepState != StepState::none) throw cRuntimeError("Cannot send a simulation step while another one is pending");
+
+    uint32_t msgLength = sizeof(uint32_t) + traCICommandLength(buf);
+    sendBuffer.clear();
+    sendBuffer.reserve(msgLength);
+    sendBuffer << msgLength;
+    appendTraCICommand(sendBuffer, CMD_SIMSTEP2, buf);
+    if (statistics) stepSentAt = TraCIStatistics::Clock::now();
+    sendRaw(sendBuffer);
+    stepState = StepState::sent;
+    stateVersion++;
+    if (statistics) {
+        statistics->getCommand(CMD_SIMSTEP2).count++;
+        statistics->getCommand(CMD_SIMSTEP2).bytesSent += msgLength;
+    }
+}
+
+void TraCIConnection::settlePendingStep()
+{
+    if (stepState != StepState::sent) return;
+    EV_DEBUG << "Waiting for pending simulation step before sending next command" << endl;
+    receiveMessage(stepResponse);
+    stepState = StepState::received;
+    stalledStepCount++;
+    recordStepReceived(stepResponse);
+}
+
+void TraCIConnection::recordStepReceived(const TraCIBuffer& response)
+{
+    if (!statistics) return;
+    TraCIStatistics::CommandStatistics& step = statistics->getCommand(CMD_SIMSTEP2);
+    step.bytesReceived += sizeof(uint32_t) + response.size();
+    step.roundTrip.record(TraCIStatistics::Clock::now() - stepSentAt);
+}
+
+void TraCIConnection::receiveStep(TraCIBuffer& response)
+{
+    if (stepState == StepState::none) throw cRuntimeError("No simulation step pending");
+    if (stepState == StepState::sent) {
+        receiveMessage(response);
+        recordStepReceived(response);
     }
     else {
-        if (resultCode == RTYPE_NOTIMPLEMENTED) throw cRuntimeError("TraCI server reported command 0x%2x not implemented (\"%s\"). Might need newer version.", commandId, description.c_str());
-        if (resultCode != RTYPE_OK) throw cRuntimeError("TraCI server reported status %d executing command 0x%2x (\"%s\").", (int) resultCode, commandId, description.c_str());
+        std::swap(response, stepResponse);
     }
-    return obuf;
+    stepState = StepState::none;
+
+    uint8_t cmdLength;
+    response >> cmdLength;
+    uint8_t commandResp;
+    response >> commandResp;
+    ASSERT(commandResp == CMD_SIMSTEP2);
+    uint8_t resultCode;
+    response >> resultCode;
+    std::string description;
+    response >> description;
+    handleStatus(CMD_SIMSTEP2, resultCode, description, nullptr);
 }
 
 std::string TraCIConnection::receiveMessage()
 {
-    if (!socketPtr) throw cRuntimeError("Not connected to TraCI server");
+    TraCIBuffer buf;
+    receiveMessage(buf);
+    return buf.str();
+}
 
-    uint32_t msgLength;
-    {
-        char buf2[sizeof(uint32_t)];
-        uint32_t bytesRead = 0;
-        while (bytesRead < sizeof(uint32_t)) {
-            int receivedBytes = ::recv(socket(socketPtr), reinterpret_cast<char*>(&buf2) + bytesRead, sizeof(uint32_t) - bytesRead, 0);
-            if (receivedBytes > 0) {
-                bytesRead += receivedBytes;
-            }
-            else if (receivedBytes == 0) {
-                throw cRuntimeError("Connection to TraCI server closed unexpectedly. Check your server's log");
-            }
-            else {
-                if (sock_errno() == EINTR) continue;
-                if (sock_errno() == EAGAIN) continue;
-                throw cRuntimeError("Connection to TraCI server lost. Check your server's log. Error message: %d: %s", sock_errno(), strerror(sock_errno()));
-            }
+namespace {
+
+void receiveAll(void* socketPtr, uint8_t* buf, uint32_t bufLength)
+{
+    uint32_t bytesRead = 0;
+    while (bytesRead < bufLength) {
+        int receivedBytes = ::recv(socket(socketPtr), reinterpret_cast<char*>(buf) + bytesRead, bufLength - bytesRead, 0);
+        if (receivedBytes > 0) {
+            bytesRead += receivedBytes;
+        }
+        else if (receivedBytes == 0) {
+            throw cRuntimeError("Connection to TraCI server closed unexpectedly. Check your server's log");
+        }
+        else {
+            if (sock_errno() == EINTR) continue;
+            if (sock_errno() == EAGAIN) continue;
+            throw cRuntimeError("Connection to TraCI server lost. Check your server's log. Error message: %d: %s", sock_errno(), strerror(sock_errno()));
         }
-        TraCIBuffer(std::string(buf2, sizeof(uint32_t))) >> msgLength;
     }
+}
 
-    uint32_t bufLength = msgLength - sizeof(msgLength);
-    char buf[bufLength];
-    {
-        EV_TRACE << "Reading TraCI message of " << bufLength << " bytes" << endl;
-        uint32_t bytesRead = 0;
-        while (bytesRead < bufLength) {
-            int receivedBytes = ::recv(socket(socketPtr), reinterpret_cast<char*>(&buf) + bytesRead, bufLength - bytesRead, 0);
-            if (receivedBytes > 0) {
-                bytesRead += receivedBytes;
-            }
-            else if (receivedBytes == 0) {
-                throw cRuntimeError("Connection to TraCI server closed unexpectedly. Check your server's log");
-            }
-            else {
-                if (sock_errno() == EINTR) continue;
-                if (sock_errno() == EAGAIN) continue;
-                throw cRuntimeError("Connection to TraCI server lost. Check your server's log. Error message: %d: %s", sock_errno(), strerror(sock_errno()));
-            }
-        }
+} // namespace
+
+void TraCIConnection::receiveMessage(TraCIBuffer& buf)
+{
+    TraCIStatistics::ScopedTimer timer(statistics ? &statistics->getWait() : nullptr);
+
+    if (replayStream) {
+        uint32_t length = replayMessageHeader(sessionReceived);
+        replayStream->read(reinterpret_cast<char*>(buf.reset(length)), length);
+        if (!*replayStream) throw cRuntimeError("Recorded TraCI session is truncated");
+        if (statistics) statistics->recordReceived(sizeof(uint32_t) + length);
+        return;
     }
-    return std::string(buf, bufLength);
+
+    if (!socketPtr) throw cRuntimeError("Not connected to TraCI server");
+
+    uint32_t msgLength;
+    receiveAll(socketPtr, reinterpret_cast<uint8_t*>(&msgLength), sizeof(msgLength));
+    msgLength = TraCIBufferDetail::toTraCIByteOrder(msgLength);
+    if (msgLength < sizeof(msgLength)) throw cRuntimeError("Received invalid TraCI message length %u", msgLength);
+
+    // receive straight into the (heap) storage of buf
+    uint32_t bufLength = msgLength - sizeof(msgLength);
+    EV_TRACE << "Reading TraCI message of " << bufLength << " bytes" << endl;
+    receiveAll(socketPtr, buf.reset(bufLength), bufLength);
+    if (statistics) statistics->recordReceived(msgLength);
+
+    if (recordStream) recordMessage(sessionReceived, buf);
 }
 
 void TraCIConnection::sendMessage(std::string buf)
 {
-    if (!socketPtr) throw cRuntimeError("Not connected to TraCI server");
+    settlePendingStep();
+    stateVersion++; // contents unknown, so assume the worst
+
+    sendBuffer.clear();
+    sendBuffer.reserve(sizeof(uint32_t) + buf.length());
+    sendBuffer << static_cast<uint32_t>(sizeof(uint32_t) + buf.length());
+    for (char c : buf) sendBuffer << c;
+    sendRaw(sendBuffer);
+}
 
-    {
-        uint32_t msgLength = sizeof(uint32_t) + buf.length();
-        TraCIBuffer buf2 = TraCIBuffer();
-        buf2 << msgLength;
-        uint32_t bytesWritten = 0;
-        while (bytesWritten < sizeof(uint32_t)) {
-            ssize_t sentBytes = ::send(socket(socketPtr), buf2.str().c_str() + bytesWritten, sizeof(uint32_t) - bytesWritten, 0);
-            if (sentBytes > 0) {
-                bytesWritten += sentBytes;
-            }
-            else {
-                if (sock_errno() == EINTR) continue;
-                if (sock_errno() == EAGAIN) continue;
-                throw cRuntimeError("Connection to TraCI server lost. Check your server's log. Error message: %d: %s", sock_errno(), strerror(sock_errno()));
-            }
+void TraCIConnection::sendRaw(const TraCIBuffer& buf)
+{
+    if (statistics) statistics->recordSent(buf.size());
+
+    if (replayStream) {
+        uint32_t length = replayMessageHeader(sessionSent);
+        replayBuffer.resize(length);
+        replayStream->read(replayBuffer.data(), length);
+        if (!*replayStream) throw cRuntimeError("Recorded TraCI session is truncated");
+        if ((length != buf.size()) || (std::memcmp(replayBuffer.data(), buf.data(), length) != 0)) {
+            throw cRuntimeError("Replay of TraCI session diverged from recording at message %lu: sending %s, but recording sent %s", static_cast<unsigned long>(sessionMessageCount - 1), buf.hexStr().c_str(), TraCIBuffer(std::string(replayBuffer.data(), length)).hexStr().c_str());
         }
+        return;
     }
 
-    {
-        EV_TRACE << "Writing TraCI message of " << buf.length() << " bytes" << endl;
-        uint32_t bytesWritten = 0;
-        while (bytesWritten < buf.length()) {
-            ssize_t sentBytes = ::send(socket(socketPtr), buf.c_str() + bytesWritten, buf.length() - bytesWritten, 0);
-            if (sentBytes > 0) {
-                bytesWritten += sentBytes;
-            }
-            else {
-                if (sock_errno() == EINTR) continue;
-                if (sock_errno() == EAGAIN) continue;
-                throw cRuntimeError("Connection to TraCI server lost. Check your server's log. Error message: %d: %s", sock_errno(), strerror(sock_errno()));
-            }
+    if (!socketPtr) throw cRuntimeError("Not connected to TraCI server");
+
+    EV_TRACE << "Writing TraCI message of " << buf.size() << " bytes" << endl;
+    size_t bytesWritten = 0;
+    while (bytesWritten < buf.size()) {
+        ssize_t sentBytes = ::send(socket(socketPtr), reinterpret_cast<const char*>(buf.data()) + bytesWritten, buf.size() - bytesWritten, 0);
+        if (sentBytes > 0) {
+            bytesWritten += sentBytes;
+        }
+        else {
+            if (sock_errno() == EINTR) continue;
+            if (sock_errno() == EAGAIN) continue;
+            throw cRuntimeError("Connection to TraCI server lost. Check your server's log. Error message: %d: %s", sock_errno(), strerror(sock_errno()));
         }
     }
+
+    if (recordStream) recordMessage(sessionSent, buf);
 }
 
 std::string makeTraCICommand(uint8_t commandId, const TraCIBuffer& buf)
 {
-    if (sizeof(uint8_t) + sizeof(uint8_t) + buf.str().length() > 0xFF) {
-        uint32_t len = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint8_t) + buf.str().length();
-        return (TraCIBuffer() << static_cast<uint8_t>(0) << len << commandId).str() + buf.str();
+    TraCIBuffer out;
+    appendTraCICommand(out, commandId, buf);
+    return out.str();
+}
+
+uint32_t traCICommandLength(const TraCIBuffer& buf)
+{
+    if (sizeof(uint8_t) + sizeof(uint8_t) + buf.size() > 0xFF) {
+        return sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint8_t) + buf.size();
+    }
+    return sizeof(uint8_t) + sizeof(uint8_t) + buf.size();
+}
+
+void appendTraCICommand(TraCIBuffer& out, uint8_t commandId, const TraCIBuffer& buf)
+{
+    uint32_t len = traCICommandLength(buf);
+    if (len > 0xFF) {
+        out << static_cast<uint8_t>(0) << len << commandId;
+    }
+    else {
+        out << static_cast<uint8_t>(len) << commandId;
     }
-    uint8_t len = sizeof(uint8_t) + sizeof(uint8_t) + buf.str().length();
-    return (TraCIBuffer() << len << commandId).str() + buf.str();
+    out.append(buf);
 }
 
 void TraCIConnection::setNetbounds(TraCICoord netbounds1, TraCICoord netbounds2, int margin)
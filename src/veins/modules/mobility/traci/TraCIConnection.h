@@ -1,11 +1,15 @@
 #pragma once
 
 #include <stdint.h>
+#include <fstream>
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include "veins/modules/mobility/traci/TraCIBuffer.h"
 #include "veins/modules/mobility/traci/TraCICoord.h"
 #include "veins/modules/mobility/traci/TraCICoordinateTransformation.h"
+#include "veins/modules/mobility/traci/TraCIStatistics.h"
 #include "veins/base/utils/Coord.h"
 #include "veins/base/utils/Heading.h"
 #include "veins/modules/utility/HasLogProxy.h"
@@ -24,7 +28,125 @@ public:
         std::string message;
     };
 
+    /**
+     * called once for each command of a Batch, in order, with its position in the batch and any responses following its status response
+     */
+    typedef std::function<void(size_t, TraCIBuffer&)> ResponseHandler;
+
+    /**
+     * A sequence of TraCI commands to be sent to the server in a single message.
+     *
+     * Saves one round trip per command compared to issuing each command with its own query.
+     * The responses to each command are told apart by the number of responses it yields if its status response reports success, as recorded when it was queued.
+     * CMD_SIMSTEP2 yields a number of responses only known from its response, so it can only be the last command of a batch.
+     */
+    class VEINS_API Batch {
+    public:
+        /**
+         * queues a command with optional parameters
+         */
+        void add(uint8_t commandId, const TraCIBuffer& buf = TraCIBuffer());
+
+        size_t size() const
+        {
+            return commandIds.size();
+        }
+
+        bool empty() const
+        {
+            return commandIds.empty();
+        }
+
+        void clear();
+
+        /**
+         * splits the server's response to this batch into the responses to each command.
+         *
+         * Checks each status response, then calls handler with the responses following it (none if the command failed).
+         * @param response: message received from the server
+         * @param handler: to be called for each command
+         * @param results: where to store return values (if set to nullptr, any return value other than RTYPE_OK will trigger an exception).
+         */
+        void demultiplex(TraCIBuffer& response, const ResponseHandler& handler, std::vector<Result>* results = nullptr) const;
+
+        /**
+         * all queued commands, including their headers
+         */
+        const TraCIBuffer& getCommands() const
+        {
+            return commands;
+        }
+
+        /**
+         * ids of all queued commands, in order
+         */
+        const std::vector<uint8_t>& getCommandIds() const
+        {
+            return commandIds;
+        }
+
+        /**
+         * whether any queued command may change what the server reports (see mayChangeState)
+         */
+        bool mayChangeState() const
+        {
+            return changesState;
+        }
+
+    private:
+        TraCIBuffer commands;
+        std::vector<uint8_t> commandIds;
+        std::vector<uint8_t> responseCounts; /**< number of responses following the status response to each queued command if it succeeds (except for CMD_SIMSTEP2) */
+        bool changesState = false;
+    };
+
+    /**
+     * prefix of a host name that makes connect use the Unix domain socket at the path following it, instead of TCP
+     */
+    static const char* const unixSocketPrefix;
+
+    /**
+     * connects to the TraCI server at host and port via TCP or, if host starts with unixSocketPrefix, via a Unix domain socket (ignoring port).
+     *
+     * Both are stream sockets, so messages are framed the same way regardless of transport.
+     */
     static TraCIConnection* connect(cComponent* owner, const char* host, int port);
+
+    /**
+     * returns a connection that, instead of talking to a TraCI server, replays a session recorded by startRecording.
+     *
+     * Every message sent must match the one sent at the same point of the recorded session, otherwise an error is raised.
+     * @param fileName: file the session was recorded to
+     */
+    static TraCIConnection* replay(cComponent* owner, const char* fileName);
+
+    /**
+     * from now on, records every message sent and received to a file, for replay.
+     * @param fileName: file to record the session to (overwritten if it exists)
+     */
+    void startRecording(const char* fileName);
+
+    /**
+     * whether this connection replays a recorded session (see replay)
+     */
+    bool isReplaying() const
+    {
+        return static_cast<bool>(replayStream);
+    }
+
+    /**
+     * from now on, counts commands and bytes exchanged with the server and measures how long it takes to respond, see getStatistics
+     */
+    void enableStatistics();
+
+    /**
+     * statistics of the messages exchanged with the server (nullptr unless enableStatistics was called)
+     */
+    TraCIStatistics* getStatistics()
+    {
+        return statistics.get();
+    }
+
     void setNetbounds(TraCICoord netbounds1, TraCICoord netbounds2, int margin);
     ~TraCIConnection();
 
@@ -36,6 +158,65 @@ public:
      */
     TraCIBuffer query(uint8_t commandId, const TraCIBuffer& buf = TraCIBuffer(), Result* result = nullptr);
 
+    /**
+     * like query(uint8_t, const TraCIBuffer&, Result*), but receives into response.
+     * Keeping response around between calls avoids allocating memory for every query.
+     */
+    void query(uint8_t commandId, const TraCIBuffer& buf, TraCIBuffer& response, Result* result = nullptr);
+
+    /**
+     * sends all commands of batch in a single message and waits for the server's response to all of them.
+     * @param batch: commands to send (nothing is sent if it is empty)
+     * @param handler: to be called for each command with any responses following its status response
+     * @param results: where to store return values (if set to nullptr, any return value other than RTYPE_OK will trigger an exception).
+     */
+    void query(const Batch& batch, const ResponseHandler& handler, std::vector<Result>* results = nullptr);
+
+    /**
+     * sends CMD_SIMSTEP2 without waiting for the server to compute the step, see receiveStep.
+     *
+     * Until receiveStep is called, any other command first waits for (and keeps) the response to the step,
+     * so it reaches the server after the step and sees (and acts on) the state the step resulted in.
+     * @param buf: parameters to send (i.e., the target time)
+     */
+    void sendStep(const TraCIBuffer& buf);
+
+    /**
+     * whether a step sent by sendStep has not been received by receiveStep yet
+     */
+    bool isStepPending() const
+    {
+        return stepState != StepState::none;
+    }
+
+    /**
+     * receives the response to the step sent by sendStep into response, checks its status, and returns the subscription results following it.
+     */
+    void receiveStep(TraCIBuffer& response);
+
+    /**
+     * number of steps sent by sendStep that had to be waited for before receiveStep because another command was issued
+     */
+    size_t getStalledStepCount() const
+    {
+        return stalledStepCount;
+    }
+
+    /**
+     * counter that changes whenever a command is sent that may change what the server reports (i.e., anything but retrieving or subscribing to values).
+     *
+     * Values retrieved from the server remain valid as long as this counter does not change.
+     */
+    uint64_t getStateVersion() const
+    {
+        return stateVersion;
+    }
+
+    /**
+     * whether sending command commandId may change what the server reports
+     */
+    static bool mayChangeState(uint8_t commandId);
+
     /**
      * sends a message via TraCI (after adding the header)
      */
@@ -46,6 +227,11 @@ public:
      */
     std::string receiveMessage();
 
+    /**
+     * receives a message via TraCI (and strips the header) directly into buf
+     */
+    void receiveMessage(TraCIBuffer& buf);
+
     /**
      * convert TraCI heading to OMNeT++ heading (in rad)
      */
@@ -71,8 +257,58 @@ public:
 private:
     TraCIConnection(cComponent* owner, void* ptr);
 
+    /**
+     * connects to the TraCI server listening at the Unix domain socket at path
+     */
+    static TraCIConnection* connectUnix(cComponent* owner, const char* path);
+
+    /**
+     * sends all bytes of buf in one go
+     */
+    void sendRaw(const TraCIBuffer& buf);
+
+    /**
+     * if a step sent by sendStep is still being computed, waits for its response and keeps it for receiveStep
+     */
+    void settlePendingStep();
+
+    /**
+     * adds the response to the step sent by sendStep to the statistics (if enabled)
+     */
+    void recordStepReceived(const TraCIBuffer& response);
+
+    /**
+     * appends a message to the session recording
+     */
+    void recordMessage(char direction, const TraCIBuffer& buf);
+
+    /**
+     * reads the header of the next message of the replayed session, checks its direction, and returns its length
+     */
+    uint32_t replayMessageHeader(char direction);
+
+    /**
+     * progress of the step sent by sendStep
+     */
+    enum class StepState {
+        none, /**< no step pending */
+        sent, /**< step sent, response not yet received */
+        received, /**< response received (into stepResponse) ahead of receiveStep */
+    };
+
     void* socketPtr;
     std::unique_ptr<TraCICoordinateTransformation> coordinateTransformation;
+    TraCIBuffer sendBuffer; /**< reused for assembling outgoing messages */
+    StepState stepState;
+    TraCIBuffer stepResponse; /**< response to the step sent by sendStep, if received ahead of receiveStep */
+    size_t stalledStepCount;
+    std::unique_ptr<std::ofstream> recordStream; /**< session recording, if recording (see startRecording) */
+    std::unique_ptr<std::ifstream> replayStream; /**< recorded session, if replaying (see replay) */
+    uint64_t sessionMessageCount; /**< number of messages recorded or replayed so far */
+    std::vector<char> replayBuffer; /**< reused for reading recorded messages that were sent */
+    uint64_t stateVersion; /**< see getStateVersion */
+    std::unique_ptr<TraCIStatistics> statistics; /**< see enableStatistics */
+    TraCIStatistics::Clock::time_point stepSentAt; /**< when the step pending (see sendStep) was sent, if collecting statistics */
 };
 
 /**
@@ -80,4 +316,14 @@ private:
  */
 std::string makeTraCICommand(uint8_t commandId, const TraCIBuffer& buf = TraCIBuffer());
 
+/**
+ * returns the length in bytes of a TraCI command with parameters buf (including its header)
+ */
+uint32_t traCICommandLength(const TraCIBuffer& buf = TraCIBuffer());
+
+/**
+ * appends a TraCI command with optional parameters to out
+ */
+void appendTraCICommand(TraCIBuffer& out, uint8_t commandId, const TraCIBuffer& buf = TraCIBuffer());
+
 } // namespace Veins
@@ -265,6 +265,21 @@ const uint8_t CMD_SUBSCRIBE_LANEAREA_VARIABLE = 0xdd;
 // response: subscribe areal detector (e2) variable
 const uint8_t RESPONSE_SUBSCRIBE_LANEAREA_VARIABLE = 0xed;
 
+// command: subscribe person context
+const uint8_t CMD_SUBSCRIBE_PERSON_CONTEXT = 0x8e;
+// response: subscribe person context
+const uint8_t RESPONSE_SUBSCRIBE_PERSON_CONTEXT = 0x9e;
+// command: get person variable
+const uint8_t CMD_GET_PERSON_VARIABLE = 0xae;
+// response: get person variable
+const uint8_t RESPONSE_GET_PERSON_VARIABLE = 0xbe;
+// command: set person variable
+const uint8_t CMD_SET_PERSON_VARIABLE = 0xce;
+// command: subscribe person variable
+const uint8_t CMD_SUBSCRIBE_PERSON_VARIABLE = 0xde;
+// response: subscribe person variable
+const uint8_t RESPONSE_SUBSCRIBE_PERSON_VARIABLE = 0xee;
+
 // ****************************************
 // POSITION REPRESENTATIONS
 // ****************************************
@@ -652,6 +667,18 @@ const uint8_t VAR_PARKING_ENDING_VEHICLES_NUMBER = 0x6e;
 // ids of vehicles ending to park (get: simulation)
 const uint8_t VAR_PARKING_ENDING_VEHICLES_IDS = 0x6f;
 
+// number of departed persons (get: simulation)
+const uint8_t VAR_DEPARTED_PERSONS_NUMBER = 0x2e;
+
+// ids of departed persons (get: simulation)
+const uint8_t VAR_DEPARTED_PERSONS_IDS = 0x2f;
+
+// number of arrived persons (get: simulation)
+const uint8_t VAR_ARRIVED_PERSONS_NUMBER = 0x30;
+
+// ids of arrived persons (get: simulation)
+const uint8_t VAR_ARRIVED_PERSONS_IDS = 0x31;
+
 // delta t (get: simulation)
 const uint8_t VAR_DELTA_T = 0x7b;
 
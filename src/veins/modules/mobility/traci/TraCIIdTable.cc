@@ -0,0 +1,88 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "veins/modules/mobility/traci/TraCIIdTable.h"
+
+using Veins::TraCIIdTable;
+
+const TraCIIdTable::Handle TraCIIdTable::invalidHandle;
+
+TraCIIdTable::Handle TraCIIdTable::intern(const std::string& id)
+{
+    auto i = handles.find(id);
+    if (i != handles.end()) return i->second;
+
+    Handle handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+        ids[handle] = id;
+    }
+    else {
+        ASSERT(ids.size() < invalidHandle);
+        handle = static_cast<Handle>(ids.size());
+        ids.push_back(id);
+    }
+    handles.emplace(id, handle);
+    return handle;
+}
+
+TraCIIdTable::Handle TraCIIdTable::intern(const TraCIBuffer::StringRef& id)
+{
+    Handle handle = find(id);
+    if (handle != invalidHandle) return handle;
+    return intern(id.str());
+}
+
+TraCIIdTable::Handle TraCIIdTable::find(const std::string& id) const
+{
+    auto i = handles.find(id);
+    if (i == handles.end()) return invalidHandle;
+    return i->second;
+}
+
+TraCIIdTable::Handle TraCIIdTable::find(const TraCIBuffer::StringRef& id) const
+{
+    lookupKey.assign(id.data, id.size);
+    return find(lookupKey);
+}
+
+const std::string& TraCIIdTable::getId(Handle handle) const
+{
+    ASSERT(handle < ids.size());
+    return ids[handle];
+}
+
+void TraCIIdTable::release(Handle handle)
+{
+    ASSERT(handle < ids.size());
+    size_t erased = handles.erase(ids[handle]);
+    ASSERT(erased == 1);
+    (void) erased;
+    ids[handle].clear();
+    freeHandles.push_back(handle);
+}
+
+void TraCIIdTable::clear()
+{
+    handles.clear();
+    ids.clear();
+    freeHandles.clear();
+}
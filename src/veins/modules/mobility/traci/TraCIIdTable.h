@@ -0,0 +1,92 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "veins/veins.h"
+
+#include "veins/modules/mobility/traci/TraCIBuffer.h"
+
+namespace Veins {
+
+/**
+ * Maps TraCI object ids (e.g., of SUMO vehicles) to dense integer handles, assigned on first sight.
+ *
+ * Handles can index plain arrays of per-object state, so strings only need to be hashed once per lookup instead of being compared over and over in a tree.
+ * Released handles are handed out again, so all handles stay smaller than the largest number of objects known at any one time.
+ */
+class VEINS_API TraCIIdTable {
+public:
+    typedef uint32_t Handle;
+
+    static const Handle invalidHandle = 0xFFFFFFFF;
+
+    /**
+     * returns the handle of id, assigning a new one if id has not been seen before
+     */
+    Handle intern(const std::string& id);
+    Handle intern(const TraCIBuffer::StringRef& id);
+
+    /**
+     * returns the handle of id, or invalidHandle if id has not been seen before
+     */
+    Handle find(const std::string& id) const;
+    Handle find(const TraCIBuffer::StringRef& id) const;
+
+    /**
+     * returns the id a handle was assigned to
+     */
+    const std::string& getId(Handle handle) const;
+
+    /**
+     * forgets about the id of handle, so handle can be assigned to another id
+     */
+    void release(Handle handle);
+
+    /**
+     * returns the number of ids currently known
+     */
+    size_t size() const
+    {
+        return handles.size();
+    }
+
+    /**
+     * returns a bound that all handles handed out so far are smaller than, i.e., the size an array indexed by handle needs to have
+     */
+    size_t getHandleBound() const
+    {
+        return ids.size();
+    }
+
+    void clear();
+
+private:
+    std::unordered_map<std::string, Handle> handles;
+    std::vector<std::string> ids; /**< indexed by handle, empty for released handles */
+    std::vector<Handle> freeHandles;
+    mutable std::string lookupKey; /**< reused for looking up StringRefs without allocating memory */
+};
+
+} // namespace Veins
@@ -18,6 +18,7 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
 
+#include <cmath>
 #include <limits>
 #include <iostream>
 #include <sstream>
@@ -75,6 +76,8 @@ void TraCIMobility::initialize(int stage)
 
         hostPositionOffset = par("hostPositionOffset");
         setHostSpeed = par("setHostSpeed");
+        extrapolateTurns = par("extrapolateTurns");
+        maxLateralAcceleration = par("maxLateralAcceleration");
         accidentCount = par("accidentCount");
 
         currentPosXVec.setName("posx");
@@ -109,12 +112,7 @@ void TraCIMobility::initialize(int stage)
         manager = nullptr;
         last_speed = -1;
 
-        if (accidentCount > 0) {
-            simtime_t accidentStart = par("accidentStart");
-            startAccidentMsg = new cMessage("scheduledAccident");
-            stopAccidentMsg = new cMessage("scheduledAccidentResolved");
-            scheduleAt(simTime() + accidentStart, startAccidentMsg);
-        }
+        scheduleAccidents();
     }
     else if (stage == 1) {
         // don't call BaseMobility::initialize(stage) -- our parent will take care to call changePosition later
@@ -136,6 +134,56 @@ void TraCIMobility::finish()
     isPreInitialized = false;
 }
 
+void TraCIMobility::prepareForReuse()
+{
+    finish();
+
+    startAccidentMsg = nullptr;
+    stopAccidentMsg = nullptr;
+    delete vehicleCommandInterface;
+    vehicleCommandInterface = nullptr;
+}
+
+void TraCIMobility::reinitialize(int stage)
+{
+    if (stage != 0) return;
+
+    // BaseMobility was initialized along with the module, so only reset what belongs to the vehicle
+    accidentCount = par("accidentCount");
+
+    // naming the vectors again registers them under the new module path
+    currentPosXVec.setName("posx");
+    currentPosYVec.setName("posy");
+    currentSpeedVec.setName("speed");
+    currentAccelerationVec.setName("acceleration");
+    currentCO2EmissionVec.setName("co2emission");
+
+    statistics.initialize();
+
+    ASSERT(isPreInitialized);
+    isPreInitialized = false;
+
+    signals = VehicleSignalSet();
+    isParking = false;
+    last_speed = -1;
+
+    scheduleAccidents();
+}
+
+void TraCIMobility::scheduleAccidents()
+{
+    if ((accidentCount > 0) && !getVehicleCommandInterface()) {
+        EV_WARN << "ignoring accidentCount of " << getExternalId() << ", which is not a vehicle" << endl;
+        accidentCount = 0;
+    }
+    if (accidentCount > 0) {
+        simtime_t accidentStart = par("accidentStart");
+        startAccidentMsg = new cMessage("scheduledAccident");
+        stopAccidentMsg = new cMessage("scheduledAccidentResolved");
+        scheduleAt(simTime() + accidentStart, startAccidentMsg);
+    }
+}
+
 void TraCIMobility::handleSelfMsg(cMessage* msg)
 {
     if (msg == startAccidentMsg) {
@@ -237,10 +285,13 @@ void TraCIMobility::changePosition()
         hostMod->getDisplayString().setTagArg("veins", 0, ". ");
     }
 
+    double yawRate = extrapolateTurns ? calculateYawRate() : 0;
+
     move.setStart(Coord(nextPos.x, nextPos.y, move.getStartPosition().z)); // keep z position
     move.setDirectionByVector(heading.toCoord());
     if (this->setHostSpeed) {
         move.setSpeed(speed);
+        move.setYawRate(yawRate);
     }
     fixIfHostGetsOutside();
     updatePosition();
@@ -302,6 +353,24 @@ double TraCIMobility::calculateCO2emission(double v, double a) const
     return alpha + beta * v * 3.6 + delta * v * v * v * (3.6 * 3.6 * 3.6) + zeta * a * v;
 }
 
+double TraCIMobility::calculateYawRate() const
+{
+    if (heading.isNan()) return 0;
+
+    simtime_t dt = simTime() - move.getStartTime();
+    if (dt <= 0) return 0;
+
+    const Coord& lastDirection = move.getDirection();
+    Coord direction = heading.toCoord();
+    double yawRate = std::atan2(lastDirection.twoDimensionalCrossProduct(direction), lastDirection * direction) / dt.dbl();
+    if (!std::isfinite(yawRate)) return 0;
+
+    // the host keeps turning at this rate until the next update, so keep it from spinning around when the heading jumps at low speed (e.g., on junctions)
+    if (speed <= 0) return 0;
+    double maxYawRate = maxLateralAcceleration / speed;
+    return std::max(-maxYawRate, std::min(yawRate, maxYawRate));
+}
+
 Coord TraCIMobility::calculateHostPosition(const Coord& vehiclePos) const
 {
     Coord corPos;
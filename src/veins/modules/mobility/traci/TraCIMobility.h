@@ -29,6 +29,7 @@
 #include "veins/base/utils/FindModule.h"
 #include "veins/modules/mobility/traci/TraCIScenarioManager.h"
 #include "veins/modules/mobility/traci/TraCICommandInterface.h"
+#include "veins/modules/mobility/traci/TraCIReusableModule.h"
 #include "veins/modules/mobility/traci/VehicleSignal.h"
 #include "veins/base/utils/Heading.h"
 
@@ -50,7 +51,7 @@ namespace Veins {
  *
  * @ingroup mobility
  */
-class VEINS_API TraCIMobility : public BaseMobility {
+class VEINS_API TraCIMobility : public BaseMobility, public TraCIReusableModule {
 public:
     class VEINS_API Statistics {
     public:
@@ -84,6 +85,8 @@ public:
     }
     void initialize(int) override;
     void finish() override;
+    void prepareForReuse() override;
+    void reinitialize(int stage) override;
 
     void handleSelfMsg(cMessage* msg) override;
     virtual void preInitialize(std::string external_id, const Coord& position, std::string road_id = "", double speed = -1, Heading heading = Heading::nan);
@@ -135,11 +138,18 @@ public:
         if (!manager) manager = TraCIScenarioManagerAccess().get();
         return manager;
     }
+    /**
+     * Returns the command interface of the manager; throws if it has none (e.g., as it replays a trace or runs SUMO via libsumo)
+     */
     virtual TraCICommandInterface* getCommandInterface() const
     {
         if (!commandInterface) commandInterface = getManager()->getCommandInterface();
+        if (!commandInterface) throw cRuntimeError("%s asked for a TraCICommandInterface, but %s provides none (there is no TraCI connection)", getFullPath().c_str(), getManager()->getClassName());
         return commandInterface;
     }
+    /**
+     * Returns the command interface of this vehicle, or nullptr if the host is not a vehicle (e.g., a person)
+     */
     virtual TraCICommandInterface::Vehicle* getVehicleCommandInterface() const
     {
         if (!vehicleCommandInterface) vehicleCommandInterface = new TraCICommandInterface::Vehicle(getCommandInterface()->vehicle(getExternalId()));
@@ -170,6 +180,8 @@ protected:
     std::string external_id; /**< updated by setExternalId() */
     double hostPositionOffset; /**< front offset for the antenna on this car */
     bool setHostSpeed; /**< whether to update the speed of the host (along with its position)  */
+    bool extrapolateTurns; /**< whether to extrapolate positions along a circular arc (instead of a straight line) */
+    double maxLateralAcceleration; /**< upper bound of speed times yaw rate when extrapolating turns (in m/s^2) */
 
     simtime_t lastUpdate; /**< updated by nextPosition() */
     Coord roadPosition; /**< position of front bumper, updated by nextPosition() */
@@ -189,6 +201,11 @@ protected:
 
     void fixIfHostGetsOutside() override; /**< called after each read to check for (and handle) invalid positions */
 
+    /**
+     * schedules the first of accidentCount accidents (if any)
+     */
+    void scheduleAccidents();
+
     /**
      * Returns the amount of CO2 emissions in grams/second, calculated for an average Car
      * @param v speed in m/s
@@ -197,6 +214,13 @@ protected:
      */
     double calculateCO2emission(double v, double a) const;
 
+    /**
+     * Calculates how fast the host turns (in radians per second), given the heading of this update and the direction of the last one
+     *
+     * The result is limited to maxLateralAcceleration / speed, as it is extrapolated into the next update interval.
+     */
+    double calculateYawRate() const;
+
     /**
      * Calculates where the OMNeT++ module position of this car should be, given its front bumper position
      */
@@ -0,0 +1,221 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32) || defined(__CYGWIN__) || defined(_WIN64)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "veins/modules/mobility/traci/TraCINetworkGeometry.h"
+#include "veins/modules/mobility/traci/TraCIBuffer.h"
+
+using Veins::TraCIBuffer;
+using Veins::TraCINetworkGeometry;
+
+namespace {
+
+/**
+ * first bytes of a saved network geometry (version 1)
+ *
+ * The rest of the file is a TraCIBuffer holding the key, then all lanes (id, number of points, points), then all junctions (id, position).
+ */
+const char fileMagic[] = "veins-network-geometry-1\n";
+
+void writeCoord(TraCIBuffer& buf, const Veins::Coord& coord)
+{
+    buf << coord.x << coord.y << coord.z;
+}
+
+Veins::Coord readCoord(TraCIBuffer& buf)
+{
+    double x = buf.read<double>();
+    double y = buf.read<double>();
+    double z = buf.read<double>();
+    return Veins::Coord(x, y, z);
+}
+
+} // namespace
+
+bool TraCINetworkGeometry::findLaneShape(const std::string& laneId, std::list<Coord>& shape) const
+{
+    auto i = laneIndices.find(laneId);
+    if (i == laneIndices.end()) return false;
+    const Range& range = laneShapes[i->second];
+    shape.assign(shapePoints.begin() + range.begin, shapePoints.begin() + range.end);
+    return true;
+}
+
+void TraCINetworkGeometry::addLaneShape(const std::string& laneId, const std::list<Coord>& shape)
+{
+    if (laneIndices.find(laneId) != laneIndices.end()) return;
+    laneIndices[laneId] = laneIds.size();
+    laneIds.push_back(laneId);
+    Range range;
+    range.begin = shapePoints.size();
+    shapePoints.insert(shapePoints.end(), shape.begin(), shape.end());
+    range.end = shapePoints.size();
+    laneShapes.push_back(range);
+}
+
+bool TraCINetworkGeometry::findJunctionPosition(const std::string& junctionId, Coord& position) const
+{
+    auto i = junctionIndices.find(junctionId);
+    if (i == junctionIndices.end()) return false;
+    position = junctionPositions[i->second];
+    return true;
+}
+
+void TraCINetworkGeometry::addJunctionPosition(const std::string& junctionId, const Coord& position)
+{
+    if (junctionIndices.find(junctionId) != junctionIndices.end()) return;
+    junctionIndices[junctionId] = junctionIds.size();
+    junctionIds.push_back(junctionId);
+    junctionPositions.push_back(position);
+}
+
+bool TraCINetworkGeometry::findRouteRoadIds(const std::string& routeId, std::list<std::string>& roadIds) const
+{
+    auto i = routeRoadIds.find(routeId);
+    if (i == routeRoadIds.end()) return false;
+    roadIds.assign(i->second.begin(), i->second.end());
+    return true;
+}
+
+void TraCINetworkGeometry::addRouteRoadIds(const std::string& routeId, const std::list<std::string>& roadIds)
+{
+    routeRoadIds[routeId].assign(roadIds.begin(), roadIds.end());
+}
+
+std::list<std::string> TraCINetworkGeometry::getLaneIds() const
+{
+    return std::list<std::string>(laneIds.begin(), laneIds.end());
+}
+
+std::list<std::string> TraCINetworkGeometry::getJunctionIds() const
+{
+    return std::list<std::string>(junctionIds.begin(), junctionIds.end());
+}
+
+void TraCINetworkGeometry::clear()
+{
+    laneIndices.clear();
+    laneIds.clear();
+    laneShapes.clear();
+    shapePoints.clear();
+    junctionIndices.clear();
+    junctionIds.clear();
+    junctionPositions.clear();
+    routeRoadIds.clear();
+    complete = false;
+}
+
+void TraCINetworkGeometry::save(const std::string& fileName, const std::string& key) const
+{
+    TraCIBuffer buf;
+    buf.reserve(key.size() + laneIds.size() * 64 + shapePoints.size() * 3 * sizeof(double) + junctionIds.size() * 48);
+    buf << key;
+    buf << static_cast<uint32_t>(laneIds.size());
+    for (size_t i = 0; i < laneIds.size(); ++i) {
+        buf << laneIds[i] << static_cast<uint32_t>(laneShapes[i].end - laneShapes[i].begin);
+        for (uint32_t j = laneShapes[i].begin; j < laneShapes[i].end; ++j) writeCoord(buf, shapePoints[j]);
+    }
+    buf << static_cast<uint32_t>(junctionIds.size());
+    for (size_t i = 0; i < junctionIds.size(); ++i) {
+        buf << junctionIds[i];
+        writeCoord(buf, junctionPositions[i]);
+    }
+
+    // write to a temporary file of this process and run first, so concurrent runs neither load a partially written file nor write to the same temporary one
+    std::string tempFileName = fileName + "." + std::to_string(getpid());
+    if (cSimulation* simulation = cSimulation::getActiveSimulation()) tempFileName += std::string("-") + simulation->getEnvir()->getConfigEx()->getVariable(CFGVAR_RUNNUMBER);
+    tempFileName += ".tmp";
+    {
+        std::ofstream out(tempFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) throw cRuntimeError("Could not open \"%s\" for saving network geometry", tempFileName.c_str());
+        out.write(fileMagic, sizeof(fileMagic) - 1);
+        out.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+        if (!out) throw cRuntimeError("Could not write network geometry to \"%s\"", tempFileName.c_str());
+    }
+    if (std::rename(tempFileName.c_str(), fileName.c_str()) != 0) {
+        std::remove(tempFileName.c_str());
+        throw cRuntimeError("Could not rename \"%s\" to \"%s\"", tempFileName.c_str(), fileName.c_str());
+    }
+}
+
+bool TraCINetworkGeometry::load(const std::string& fileName, const std::string& key)
+{
+    std::ifstream in(fileName, std::ios::in | std::ios::binary);
+    if (!in.is_open()) return false;
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    std::string bytes = contents.str();
+    if (bytes.compare(0, sizeof(fileMagic) - 1, fileMagic) != 0) throw cRuntimeError("File \"%s\" is not a saved network geometry", fileName.c_str());
+
+    TraCIBuffer buf(bytes.substr(sizeof(fileMagic) - 1));
+    if (buf.read<std::string>() != key) return false;
+
+    clear();
+    uint32_t laneCount = buf.read<uint32_t>();
+    for (uint32_t i = 0; i < laneCount; ++i) {
+        std::string laneId = buf.read<std::string>();
+        uint32_t pointCount = buf.read<uint32_t>();
+        laneIndices[laneId] = laneIds.size();
+        laneIds.push_back(laneId);
+        Range range;
+        range.begin = shapePoints.size();
+        for (uint32_t j = 0; j < pointCount; ++j) shapePoints.push_back(readCoord(buf));
+        range.end = shapePoints.size();
+        laneShapes.push_back(range);
+    }
+    uint32_t junctionCount = buf.read<uint32_t>();
+    for (uint32_t i = 0; i < junctionCount; ++i) {
+        std::string junctionId = buf.read<std::string>();
+        addJunctionPosition(junctionId, readCoord(buf));
+    }
+    if (!buf.eof()) throw cRuntimeError("Saved network geometry \"%s\" has trailing garbage", fileName.c_str());
+    complete = true;
+    return true;
+}
+
+std::string TraCINetworkGeometry::hashFile(const std::string& fileName)
+{
+    std::ifstream in(fileName, std::ios::in | std::ios::binary);
+    if (!in.is_open()) throw cRuntimeError("Could not open \"%s\" for hashing", fileName.c_str());
+
+    // 64 bit FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    char chunk[65536];
+    while (in) {
+        in.read(chunk, sizeof(chunk));
+        for (std::streamsize i = 0; i < in.gcount(); ++i) {
+            hash ^= static_cast<uint8_t>(chunk[i]);
+            hash *= 1099511628211ull;
+        }
+    }
+
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+}
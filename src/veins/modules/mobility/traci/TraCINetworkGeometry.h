@@ -0,0 +1,126 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "veins/veins.h"
+
+#include "veins/base/utils/Coord.h"
+
+namespace Veins {
+
+/**
+ * Geometry of the road network of a TraCI server (lane shapes, junction positions) and the edges of its routes, in OMNeT++ coordinates.
+ *
+ * None of these change during a run, so they only need to be asked for once.
+ * Lane shapes are stored back to back in a single array, so even large networks take up little memory.
+ * Lanes and junctions (but not routes, which are not part of the network) can be saved to a file and loaded in later runs.
+ */
+class VEINS_API TraCINetworkGeometry {
+public:
+    /**
+     * looks up the shape of laneId, returns whether it is known
+     */
+    bool findLaneShape(const std::string& laneId, std::list<Coord>& shape) const;
+    void addLaneShape(const std::string& laneId, const std::list<Coord>& shape);
+
+    /**
+     * looks up the position of junctionId, returns whether it is known
+     */
+    bool findJunctionPosition(const std::string& junctionId, Coord& position) const;
+    void addJunctionPosition(const std::string& junctionId, const Coord& position);
+
+    /**
+     * looks up the edges of routeId, returns whether they are known
+     */
+    bool findRouteRoadIds(const std::string& routeId, std::list<std::string>& roadIds) const;
+    void addRouteRoadIds(const std::string& routeId, const std::list<std::string>& roadIds);
+
+    /**
+     * whether all lanes and junctions of the network are known (e.g., after a call to setComplete or load), so lists of their ids can be answered from here
+     */
+    bool isComplete() const
+    {
+        return complete;
+    }
+
+    void setComplete()
+    {
+        complete = true;
+    }
+
+    /**
+     * ids of all lanes and junctions, in the order they were added (only meaningful if isComplete)
+     */
+    std::list<std::string> getLaneIds() const;
+    std::list<std::string> getJunctionIds() const;
+
+    size_t getLaneCount() const
+    {
+        return laneIds.size();
+    }
+
+    size_t getJunctionCount() const
+    {
+        return junctionIds.size();
+    }
+
+    void clear();
+
+    /**
+     * saves all lanes and junctions to fileName, along with key
+     * @param key: identifies what the geometry is valid for (e.g., the coordinate transformation it was converted with)
+     */
+    void save(const std::string& fileName, const std::string& key) const;
+
+    /**
+     * replaces all lanes and junctions by those saved to fileName, unless it does not exist or was saved with a different key.
+     * @return whether the file was loaded (which makes the geometry complete)
+     */
+    bool load(const std::string& fileName, const std::string& key);
+
+    /**
+     * returns a hash of the contents of fileName (e.g., of a SUMO .net.xml file), as hexadecimal digits
+     */
+    static std::string hashFile(const std::string& fileName);
+
+private:
+    struct Range {
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    std::unordered_map<std::string, uint32_t> laneIndices; /**< index into laneIds and laneShapes of each lane */
+    std::vector<std::string> laneIds;
+    std::vector<Range> laneShapes; /**< points of each lane's shape in shapePoints */
+    std::vector<Coord> shapePoints; /**< all lane shapes, back to back */
+    std::unordered_map<std::string, uint32_t> junctionIndices; /**< index into junctionIds and junctionPositions of each junction */
+    std::vector<std::string> junctionIds;
+    std::vector<Coord> junctionPositions;
+    std::unordered_map<std::string, std::vector<std::string>> routeRoadIds;
+    bool complete = false;
+};
+
+} // namespace Veins
@@ -0,0 +1,54 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include "veins/modules/mobility/traci/TraCIMobility.h"
+
+namespace Veins {
+
+/**
+ * @brief
+ * TraCIMobility for persons (pedestrians, or passengers riding a vehicle) managed by the TraCIScenarioManager.
+ *
+ * Persons have no vehicle command interface (getVehicleCommandInterface() returns nullptr); use getPersonCommandInterface() instead.
+ *
+ * @see TraCIScenarioManager
+ */
+class VEINS_API TraCIPersonMobility : public TraCIMobility {
+public:
+    TraCIPersonMobility()
+        : TraCIMobility()
+        , personCommandInterface(nullptr)
+    {
+    }
+    ~TraCIPersonMobility() override
+    {
+        delete personCommandInterface;
+    }
+
+    TraCICommandInterface::Vehicle* getVehicleCommandInterface() const override;
+    virtual TraCICommandInterface::Person* getPersonCommandInterface() const;
+
+protected:
+    mutable TraCICommandInterface::Person* personCommandInterface;
+};
+
+} // namespace Veins
@@ -21,7 +21,7 @@
 #pragma once
 
 #include <list>
-#include <set>
+#include <unordered_set>
 #include <string>
 #include <utility>
 
@@ -83,7 +83,7 @@ public:
     const std::list<std::pair<TraCICoord, TraCICoord>>& getRectangles() const;
 
 private:
-    std::set<std::string> roiRoads; /**< which roads (e.g. "hwy1 hwy2") are considered to consitute the region of interest, if not empty */
+    std::unordered_set<std::string> roiRoads; /**< which roads (e.g. "hwy1 hwy2") are considered to consitute the region of interest, if not empty */
     std::list<std::pair<TraCICoord, TraCICoord>> roiRects; /**< which rectangles (e.g. "0,0-10,10 20,20-30,30) are considered to consitute the region of interest, if not empty */
 };
 
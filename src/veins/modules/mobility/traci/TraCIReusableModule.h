@@ -0,0 +1,86 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include "veins/veins.h"
+
+namespace Veins {
+
+/**
+ * @brief
+ * Interface of simple modules that allow the TraCIScenarioManager to keep their vehicle module around after its vehicle left the simulation,
+ * and to hand it to a new vehicle instead of creating a new module (see its modulePoolSize parameter).
+ *
+ * A vehicle module is only reused if all its simple submodules implement this interface.
+ * Before either method is called, the manager switches the context to the module it is called on.
+ * A reused module is given a new name, so its results are recorded under a new module path; its module id (and, e.g., a MAC address derived from it) stays the same.
+ *
+ * @see TraCIScenarioManager
+ */
+class VEINS_API TraCIReusableModule {
+public:
+    virtual ~TraCIReusableModule() = default;
+
+    /**
+     * called instead of finish() when the vehicle leaves the simulation.
+     *
+     * Must record any results, cancel all self messages, and forget everything about the vehicle.
+     */
+    virtual void prepareForReuse() = 0;
+
+    /**
+     * called instead of initialize(stage) when the module is handed to a new vehicle (after preInitialize).
+     *
+     * Like initialize, it is called stage by stage for all simple modules of the vehicle module, parents before submodules.
+     * NICs are unregistered from the connection manager when the vehicle leaves, so modules registering them need to do so again.
+     */
+    virtual void reinitialize(int stage) = 0;
+
+protected:
+    /**
+     * whether a message was sent before the module was last prepared for reuse, i.e., was meant for the vehicle that left the simulation.
+     *
+     * Other modules may still have messages on their way to the module (e.g., frames on the air), so these need to be dropped on arrival.
+     * Self messages never are: those of the previous vehicle were cancelled in prepareForReuse, so any that arrives is one of the module's own timers, scheduled for the new vehicle.
+     */
+    bool isForPreviousVehicle(const cMessage* msg) const
+    {
+        return isForPreviousVehicle(msg, pooledAt);
+    }
+
+    /**
+     * whether a message was sent before a module that was prepared for reuse in event pooledAt (see above).
+     *
+     * A module can be pooled and handed to a new vehicle in the same event (when one vehicle arrives and another departs in the same timestep).
+     * Nothing is sent to the module in that event before it is pooled, so messages sent in it are meant for the new vehicle.
+     */
+    static bool isForPreviousVehicle(const cMessage* msg, eventnumber_t pooledAt)
+    {
+        return !msg->isSelfMessage() && (msg->getPreviousEventNumber() < pooledAt);
+    }
+
+private:
+    friend class TraCIScenarioManager;
+
+    eventnumber_t pooledAt = -1; /**< number of the event in which the module was last prepared for reuse */
+};
+
+} // namespace Veins
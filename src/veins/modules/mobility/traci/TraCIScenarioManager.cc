@@ -18,26 +18,34 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
 
+#include <cmath>
 #include <fstream>
 #include <vector>
 #include <algorithm>
 #include <stdexcept>
 #include <iterator>
+#include <functional>
+#include <cctype>
 
 #include "veins/modules/mobility/traci/TraCIScenarioManager.h"
 #include "veins/base/connectionManager/ChannelAccess.h"
 #include "veins/modules/mobility/traci/TraCICommandInterface.h"
 #include "veins/modules/mobility/traci/TraCIConstants.h"
 #include "veins/modules/mobility/traci/TraCIMobility.h"
+#include "veins/modules/mobility/traci/TraCINetworkGeometry.h"
+#include "veins/modules/mobility/traci/TraCIReusableModule.h"
 #include "veins/modules/obstacle/ObstacleControl.h"
 #include "veins/modules/world/traci/trafficLight/TraCITrafficLightInterface.h"
 
 using namespace Veins::TraCIConstants;
 
 using Veins::AnnotationManagerAccess;
+using Veins::Obstacle;
 using Veins::TraCIBuffer;
 using Veins::TraCICoord;
+using Veins::TraCIReusableModule;
 using Veins::TraCIScenarioManager;
+using Veins::TraCIStatistics;
 using Veins::TraCITrafficLightInterface;
 
 Define_Module(Veins::TraCIScenarioManager);
@@ -59,7 +67,7 @@ TraCIScenarioManager::TraCIScenarioManager()
 
 TraCIScenarioManager::~TraCIScenarioManager()
 {
-    if (connection) {
+    if (connection && !connection->isReplaying()) {
         TraCIBuffer buf = connection->query(CMD_CLOSE, TraCIBuffer());
     }
     cancelAndDelete(connectAndStartTrigger);
@@ -68,6 +76,56 @@ TraCIScenarioManager::~TraCIScenarioManager()
 
 namespace {
 
+/**
+ * whether fileName ends in .json
+ */
+bool isJsonFile(const std::string& fileName)
+{
+    const std::string suffix = ".json";
+    return (fileName.size() >= suffix.size()) && (fileName.compare(fileName.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+/**
+ * mod (if it is a simple module) and all its simple submodules, parents before their submodules
+ */
+std::vector<cSimpleModule*> getSimpleModules(cModule* mod)
+{
+    std::vector<cSimpleModule*> result;
+    if (auto simpleModule = dynamic_cast<cSimpleModule*>(mod)) result.push_back(simpleModule);
+    for (auto submod : Veins::getSubmodulesOfType<cSimpleModule>(mod, true)) {
+        result.push_back(submod);
+    }
+    return result;
+}
+
+/**
+ * module type, name, and display string to use for an object (a vehicle or person) of a given type
+ */
+struct ModuleMapping {
+    std::string type;
+    std::string name;
+    std::string displayString;
+};
+
+/**
+ * looks up the mappings for objectType (falling back to "*"), leaving the display string empty if none are given
+ */
+ModuleMapping findModuleMapping(const std::string& objectKind, const std::string& objectType, const std::map<std::string, std::string>& types, const std::map<std::string, std::string>& names, const std::map<std::string, std::string>& displayStrings)
+{
+    auto find = [&](const std::map<std::string, std::string>& mapping, const char* what) -> const std::string& {
+        auto i = mapping.find(objectType);
+        if (i == mapping.end()) i = mapping.find("*");
+        if (i == mapping.end()) throw cRuntimeError("cannot find a module %s for %s type \"%s\"", what, objectKind.c_str(), objectType.c_str());
+        return i->second;
+    };
+
+    ModuleMapping result;
+    result.type = find(types, "type");
+    result.name = find(names, "name");
+    if (displayStrings.size() != 0) result.displayString = find(displayStrings, "display string");
+    return result;
+}
+
 std::vector<std::string> getMapping(std::string el)
 {
 
@@ -226,6 +284,29 @@ void TraCIScenarioManager::parseModuleTypes()
     if (intersection.size() != displayStringKeys.size()) throw cRuntimeError("keys of mappings of moduleType and moduleName are not the same");
 }
 
+void TraCIScenarioManager::parsePersonModuleTypes()
+{
+    personModuleType.clear();
+    personModuleName.clear();
+    personModuleDisplayString.clear();
+
+    std::string personModuleTypes = par("personModuleType").stdstringValue();
+    if (personModuleTypes.empty()) return;
+
+    personModuleType = parseMappings(personModuleTypes, "personModuleType", false);
+    personModuleName = parseMappings(par("personModuleName").stdstringValue(), "personModuleName", false);
+    personModuleDisplayString = parseMappings(par("personModuleDisplayString").stdstringValue(), "personModuleDisplayString", true);
+
+    // same consistency check as for vehicles: person types must match between all mappings
+    if (personModuleName.size() != personModuleType.size()) throw cRuntimeError("keys of mappings of personModuleType and personModuleName are not the same");
+    for (auto& i : personModuleType) {
+        if (personModuleName.find(i.first) == personModuleName.end()) throw cRuntimeError("keys of mappings of personModuleType and personModuleName are not the same");
+    }
+    for (auto& i : personModuleDisplayString) {
+        if (personModuleType.find(i.first) == personModuleType.end()) throw cRuntimeError("keys of mappings of personModuleType and personModuleDisplayString are not the same");
+    }
+}
+
 void TraCIScenarioManager::initialize(int stage)
 {
     cSimpleModule::initialize(stage);
@@ -244,9 +325,30 @@ void TraCIScenarioManager::initialize(int stage)
     firstStepAt = par("firstStepAt");
     updateInterval = par("updateInterval");
     if (firstStepAt == -1) firstStepAt = connectAt + updateInterval;
+    pipelinedStepping = par("pipelinedStepping");
+    traciRecordFile = par("traciRecordFile").stdstringValue();
+    traciReplayFile = par("traciReplayFile").stdstringValue();
+    if (!traciRecordFile.empty() && !traciReplayFile.empty()) throw cRuntimeError("Cannot both record and replay a TraCI session");
     parseModuleTypes();
+    parsePersonModuleTypes();
     penetrationRate = par("penetrationRate").doubleValue();
     ignoreGuiCommands = par("ignoreGuiCommands");
+    cacheGetters = par("cacheGetters");
+    cacheNetworkGeometry = par("cacheNetworkGeometry");
+    preloadNetworkGeometry = par("preloadNetworkGeometry");
+    networkGeometryCacheDir = par("networkGeometryCacheDir").stdstringValue();
+    netFile = par("netFile").stdstringValue();
+    if (preloadNetworkGeometry && !cacheNetworkGeometry) throw cRuntimeError("preloadNetworkGeometry needs cacheNetworkGeometry to be set");
+    if (!networkGeometryCacheDir.empty() && !preloadNetworkGeometry) throw cRuntimeError("networkGeometryCacheDir needs preloadNetworkGeometry to be set");
+    if (!networkGeometryCacheDir.empty() && netFile.empty()) throw cRuntimeError("networkGeometryCacheDir needs netFile to be set");
+    traciStatistics = par("traciStatistics");
+    traciStatisticsFile = par("traciStatisticsFile").stdstringValue();
+    traciStatisticsInterval = par("traciStatisticsInterval");
+    if (!traciStatisticsFile.empty() && !traciStatistics) throw cRuntimeError("traciStatisticsFile needs traciStatistics to be set");
+    if (traciStatisticsInterval <= 0) throw cRuntimeError("traciStatisticsInterval must be positive");
+    modulePoolSize = par("modulePoolSize");
+    if (modulePoolSize < 0) throw cRuntimeError("modulePoolSize must not be negative");
+    lazyModuleDistance = par("lazyModuleDistance").doubleValue();
     host = par("host").stdstringValue();
     port = par("port");
     autoShutdown = par("autoShutdown");
@@ -257,10 +359,46 @@ void TraCIScenarioManager::initialize(int stage)
     roi.addRoads(par("roiRoads"));
     roi.addRectangles(par("roiRects"));
 
+    std::string vehicleSubscriptionModeString = par("vehicleSubscriptionMode").stdstringValue();
+    if (vehicleSubscriptionModeString == "object") {
+        vehicleSubscriptionMode = VehicleSubscriptionMode::object;
+    }
+    else if (vehicleSubscriptionModeString == "departure") {
+        vehicleSubscriptionMode = VehicleSubscriptionMode::departure;
+    }
+    else if (vehicleSubscriptionModeString == "context") {
+        vehicleSubscriptionMode = VehicleSubscriptionMode::context;
+    }
+    else {
+        throw cRuntimeError("Invalid vehicleSubscriptionMode \"%s\" (must be \"object\", \"departure\", or \"context\")", vehicleSubscriptionModeString.c_str());
+    }
+    slowUpdateInterval = par("slowUpdateInterval");
+    if (slowUpdateInterval < 0) throw cRuntimeError("slowUpdateInterval must not be negative");
+    if ((slowUpdateInterval > 0) && (vehicleSubscriptionMode == VehicleSubscriptionMode::context)) throw cRuntimeError("slowUpdateInterval is not supported in \"context\" vehicleSubscriptionMode");
+    vehicleListCheckPeriod = par("vehicleListCheckPeriod");
+    if (vehicleListCheckPeriod < 0) throw cRuntimeError("vehicleListCheckPeriod must not be negative");
+    stepsSinceVehicleListCheck = 0;
+    contextJunction = par("contextJunction").stdstringValue();
+    contextRange = par("contextRange").doubleValue();
+    contextResultReceived = false;
+
     areaSum = 0;
     nextNodeVectorIndex = 0;
+    modulePool.clear();
+    pooledModuleCount = 0;
+    unpoolableModuleTypes.clear();
+    modulesCreated = 0;
+    modulesReused = 0;
+    modulesPooled = 0;
     hosts.clear();
-    subscribedVehicles.clear();
+    vehicleIds.clear();
+    vehicles.clear();
+    unEquippedHostCount = 0;
+    vehicleListEpoch = 0;
+    managedPersons.clear();
+    personIds.clear();
+    persons.clear();
+    pendingPersonSubscriptionIds.clear();
     trafficLights.clear();
     activeVehicleCount = 0;
     parkingVehicleCount = 0;
@@ -271,6 +409,12 @@ void TraCIScenarioManager::initialize(int stage)
 
     vehicleObstacleControl = FindModule<VehicleObstacleControl*>::findGlobalModule();
 
+    lazyModuleConnectionManager = nullptr;
+    if (lazyModuleDistance >= 0) {
+        lazyModuleConnectionManager = FindModule<BaseConnectionManager*>::findGlobalModule();
+        if (!lazyModuleConnectionManager) throw cRuntimeError("lazyModuleDistance needs a connection manager");
+    }
+
     ASSERT(firstStepAt > connectAt);
     connectAndStartTrigger = new cMessage("connect");
     scheduleAt(connectAt, connectAndStartTrigger);
@@ -289,20 +433,21 @@ void TraCIScenarioManager::init_traci()
         commandInterface->setApiVersion(apiVersion.first);
     }
 
-    {
-        // query and set road network boundaries
-        auto networkBoundaries = commandInterface->initNetworkBoundaries(par("margin"));
-        if (world != nullptr && ((connection->traci2omnet(networkBoundaries.second).x > world->getPgs()->x) || (connection->traci2omnet(networkBoundaries.first).y > world->getPgs()->y))) {
-            EV_DEBUG << "WARNING: Playground size (" << world->getPgs()->x << ", " << world->getPgs()->y << ") might be too small for vehicle at network bounds (" << connection->traci2omnet(networkBoundaries.second).x << ", " << connection->traci2omnet(networkBoundaries.first).y << ")" << endl;
-        }
+    // query and set road network boundaries
+    auto networkBoundaries = commandInterface->initNetworkBoundaries(par("margin"));
+    if (world != nullptr && ((connection->traci2omnet(networkBoundaries.second).x > world->getPgs()->x) || (connection->traci2omnet(networkBoundaries.first).y > world->getPgs()->y))) {
+        EV_DEBUG << "WARNING: Playground size (" << world->getPgs()->x << ", " << world->getPgs()->y << ") might be too small for vehicle at network bounds (" << connection->traci2omnet(networkBoundaries.second).x << ", " << connection->traci2omnet(networkBoundaries.first).y << ")" << endl;
     }
 
+    if (preloadNetworkGeometry) preloadNetworkGeometryCache();
+
     {
-        // subscribe to list of departed and arrived vehicles, as well as simulation time
+        // subscribe to list of departed and arrived vehicles (and persons, if tracked), as well as simulation time
+        bool subscribeToPersons = !personModuleType.empty();
         simtime_t beginTime = 0;
         simtime_t endTime = SimTime::getMaxTime();
         std::string objectId = "";
-        uint8_t variableNumber = 7;
+        uint8_t variableNumber = subscribeToPersons ? 9 : 7;
         uint8_t variable1 = VAR_DEPARTED_VEHICLES_IDS;
         uint8_t variable2 = VAR_ARRIVED_VEHICLES_IDS;
         uint8_t variable3 = commandInterface->getTimeStepCmd();
@@ -310,12 +455,33 @@ void TraCIScenarioManager::init_traci()
         uint8_t variable5 = VAR_TELEPORT_ENDING_VEHICLES_IDS;
         uint8_t variable6 = VAR_PARKING_STARTING_VEHICLES_IDS;
         uint8_t variable7 = VAR_PARKING_ENDING_VEHICLES_IDS;
-        TraCIBuffer buf = connection->query(CMD_SUBSCRIBE_SIM_VARIABLE, TraCIBuffer() << beginTime << endTime << objectId << variableNumber << variable1 << variable2 << variable3 << variable4 << variable5 << variable6 << variable7);
+        uint8_t variable8 = VAR_DEPARTED_PERSONS_IDS;
+        uint8_t variable9 = VAR_ARRIVED_PERSONS_IDS;
+        TraCIBuffer request;
+        request << beginTime << endTime << objectId << variableNumber << variable1 << variable2 << variable3 << variable4 << variable5 << variable6 << variable7;
+        if (subscribeToPersons) request << variable8 << variable9;
+        TraCIBuffer buf = connection->query(CMD_SUBSCRIBE_SIM_VARIABLE, request);
         processSubcriptionResult(buf);
         ASSERT(buf.eof());
     }
 
-    {
+    if (!personModuleType.empty()) {
+        // catch up on persons that departed before we connected
+        std::list<std::string> ids = commandInterface->getPersonIds();
+        for (auto& personId : ids) {
+            queuePersonSubscription(TraCIBuffer::StringRef{personId.data(), personId.size()});
+        }
+        sendPendingSubscriptions();
+    }
+
+    if (vehicleSubscriptionMode == VehicleSubscriptionMode::context) {
+        subscribeToVehicleContext(networkBoundaries);
+    }
+    else if (vehicleSubscriptionMode == VehicleSubscriptionMode::departure) {
+        // catch up on vehicles that departed before we connected
+        checkVehicleList();
+    }
+    else {
         // subscribe to list of vehicle ids
         simtime_t beginTime = 0;
         simtime_t endTime = SimTime::getMaxTime();
@@ -377,6 +543,8 @@ void TraCIScenarioManager::init_traci()
         {
             // get list of polygons
             std::list<std::string> ids = commandInterface->getPolygonIds();
+            std::vector<Obstacle> toAdd;
+            toAdd.reserve(ids.size());
             for (std::list<std::string>::iterator i = ids.begin(); i != ids.end(); ++i) {
                 std::string id = *i;
                 std::string typeId = commandInterface->polygon(id).getTypeId();
@@ -384,8 +552,12 @@ void TraCIScenarioManager::init_traci()
                 std::list<Coord> coords = commandInterface->polygon(id).getShape();
                 std::vector<Coord> shape;
                 std::copy(coords.begin(), coords.end(), std::back_inserter(shape));
-                obstacles->addFromTypeAndShape(id, typeId, shape);
+                Obstacle obs(id, typeId, obstacles->getAttenuationPerCut(typeId), obstacles->getAttenuationPerMeter(typeId));
+                obs.setShape(shape);
+                toAdd.push_back(std::move(obs));
             }
+            // add all of them at once, so the obstacle index is only built once
+            obstacles->addAll(std::move(toAdd));
         }
     }
 
@@ -426,8 +598,39 @@ void TraCIScenarioManager::finish()
     while (hosts.begin() != hosts.end()) {
         deleteManagedModule(hosts.begin()->first);
     }
+    while (managedPersons.begin() != managedPersons.end()) {
+        TraCIIdTable::Handle handle = personIds.find(managedPersons.begin()->first);
+        deletePersonModule(handle);
+        forgetPersonIfUnused(handle);
+    }
+    // pooled modules have already recorded their results in prepareForReuse
+    for (auto& pool : modulePool) {
+        for (auto mod : pool.second) {
+            mod->deleteModule();
+        }
+    }
+    modulePool.clear();
+    pooledModuleCount = 0;
 
     recordScalar("roiArea", areaSum);
+    if (modulePoolSize > 0) {
+        recordScalar("modulesCreated", modulesCreated);
+        recordScalar("modulesReused", modulesReused);
+        recordScalar("modulesPooled", modulesPooled);
+    }
+    if (pipelinedStepping && connection) recordScalar("stalledSteps", connection->getStalledStepCount());
+    if (connection && connection->getStatistics()) {
+        if (traciStatisticsStream) writeTraciStatistics();
+        recordTraciStatistics();
+    }
+    if (cacheGetters && commandIfc) {
+        const TraCICommandInterface::CacheStatistics& stats = commandIfc->getCacheStatistics();
+        uint64_t hits = stats.staticHits + stats.dynamicHits;
+        recordScalar("getterCacheStaticHits", stats.staticHits);
+        recordScalar("getterCacheDynamicHits", stats.dynamicHits);
+        recordScalar("getterCacheMisses", stats.misses);
+        if (hits + stats.misses > 0) recordScalar("getterCacheHitRate", static_cast<double>(hits) / (hits + stats.misses));
+    }
 }
 
 void TraCIScenarioManager::handleMessage(cMessage* msg)
@@ -442,8 +645,25 @@ void TraCIScenarioManager::handleMessage(cMessage* msg)
 void TraCIScenarioManager::handleSelfMsg(cMessage* msg)
 {
     if (msg == connectAndStartTrigger) {
-        connection.reset(TraCIConnection::connect(this, host.c_str(), port));
+        if (!traciReplayFile.empty()) {
+            connection.reset(TraCIConnection::replay(this, traciReplayFile.c_str()));
+        }
+        else {
+            connection.reset(TraCIConnection::connect(this, host.c_str(), port));
+            if (!traciRecordFile.empty()) connection->startRecording(traciRecordFile.c_str());
+        }
+        if (traciStatistics) {
+            connection->enableStatistics();
+            if (!traciStatisticsFile.empty()) {
+                traciStatisticsStream.reset(new std::ofstream(traciStatisticsFile, std::ios::out | std::ios::trunc));
+                if (!traciStatisticsStream->is_open()) error("Could not open \"%s\" for writing TraCI statistics", traciStatisticsFile.c_str());
+                if (!isJsonFile(traciStatisticsFile)) TraCIStatistics::writeCsvHeader(*traciStatisticsStream);
+                nextTraciStatisticsAt = simTime() + traciStatisticsInterval;
+            }
+        }
         commandIfc.reset(new TraCICommandInterface(this, *connection, ignoreGuiCommands));
+        commandIfc->setCacheGetters(cacheGetters);
+        commandIfc->setCacheNetworkGeometry(cacheNetworkGeometry);
         init_traci();
         return;
     }
@@ -475,38 +695,70 @@ void TraCIScenarioManager::updateModulePosition(cModule* mod, const Coord& p, co
 // name: host;Car;i=vehicle.gif
 void TraCIScenarioManager::addModule(std::string nodeId, std::string type, std::string name, std::string displayString, const Coord& position, std::string road_id, double speed, Heading heading, VehicleSignalSet signals, double length, double height, double width)
 {
+    TraCIStatistics::ScopedTimer timer(getPhaseStatistics(TraCIStatistics::Phase::addModule));
 
-    if (hosts.find(nodeId) != hosts.end()) error("tried adding duplicate module");
+    TraCIIdTable::Handle handle = vehicleIds.intern(nodeId);
+    if (getVehicleRecord(handle).module) error("tried adding duplicate module");
 
-    double option1 = hosts.size() / (hosts.size() + unEquippedHosts.size() + 1.0);
-    double option2 = (hosts.size() + 1) / (hosts.size() + unEquippedHosts.size() + 1.0);
+    double option1 = hosts.size() / (hosts.size() + unEquippedHostCount + 1.0);
+    double option2 = (hosts.size() + 1) / (hosts.size() + unEquippedHostCount + 1.0);
 
     if (fabs(option1 - penetrationRate) < fabs(option2 - penetrationRate)) {
-        unEquippedHosts.insert(nodeId);
+        getVehicleRecord(handle).unequipped = true;
+        unEquippedHostCount++;
         return;
     }
 
-    int32_t nodeVectorIndex = nextNodeVectorIndex++;
-
     cModule* parentmod = getParentModule();
     if (!parentmod) error("Parent Module not found");
 
     cModuleType* nodeType = cModuleType::get(type.c_str());
     if (!nodeType) error("Module Type \"%s\" not found", type.c_str());
 
-    // TODO: this trashes the vectsize member of the cModule, although nobody seems to use it
-    cModule* mod = nodeType->create(name.c_str(), parentmod, nodeVectorIndex, nodeVectorIndex);
-    mod->finalizeParameters();
-    if (displayString.length() > 0) {
-        mod->getDisplayString().parse(displayString.c_str());
+    cModule* mod = takePooledModule(nodeType, name);
+    if (mod) {
+        // a new name gives the module a new path, so results of the new vehicle are not recorded under that of the old one (OMNeT++ 5 cannot move a module within its vector)
+        mod->setName((name + "_" + std::to_string(modulesReused + 1)).c_str());
+        if (displayString.length() > 0) {
+            mod->getDisplayString().parse(displayString.c_str());
+        }
+
+        preInitializeModule(mod, nodeId, position, road_id, speed, heading, signals);
+
+        std::vector<cSimpleModule*> simpleModules = getSimpleModules(mod);
+        int numStages = 0;
+        for (auto simpleModule : simpleModules) {
+            numStages = std::max(numStages, simpleModule->numInitStages());
+        }
+        for (int stage = 0; stage < numStages; stage++) {
+            for (auto simpleModule : simpleModules) {
+                if (stage >= simpleModule->numInitStages()) continue;
+                cContextSwitcher context(simpleModule);
+                check_and_cast<TraCIReusableModule*>(simpleModule)->reinitialize(stage);
+            }
+        }
+        modulesReused++;
     }
-    mod->buildInside();
-    mod->scheduleStart(simTime() + updateInterval);
+    else {
+        int32_t nodeVectorIndex = nextNodeVectorIndex++;
 
-    preInitializeModule(mod, nodeId, position, road_id, speed, heading, signals);
+        // TODO: this trashes the vectsize member of the cModule, although nobody seems to use it
+        mod = nodeType->create(name.c_str(), parentmod, nodeVectorIndex, nodeVectorIndex);
+        mod->finalizeParameters();
+        if (displayString.length() > 0) {
+            mod->getDisplayString().parse(displayString.c_str());
+        }
+        mod->buildInside();
+        mod->scheduleStart(simTime() + updateInterval);
 
-    mod->callInitialize();
+        preInitializeModule(mod, nodeId, position, road_id, speed, heading, signals);
+
+        mod->callInitialize();
+        modulesCreated++;
+    }
     hosts[nodeId] = mod;
+    getVehicleRecord(handle).module = mod;
+    getVehicleRecord(handle).moduleName = name;
 
     // post-initialize TraCIMobility
     auto mobilityModules = getSubmodulesOfType<TraCIMobility>(mod);
@@ -528,20 +780,106 @@ void TraCIScenarioManager::addModule(std::string nodeId, std::string type, std::
 
 cModule* TraCIScenarioManager::getManagedModule(std::string nodeId)
 {
-    if (hosts.find(nodeId) == hosts.end()) return nullptr;
-    return hosts[nodeId];
+    TraCIIdTable::Handle handle = vehicleIds.find(nodeId);
+    if (handle == TraCIIdTable::invalidHandle) return nullptr;
+    return getVehicleRecord(handle).module;
 }
 
 bool TraCIScenarioManager::isModuleUnequipped(std::string nodeId)
 {
-    if (unEquippedHosts.find(nodeId) == unEquippedHosts.end()) return false;
+    TraCIIdTable::Handle handle = vehicleIds.find(nodeId);
+    if (handle == TraCIIdTable::invalidHandle) return false;
+    return getVehicleRecord(handle).unequipped;
+}
+
+TraCIScenarioManager::VehicleRecord& TraCIScenarioManager::getVehicleRecord(TraCIIdTable::Handle handle)
+{
+    ASSERT(handle != TraCIIdTable::invalidHandle);
+    if (handle >= vehicles.size()) vehicles.resize(vehicleIds.getHandleBound());
+    return vehicles[handle];
+}
+
+void TraCIScenarioManager::forgetVehicleIfUnused(TraCIIdTable::Handle handle)
+{
+    VehicleRecord& record = getVehicleRecord(handle);
+    if (record.subscribed || record.subscriptionPending || record.module || record.unequipped || record.dormant) return;
+    record = VehicleRecord();
+    if (commandIfc) commandIfc->forgetVehicle(vehicleIds.getId(handle));
+    vehicleIds.release(handle);
+}
+
+void TraCIScenarioManager::forgetUnequippedHost(TraCIIdTable::Handle handle)
+{
+    VehicleRecord& record = getVehicleRecord(handle);
+    if (!record.unequipped) return;
+    record.unequipped = false;
+    unEquippedHostCount--;
+}
+
+bool TraCIScenarioManager::requestModule(const std::string& nodeId)
+{
+    TraCIIdTable::Handle handle = vehicleIds.find(nodeId);
+    if (handle == TraCIIdTable::invalidHandle) return false;
+    getVehicleRecord(handle).moduleRequested = true;
     return true;
 }
 
+bool TraCIScenarioManager::isModuleDeferred(TraCIIdTable::Handle handle, const Coord& position)
+{
+    if (lazyModuleDistance < 0) return false;
+    if (getVehicleRecord(handle).moduleRequested) return false;
+    return !lazyModuleConnectionManager->hasNicsWithin(position, lazyModuleDistance);
+}
+
+void TraCIScenarioManager::updateDormantVehicle(TraCIIdTable::Handle handle, const Coord& position, Heading heading)
+{
+    VehicleRecord& record = getVehicleRecord(handle);
+    if (record.obstacle) {
+        vehicleObstacleControl->setPose(record.obstacle, position, heading);
+    }
+    else if (!record.dormant && vehicleObstacleControl) {
+        // without a mobility module, the obstacle is placed by its front bumper
+        VehicleObstacle obstacle(std::vector<ChannelAccess*>(), nullptr, record.attributes.length, 0, record.attributes.width, record.attributes.height);
+        obstacle.setPose(position, heading);
+        record.obstacle = vehicleObstacleControl->add(obstacle);
+    }
+    record.dormant = true;
+}
+
+void TraCIScenarioManager::forgetDormantVehicle(TraCIIdTable::Handle handle)
+{
+    VehicleRecord& record = getVehicleRecord(handle);
+    if (!record.dormant) return;
+    record.dormant = false;
+    if (record.obstacle) {
+        vehicleObstacleControl->erase(record.obstacle);
+        record.obstacle = nullptr;
+    }
+}
+
+void TraCIScenarioManager::forgetVehicle(TraCIIdTable::Handle handle)
+{
+    // check if this object has been deleted already (e.g. because it was outside the ROI)
+    if (getVehicleRecord(handle).module) deleteManagedModule(handle);
+
+    forgetUnequippedHost(handle);
+    forgetDormantVehicle(handle);
+    forgetVehicleIfUnused(handle);
+}
+
 void TraCIScenarioManager::deleteManagedModule(std::string nodeId)
 {
-    cModule* mod = getManagedModule(nodeId);
-    if (!mod) error("no vehicle with Id \"%s\" found", nodeId.c_str());
+    TraCIIdTable::Handle handle = vehicleIds.find(nodeId);
+    if (handle == TraCIIdTable::invalidHandle) error("no vehicle with Id \"%s\" found", nodeId.c_str());
+    deleteManagedModule(handle);
+    forgetVehicleIfUnused(handle);
+}
+
+void TraCIScenarioManager::deleteManagedModule(TraCIIdTable::Handle handle)
+{
+    TraCIStatistics::ScopedTimer timer(getPhaseStatistics(TraCIStatistics::Phase::deleteModule));
+    cModule* mod = getVehicleRecord(handle).module;
+    if (!mod) error("no vehicle with Id \"%s\" found", vehicleIds.getId(handle).c_str());
 
     emit(traciModuleRemovedSignal, mod);
 
@@ -562,68 +900,522 @@ void TraCIScenarioManager::deleteManagedModule(std::string nodeId)
         }
     }
 
-    hosts.erase(nodeId);
+    hosts.erase(vehicleIds.getId(handle));
+    getVehicleRecord(handle).module = nullptr;
+    if (!poolModule(mod, getVehicleRecord(handle).moduleName)) {
+        mod->callFinish();
+        mod->deleteModule();
+    }
+}
+
+bool TraCIScenarioManager::poolModule(cModule* mod, const std::string& name)
+{
+    if (pooledModuleCount >= static_cast<size_t>(modulePoolSize)) return false;
+
+    cModuleType* type = mod->getModuleType();
+    if (unpoolableModuleTypes.count(type)) return false;
+    std::vector<cSimpleModule*> simpleModules = getSimpleModules(mod);
+    for (auto simpleModule : simpleModules) {
+        if (dynamic_cast<TraCIReusableModule*>(simpleModule)) continue;
+        EV_INFO << "Not reusing modules of type " << type->getFullName() << ": " << simpleModule->getFullPath() << " is not a TraCIReusableModule" << endl;
+        unpoolableModuleTypes.insert(type);
+        return false;
+    }
+
+    // messages still on their way to the module are dropped by the module itself (see TraCIReusableModule::isForPreviousVehicle)
+    for (auto simpleModule : simpleModules) {
+        cContextSwitcher context(simpleModule);
+        TraCIReusableModule* reusableModule = check_and_cast<TraCIReusableModule*>(simpleModule);
+        reusableModule->pooledAt = getSimulation()->getEventNumber();
+        reusableModule->prepareForReuse();
+    }
+
+    modulePool[std::make_pair(type, name)].push_back(mod);
+    pooledModuleCount++;
+    modulesPooled++;
+    return true;
+}
+
+cModule* TraCIScenarioManager::takePooledModule(cModuleType* type, const std::string& name)
+{
+    auto pool = modulePool.find(std::make_pair(type, name));
+    if ((pool == modulePool.end()) || pool->second.empty()) return nullptr;
+    cModule* mod = pool->second.back();
+    pool->second.pop_back();
+    pooledModuleCount--;
+    return mod;
+}
+
+void TraCIScenarioManager::addPersonModule(TraCIIdTable::Handle handle, std::string type, std::string name, std::string displayString, const Coord& position, std::string road_id, double speed, Heading heading)
+{
+    if (getPersonRecord(handle).module) error("tried adding duplicate person module");
+    const std::string& personId = personIds.getId(handle);
+
+    // share the vector index with vehicles, so persons and vehicles may use the same module name
+    int32_t nodeVectorIndex = nextNodeVectorIndex++;
+
+    cModule* parentmod = getParentModule();
+    if (!parentmod) error("Parent Module not found");
+
+    cModuleType* nodeType = cModuleType::get(type.c_str());
+    if (!nodeType) error("Module Type \"%s\" not found", type.c_str());
+
+    cModule* mod = nodeType->create(name.c_str(), parentmod, nodeVectorIndex, nodeVectorIndex);
+    mod->finalizeParameters();
+    if (displayString.length() > 0) {
+        mod->getDisplayString().parse(displayString.c_str());
+    }
+    mod->buildInside();
+    mod->scheduleStart(simTime() + updateInterval);
+
+    preInitializeModule(mod, personId, position, road_id, speed, heading, {VehicleSignal::undefined});
+
+    mod->callInitialize();
+    managedPersons[personId] = mod;
+    getPersonRecord(handle).module = mod;
+
+    // post-initialize TraCIMobility
+    auto mobilityModules = getSubmodulesOfType<TraCIMobility>(mod);
+    for (auto mm : mobilityModules) {
+        mm->changePosition();
+    }
+
+    emit(traciModuleAddedSignal, mod);
+}
+
+void TraCIScenarioManager::deletePersonModule(TraCIIdTable::Handle handle)
+{
+    cModule* mod = getPersonRecord(handle).module;
+    if (!mod) error("no person with Id \"%s\" found", personIds.getId(handle).c_str());
+
+    emit(traciModuleRemovedSignal, mod);
+
+    auto cas = getSubmodulesOfType<ChannelAccess>(mod, true);
+    for (auto ca : cas) {
+        cModule* nic = ca->getParentModule();
+        auto connectionManager = ChannelAccess::getConnectionManager(nic);
+        connectionManager->unregisterNic(nic);
+    }
+
+    managedPersons.erase(personIds.getId(handle));
+    getPersonRecord(handle).module = nullptr;
     mod->callFinish();
     mod->deleteModule();
 }
 
+TraCIScenarioManager::PersonRecord& TraCIScenarioManager::getPersonRecord(TraCIIdTable::Handle handle)
+{
+    ASSERT(handle != TraCIIdTable::invalidHandle);
+    if (handle >= persons.size()) persons.resize(personIds.getHandleBound());
+    return persons[handle];
+}
+
+void TraCIScenarioManager::forgetPersonIfUnused(TraCIIdTable::Handle handle)
+{
+    PersonRecord& record = getPersonRecord(handle);
+    if (record.subscribed || record.subscriptionPending || record.module) return;
+    record = PersonRecord();
+    personIds.release(handle);
+}
+
 void TraCIScenarioManager::executeOneTimestep()
 {
 
     EV_DEBUG << "Triggering TraCI server simulation advance to t=" << simTime() << endl;
 
     simtime_t targetTime = simTime();
+    TraCIStatistics::ScopedTimer timestepTimer(getPhaseStatistics(TraCIStatistics::Phase::timestep));
 
     emit(traciTimestepBeginSignal, targetTime);
 
     if (isConnected()) {
-        TraCIBuffer buf = connection->query(CMD_SIMSTEP2, TraCIBuffer() << targetTime);
+        TraCIBuffer& buf = simstepResponse;
+        if (connection->isStepPending()) {
+            // requested at the end of the previous timestep
+            connection->receiveStep(buf);
+        }
+        else {
+            connection->query(CMD_SIMSTEP2, TraCIBuffer() << targetTime, buf);
+        }
 
+        contextResultReceived = false;
         uint32_t count;
         buf >> count;
         EV_DEBUG << "Getting " << count << " subscription results" << endl;
-        for (uint32_t i = 0; i < count; ++i) {
-            processSubcriptionResult(buf);
+        {
+            TraCIStatistics::ScopedTimer parseTimer(getPhaseStatistics(TraCIStatistics::Phase::parse));
+            for (uint32_t i = 0; i < count; ++i) {
+                processSubcriptionResult(buf);
+            }
+        }
+
+        // make sure vehicles are removed even if the server sent no context subscription result at all
+        if ((vehicleSubscriptionMode == VehicleSubscriptionMode::context) && !contextResultReceived) {
+            ++vehicleListEpoch;
+            removeVehiclesOutsideContext();
         }
+
+        if ((vehicleSubscriptionMode == VehicleSubscriptionMode::departure) && (vehicleListCheckPeriod > 0) && (++stepsSinceVehicleListCheck >= vehicleListCheckPeriod)) {
+            checkVehicleList();
+        }
+
+        // changes of subscription rate
+        sendPendingSubscriptions();
     }
 
     emit(traciTimestepEndSignal, targetTime);
 
-    if (!autoShutdownTriggered) scheduleAt(simTime() + updateInterval, executeOneTimestepTrigger);
+    if (!autoShutdownTriggered) {
+        scheduleAt(simTime() + updateInterval, executeOneTimestepTrigger);
+
+        // let the server compute the next timestep while we process the events up to it
+        if (pipelinedStepping && isConnected()) connection->sendStep(TraCIBuffer() << simTime() + updateInterval);
+    }
+
+    if (traciStatisticsStream && (simTime() >= nextTraciStatisticsAt)) {
+        writeTraciStatistics();
+        nextTraciStatisticsAt += traciStatisticsInterval;
+    }
+}
+
+TraCIStatistics::Histogram* TraCIScenarioManager::getPhaseStatistics(TraCIStatistics::Phase phase)
+{
+    TraCIStatistics* statistics = connection ? connection->getStatistics() : nullptr;
+    return statistics ? &statistics->getPhase(phase) : nullptr;
+}
+
+void TraCIScenarioManager::writeTraciStatistics()
+{
+    const TraCIStatistics& statistics = *connection->getStatistics();
+    if (isJsonFile(traciStatisticsFile)) {
+        statistics.writeJson(*traciStatisticsStream, simTime().dbl());
+    }
+    else {
+        statistics.writeCsvRow(*traciStatisticsStream, simTime().dbl());
+    }
+    traciStatisticsStream->flush();
+}
+
+void TraCIScenarioManager::recordTraciStatistics()
+{
+    const TraCIStatistics& statistics = *connection->getStatistics();
+
+    auto recordHistogram = [this](const std::string& name, const TraCIStatistics::Histogram& histogram) {
+        recordScalar((name + "Count").c_str(), histogram.getCount());
+        recordScalar((name + "Total").c_str(), histogram.getSum());
+        recordScalar((name + "Mean").c_str(), histogram.getMean());
+        recordScalar((name + "P99").c_str(), histogram.getQuantile(0.99));
+        recordScalar((name + "Max").c_str(), histogram.getMax());
+    };
+
+    recordScalar("traciWallTime", statistics.getElapsed());
+    recordScalar("traciMessagesSent", statistics.getMessagesSent());
+    recordScalar("traciMessagesReceived", statistics.getMessagesReceived());
+    recordScalar("traciBytesSent", statistics.getBytesSent());
+    recordScalar("traciBytesReceived", statistics.getBytesReceived());
+    recordHistogram("traciWait", statistics.getWait());
+    for (size_t i = 0; i < TraCIStatistics::phaseCount; ++i) {
+        auto phase = static_cast<TraCIStatistics::Phase>(i);
+        std::string name = TraCIStatistics::getPhaseName(phase);
+        name[0] = std::toupper(name[0]);
+        recordHistogram("traci" + name, statistics.getPhase(phase));
+    }
+
+    auto recordCommand = [&](const std::string& name, const TraCIStatistics::CommandStatistics& command) {
+        recordScalar((name + "Count").c_str(), command.count);
+        recordScalar((name + "BytesSent").c_str(), command.bytesSent);
+        recordScalar((name + "BytesReceived").c_str(), command.bytesReceived);
+        recordHistogram(name + "RoundTrip", command.roundTrip);
+    };
+    recordCommand("traciBatch", statistics.getBatches());
+    for (unsigned commandId = 0; commandId < 256; ++commandId) {
+        const TraCIStatistics::CommandStatistics& command = statistics.getCommand(commandId);
+        if (command.count == 0) continue;
+        char name[32];
+        snprintf(name, sizeof(name), "traciCommand0x%02x", commandId);
+        recordCommand(name, command);
+    }
 }
 
 void TraCIScenarioManager::subscribeToVehicleVariables(std::string vehicleId)
 {
-    // subscribe to some attributes of the vehicle
-    simtime_t beginTime = 0;
+    TraCIConnection::Batch batch;
+    subscribeToVehicleVariables(batch, vehicleId);
+    connection->query(batch, std::bind(&TraCIScenarioManager::processBatchResponse, this, std::placeholders::_1, std::placeholders::_2));
+}
+
+void TraCIScenarioManager::unsubscribeFromVehicleVariables(std::string vehicleId)
+{
+    TraCIConnection::Batch batch;
+    unsubscribeFromVehicleVariables(batch, vehicleId);
+    connection->query(batch, std::bind(&TraCIScenarioManager::processBatchResponse, this, std::placeholders::_1, std::placeholders::_2));
+}
+
+void TraCIScenarioManager::subscribeToVehicleVariables(TraCIConnection::Batch& batch, std::string vehicleId)
+{
+    // get attributes of the vehicle that do not change (once, and before the subscription result needs them)
+    for (uint8_t variable : {VAR_TYPE, VAR_LENGTH, VAR_HEIGHT, VAR_WIDTH}) {
+        batch.add(CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << variable << vehicleId);
+    }
+
+    subscribeToVehicleState(batch, vehicleId, 0);
+}
+
+void TraCIScenarioManager::subscribeToVehicleState(TraCIConnection::Batch& batch, const std::string& vehicleId, simtime_t beginTime)
+{
+    // subscribe to attributes of the vehicle that change while it is driving
     simtime_t endTime = SimTime::getMaxTime();
     std::string objectId = vehicleId;
-    uint8_t variableNumber = 8;
+    uint8_t variableNumber = 5;
     uint8_t variable1 = VAR_POSITION;
     uint8_t variable2 = VAR_ROAD_ID;
     uint8_t variable3 = VAR_SPEED;
     uint8_t variable4 = VAR_ANGLE;
     uint8_t variable5 = VAR_SIGNALS;
-    uint8_t variable6 = VAR_LENGTH;
-    uint8_t variable7 = VAR_HEIGHT;
-    uint8_t variable8 = VAR_WIDTH;
 
-    TraCIBuffer buf = connection->query(CMD_SUBSCRIBE_VEHICLE_VARIABLE, TraCIBuffer() << beginTime << endTime << objectId << variableNumber << variable1 << variable2 << variable3 << variable4 << variable5 << variable6 << variable7 << variable8);
-    processSubcriptionResult(buf);
-    ASSERT(buf.eof());
+    batch.add(CMD_SUBSCRIBE_VEHICLE_VARIABLE, TraCIBuffer() << beginTime << endTime << objectId << variableNumber << variable1 << variable2 << variable3 << variable4 << variable5);
 }
 
-void TraCIScenarioManager::unsubscribeFromVehicleVariables(std::string vehicleId)
+void TraCIScenarioManager::unsubscribeFromVehicleVariables(TraCIConnection::Batch& batch, std::string vehicleId)
 {
-    // subscribe to some attributes of the vehicle
+    // unsubscribe from all attributes of the vehicle
     simtime_t beginTime = 0;
     simtime_t endTime = SimTime::getMaxTime();
     std::string objectId = vehicleId;
     uint8_t variableNumber = 0;
 
-    TraCIBuffer buf = connection->query(CMD_SUBSCRIBE_VEHICLE_VARIABLE, TraCIBuffer() << beginTime << endTime << objectId << variableNumber);
+    batch.add(CMD_SUBSCRIBE_VEHICLE_VARIABLE, TraCIBuffer() << beginTime << endTime << objectId << variableNumber);
+}
+
+void TraCIScenarioManager::processBatchResponse(size_t index, TraCIBuffer& buf)
+{
+    // unsubscribing yields nothing
+    if (buf.eof()) return;
+
+    // getting a variable yields its value, subscribing yields the current values of all variables
+    uint8_t cmdLength = buf.peek<uint8_t>();
+    uint8_t commandId = buf.peek<uint8_t>(cmdLength == 0 ? sizeof(uint8_t) + sizeof(uint32_t) : sizeof(uint8_t));
+    if (commandId == RESPONSE_GET_VEHICLE_VARIABLE) {
+        processVehicleStaticAttribute(buf);
+    }
+    else if (commandId == RESPONSE_GET_PERSON_VARIABLE) {
+        processPersonStaticAttribute(buf);
+    }
+    else {
+        processSubcriptionResult(buf);
+    }
+    ASSERT(buf.eof());
+}
+
+void TraCIScenarioManager::processVehicleStaticAttribute(TraCIBuffer& buf)
+{
+    uint8_t cmdLength_resp;
+    buf >> cmdLength_resp;
+    if (cmdLength_resp == 0) {
+        uint32_t cmdLengthExt_resp;
+        buf >> cmdLengthExt_resp;
+    }
+    uint8_t commandId_resp;
+    buf >> commandId_resp;
+    ASSERT(commandId_resp == RESPONSE_GET_VEHICLE_VARIABLE);
+    uint8_t variable_resp;
+    buf >> variable_resp;
+    TraCIBuffer::StringRef objectId_resp = buf.readStringRef();
+    TraCIIdTable::Handle handle = vehicleIds.find(objectId_resp);
+    ASSERT(handle != TraCIIdTable::invalidHandle);
+
+    VehicleStaticAttributes& attributes = getVehicleRecord(handle).attributes;
+    switch (variable_resp) {
+    case VAR_TYPE:
+        attributes.typeId = buf.readTypeChecked<std::string>(TYPE_STRING);
+        break;
+
+    case VAR_LENGTH:
+        attributes.length = buf.readTypeChecked<double>(TYPE_DOUBLE);
+        break;
+
+    case VAR_HEIGHT:
+        attributes.height = buf.readTypeChecked<double>(TYPE_DOUBLE);
+        break;
+
+    case VAR_WIDTH:
+        attributes.width = buf.readTypeChecked<double>(TYPE_DOUBLE);
+        break;
+
+    default:
+        error("Received unhandled vehicle attribute; type: 0x%02x", variable_resp);
+        break;
+    }
+}
+
+void TraCIScenarioManager::subscribeToPersonVariables(TraCIConnection::Batch& batch, std::string personId)
+{
+    // get the type of the person (once, and before the subscription result needs it)
+    batch.add(CMD_GET_PERSON_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_TYPE) << personId);
+
+    // subscribe to attributes of the person that change while it is walking (or riding)
+    simtime_t beginTime = 0;
+    simtime_t endTime = SimTime::getMaxTime();
+    std::string objectId = personId;
+    uint8_t variableNumber = 4;
+    uint8_t variable1 = VAR_POSITION;
+    uint8_t variable2 = VAR_ROAD_ID;
+    uint8_t variable3 = VAR_SPEED;
+    uint8_t variable4 = VAR_ANGLE;
+
+    batch.add(CMD_SUBSCRIBE_PERSON_VARIABLE, TraCIBuffer() << beginTime << endTime << objectId << variableNumber << variable1 << variable2 << variable3 << variable4);
+}
+
+void TraCIScenarioManager::processPersonStaticAttribute(TraCIBuffer& buf)
+{
+    uint8_t cmdLength_resp;
+    buf >> cmdLength_resp;
+    if (cmdLength_resp == 0) {
+        uint32_t cmdLengthExt_resp;
+        buf >> cmdLengthExt_resp;
+    }
+    uint8_t commandId_resp;
+    buf >> commandId_resp;
+    ASSERT(commandId_resp == RESPONSE_GET_PERSON_VARIABLE);
+    uint8_t variable_resp;
+    buf >> variable_resp;
+    if (variable_resp != VAR_TYPE) error("Received unhandled person attribute; type: 0x%02x", variable_resp);
+    TraCIBuffer::StringRef objectId_resp = buf.readStringRef();
+    TraCIIdTable::Handle handle = personIds.find(objectId_resp);
+    ASSERT(handle != TraCIIdTable::invalidHandle);
+
+    getPersonRecord(handle).typeId = buf.readTypeChecked<std::string>(TYPE_STRING);
+}
+
+void TraCIScenarioManager::preloadNetworkGeometryCache()
+{
+    TraCINetworkGeometry* geometry = commandIfc->getNetworkGeometry();
+    ASSERT(geometry);
+
+    // geometry is stored in OMNeT++ coordinates, so it is only valid for the same coordinate transformation
+    std::string fileName;
+    std::string key;
+    if (!networkGeometryCacheDir.empty()) {
+        fileName = networkGeometryCacheDir + "/" + TraCINetworkGeometry::hashFile(netFile) + ".netgeo";
+        Coord origin = connection->traci2omnet(TraCICoord(0, 0));
+        Coord unit = connection->traci2omnet(TraCICoord(1, 1));
+        key = (TraCIBuffer() << origin.x << origin.y << unit.x << unit.y).str();
+        if (geometry->load(fileName, key)) {
+            EV_DEBUG << "Loaded geometry of " << geometry->getLaneCount() << " lanes and " << geometry->getJunctionCount() << " junctions from " << fileName << endl;
+            return;
+        }
+    }
+
+    commandIfc->loadNetworkGeometry();
+    EV_DEBUG << "Received geometry of " << geometry->getLaneCount() << " lanes and " << geometry->getJunctionCount() << " junctions" << endl;
+    if (!fileName.empty()) geometry->save(fileName, key);
+}
+
+void TraCIScenarioManager::subscribeToVehicleContext(const std::pair<TraCICoord, TraCICoord>& networkBoundaries)
+{
+    // area to cover: all ROI rectangles or, if there are none, the whole road network
+    std::list<TraCICoord> corners;
+    for (auto& r : roi.getRectangles()) {
+        corners.push_back(r.first);
+        corners.push_back(r.second);
+        corners.push_back(TraCICoord(r.first.x, r.second.y));
+        corners.push_back(TraCICoord(r.second.x, r.first.y));
+    }
+    if (corners.empty()) {
+        corners.push_back(networkBoundaries.first);
+        corners.push_back(networkBoundaries.second);
+        corners.push_back(TraCICoord(networkBoundaries.first.x, networkBoundaries.second.y));
+        corners.push_back(TraCICoord(networkBoundaries.second.x, networkBoundaries.first.y));
+    }
+
+    uint8_t commandId;
+    std::string objectId;
+    TraCICoord center;
+    if (!contextJunction.empty()) {
+        commandId = CMD_SUBSCRIBE_JUNCTION_CONTEXT;
+        objectId = contextJunction;
+        center = connection->omnet2traci(commandIfc->junction(contextJunction).getPosition());
+    }
+    else {
+        // subscribe around an (invisible) point of interest at the center of the area
+        double minX = corners.front().x, maxX = minX, minY = corners.front().y, maxY = minY;
+        for (auto& c : corners) {
+            minX = std::min(minX, c.x);
+            maxX = std::max(maxX, c.x);
+            minY = std::min(minY, c.y);
+            maxY = std::max(maxY, c.y);
+        }
+        center = TraCICoord((minX + maxX) / 2, (minY + maxY) / 2);
+        commandId = CMD_SUBSCRIBE_POI_CONTEXT;
+        objectId = getFullPath() + ".context";
+        commandIfc->addPoi(objectId, "veins", TraCIColor(0, 0, 0, 0), 0, connection->traci2omnet(center));
+    }
+
+    double range = contextRange;
+    if (range < 0) {
+        range = 0;
+        for (auto& c : corners) {
+            range = std::max(range, std::sqrt((c.x - center.x) * (c.x - center.x) + (c.y - center.y) * (c.y - center.y)));
+        }
+    }
+    EV_DEBUG << "Subscribing to all vehicles within " << range << "m of " << objectId << endl;
+
+    simtime_t beginTime = 0;
+    simtime_t endTime = SimTime::getMaxTime();
+    uint8_t domain = CMD_GET_VEHICLE_VARIABLE;
+    // vehicles enter the context without notice, so static attributes have to be part of the subscription
+    uint8_t variableNumber = 9;
+    uint8_t variable1 = VAR_POSITION;
+    uint8_t variable2 = VAR_ROAD_ID;
+    uint8_t variable3 = VAR_SPEED;
+    uint8_t variable4 = VAR_ANGLE;
+    uint8_t variable5 = VAR_SIGNALS;
+    uint8_t variable6 = VAR_TYPE;
+    uint8_t variable7 = VAR_LENGTH;
+    uint8_t variable8 = VAR_HEIGHT;
+    uint8_t variable9 = VAR_WIDTH;
+
+    TraCIBuffer buf = connection->query(commandId, TraCIBuffer() << beginTime << endTime << objectId << domain << range << variableNumber << variable1 << variable2 << variable3 << variable4 << variable5 << variable6 << variable7 << variable8 << variable9);
+    if (!buf.eof()) processSubcriptionResult(buf);
     ASSERT(buf.eof());
 }
+
+void TraCIScenarioManager::processVehicleContextSubscription(std::string objectId, TraCIBuffer& buf)
+{
+    contextResultReceived = true;
+
+    uint8_t domain;
+    buf >> domain;
+    ASSERT(domain == CMD_GET_VEHICLE_VARIABLE);
+    uint8_t variableNumber_resp;
+    buf >> variableNumber_resp;
+    uint32_t count;
+    buf >> count;
+    EV_DEBUG << "TraCI reports " << count << " vehicles around " << objectId << endl;
+
+    ++vehicleListEpoch;
+    for (uint32_t i = 0; i < count; ++i) {
+        TraCIIdTable::Handle handle = vehicleIds.intern(buf.readStringRef());
+        VehicleRecord& record = getVehicleRecord(handle);
+        record.subscribed = true;
+        record.lastSeen = vehicleListEpoch;
+        processVehicleVariables(handle, variableNumber_resp, buf);
+    }
+
+    removeVehiclesOutsideContext();
+}
+
+void TraCIScenarioManager::removeVehiclesOutsideContext()
+{
+    for (TraCIIdTable::Handle handle = 0; handle < vehicles.size(); ++handle) {
+        if (!vehicles[handle].subscribed || (vehicles[handle].lastSeen == vehicleListEpoch)) continue;
+        vehicles[handle].subscribed = false;
+        vehicles[handle].attributes = VehicleStaticAttributes();
+        if (vehicles[handle].module) EV_DEBUG << "Vehicle #" << vehicleIds.getId(handle) << " left context subscription range" << endl;
+        forgetVehicle(handle);
+    }
+}
+
 void TraCIScenarioManager::subscribeToTrafficLightVariables(std::string tlId)
 {
     // subscribe to some attributes of the traffic light system
@@ -730,8 +1522,8 @@ void TraCIScenarioManager::processSimSubscription(std::string objectId, TraCIBuf
             buf >> count;
             EV_DEBUG << "TraCI reports " << count << " departed vehicles." << endl;
             for (uint32_t i = 0; i < count; ++i) {
-                std::string idstring;
-                buf >> idstring;
+                TraCIBuffer::StringRef idstring = buf.readStringRef();
+                if (vehicleSubscriptionMode == VehicleSubscriptionMode::departure) queueVehicleSubscription(idstring);
                 // adding modules is handled on the fly when entering/leaving the ROI
             }
 
@@ -746,21 +1538,15 @@ void TraCIScenarioManager::processSimSubscription(std::string objectId, TraCIBuf
             buf >> count;
             EV_DEBUG << "TraCI reports " << count << " arrived vehicles." << endl;
             for (uint32_t i = 0; i < count; ++i) {
-                std::string idstring;
-                buf >> idstring;
-
-                if (subscribedVehicles.find(idstring) != subscribedVehicles.end()) {
-                    subscribedVehicles.erase(idstring);
-                    // no unsubscription via TraCI possible/necessary as of SUMO 1.0.0 (the vehicle has arrived)
-                }
+                TraCIIdTable::Handle handle = vehicleIds.find(buf.readStringRef());
+                if (handle == TraCIIdTable::invalidHandle) continue;
 
-                // check if this object has been deleted already (e.g. because it was outside the ROI)
-                cModule* mod = getManagedModule(idstring);
-                if (mod) deleteManagedModule(idstring);
+                // no unsubscription via TraCI possible/necessary as of SUMO 1.0.0 (the vehicle has arrived)
+                getVehicleRecord(handle).subscribed = false;
+                getVehicleRecord(handle).subscriptionPending = false;
+                getVehicleRecord(handle).attributes = VehicleStaticAttributes();
 
-                if (unEquippedHosts.find(idstring) != unEquippedHosts.end()) {
-                    unEquippedHosts.erase(idstring);
-                }
+                forgetVehicle(handle);
             }
 
             if ((count > 0) && (count >= activeVehicleCount) && autoShutdown) autoShutdownTriggered = true;
@@ -775,16 +1561,18 @@ void TraCIScenarioManager::processSimSubscription(std::string objectId, TraCIBuf
             buf >> count;
             EV_DEBUG << "TraCI reports " << count << " vehicles starting to teleport." << endl;
             for (uint32_t i = 0; i < count; ++i) {
-                std::string idstring;
-                buf >> idstring;
-
-                // check if this object has been deleted already (e.g. because it was outside the ROI)
-                cModule* mod = getManagedModule(idstring);
-                if (mod) deleteManagedModule(idstring);
-
-                if (unEquippedHosts.find(idstring) != unEquippedHosts.end()) {
-                    unEquippedHosts.erase(idstring);
+                TraCIIdTable::Handle handle = vehicleIds.find(buf.readStringRef());
+                if (handle == TraCIIdTable::invalidHandle) continue;
+
+                // vehicles are not part of the list of vehicles while teleporting
+                getVehicleRecord(handle).subscriptionPending = false;
+                if ((vehicleSubscriptionMode == VehicleSubscriptionMode::departure) && getVehicleRecord(handle).subscribed) {
+                    getVehicleRecord(handle).subscribed = false;
+                    getVehicleRecord(handle).attributes = VehicleStaticAttributes();
+                    unsubscribeFromVehicleVariables(pendingSubscriptions, vehicleIds.getId(handle));
                 }
+
+                forgetVehicle(handle);
             }
 
             activeVehicleCount -= count;
@@ -798,8 +1586,8 @@ void TraCIScenarioManager::processSimSubscription(std::string objectId, TraCIBuf
             buf >> count;
             EV_DEBUG << "TraCI reports " << count << " vehicles ending teleport." << endl;
             for (uint32_t i = 0; i < count; ++i) {
-                std::string idstring;
-                buf >> idstring;
+                TraCIBuffer::StringRef idstring = buf.readStringRef();
+                if (vehicleSubscriptionMode == VehicleSubscriptionMode::departure) queueVehicleSubscription(idstring);
                 // adding modules is handled on the fly when entering/leaving the ROI
             }
 
@@ -847,6 +1635,39 @@ void TraCIScenarioManager::processSimSubscription(std::string objectId, TraCIBuf
             parkingVehicleCount -= count;
             drivingVehicleCount += count;
         }
+        else if (variable1_resp == VAR_DEPARTED_PERSONS_IDS) {
+            uint8_t varType;
+            buf >> varType;
+            ASSERT(varType == TYPE_STRINGLIST);
+            uint32_t count;
+            buf >> count;
+            EV_DEBUG << "TraCI reports " << count << " departed persons." << endl;
+            for (uint32_t i = 0; i < count; ++i) {
+                queuePersonSubscription(buf.readStringRef());
+            }
+        }
+        else if (variable1_resp == VAR_ARRIVED_PERSONS_IDS) {
+            uint8_t varType;
+            buf >> varType;
+            ASSERT(varType == TYPE_STRINGLIST);
+            uint32_t count;
+            buf >> count;
+            EV_DEBUG << "TraCI reports " << count << " arrived persons." << endl;
+            for (uint32_t i = 0; i < count; ++i) {
+                TraCIIdTable::Handle handle = personIds.find(buf.readStringRef());
+                if (handle == TraCIIdTable::invalidHandle) continue;
+
+                // no unsubscription via TraCI possible/necessary (the person has arrived)
+                getPersonRecord(handle).subscribed = false;
+                getPersonRecord(handle).subscriptionPending = false;
+                getPersonRecord(handle).typeId.clear();
+
+                // check if this object has been deleted already (e.g. because it was outside the ROI)
+                if (getPersonRecord(handle).module) deletePersonModule(handle);
+
+                forgetPersonIfUnused(handle);
+            }
+        }
         else if (variable1_resp == getCommandInterface()->getTimeStepCmd()) {
             uint8_t varType;
             buf >> varType;
@@ -861,24 +1682,153 @@ void TraCIScenarioManager::processSimSubscription(std::string objectId, TraCIBuf
             error("Received unhandled sim subscription result");
         }
     }
+
+    // only now, so vehicles (and persons) that departed and arrived in the same timestep are not subscribed to
+    sendPendingSubscriptions();
 }
 
-void TraCIScenarioManager::processVehicleSubscription(std::string objectId, TraCIBuffer& buf)
+void TraCIScenarioManager::queueVehicleSubscription(const TraCIBuffer::StringRef& vehicleId)
 {
-    bool isSubscribed = (subscribedVehicles.find(objectId) != subscribedVehicles.end());
+    TraCIIdTable::Handle handle = vehicleIds.intern(vehicleId);
+    VehicleRecord& record = getVehicleRecord(handle);
+    if (record.subscribed || record.subscriptionPending) return;
+    record.subscriptionPending = true;
+    pendingSubscriptionIds.push_back(vehicleIds.getId(handle));
+}
+
+void TraCIScenarioManager::queuePersonSubscription(const TraCIBuffer::StringRef& personId)
+{
+    TraCIIdTable::Handle handle = personIds.intern(personId);
+    PersonRecord& record = getPersonRecord(handle);
+    if (record.subscribed || record.subscriptionPending) return;
+    record.subscriptionPending = true;
+    pendingPersonSubscriptionIds.push_back(personIds.getId(handle));
+}
+
+void TraCIScenarioManager::sendPendingSubscriptions()
+{
+    for (auto& vehicleId : pendingSubscriptionIds) {
+        TraCIIdTable::Handle handle = vehicleIds.find(vehicleId);
+        if (handle == TraCIIdTable::invalidHandle) continue;
+        VehicleRecord& record = getVehicleRecord(handle);
+        if (!record.subscriptionPending) continue;
+        record.subscriptionPending = false;
+        record.subscribed = true;
+        subscribeToVehicleVariables(pendingSubscriptions, vehicleId);
+    }
+    pendingSubscriptionIds.clear();
+
+    for (auto& personId : pendingPersonSubscriptionIds) {
+        TraCIIdTable::Handle handle = personIds.find(personId);
+        if (handle == TraCIIdTable::invalidHandle) continue;
+        PersonRecord& record = getPersonRecord(handle);
+        if (!record.subscriptionPending) continue;
+        record.subscriptionPending = false;
+        record.subscribed = true;
+        subscribeToPersonVariables(pendingSubscriptions, personId);
+    }
+    pendingPersonSubscriptionIds.clear();
+
+    if (pendingSubscriptions.empty()) return;
+    EV_DEBUG << "Sending " << pendingSubscriptions.size() << " vehicle and person (un)subscription commands" << endl;
+    // handling the responses might queue further commands, so take the batch out of pendingSubscriptions first
+    TraCIConnection::Batch batch;
+    std::swap(batch, pendingSubscriptions);
+    connection->query(batch, std::bind(&TraCIScenarioManager::processBatchResponse, this, std::placeholders::_1, std::placeholders::_2));
+}
+
+void TraCIScenarioManager::checkVehicleList()
+{
+    stepsSinceVehicleListCheck = 0;
+
+    TraCIBuffer buf = connection->query(CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(ID_LIST) << std::string(""));
+    uint8_t cmdLength_resp;
+    buf >> cmdLength_resp;
+    if (cmdLength_resp == 0) {
+        uint32_t cmdLengthExt_resp;
+        buf >> cmdLengthExt_resp;
+    }
+    uint8_t commandId_resp;
+    buf >> commandId_resp;
+    ASSERT(commandId_resp == RESPONSE_GET_VEHICLE_VARIABLE);
+    uint8_t variable_resp;
+    buf >> variable_resp;
+    ASSERT(variable_resp == ID_LIST);
+    buf.readStringRef();
+
+    size_t numChanged = processVehicleList(buf);
+    ASSERT(buf.eof());
+    if ((numChanged > 0) && (vehicleListEpoch > 1)) {
+        EV_WARN << "Vehicle list check found " << numChanged << " vehicles whose subscriptions were out of sync" << endl;
+    }
+}
+
+size_t TraCIScenarioManager::processVehicleList(TraCIBuffer& buf)
+{
+    uint8_t varType;
+    buf >> varType;
+    ASSERT(varType == TYPE_STRINGLIST);
+    uint32_t count;
+    buf >> count;
+    EV_DEBUG << "TraCI reports " << count << " active vehicles." << endl;
+    ASSERT(count == activeVehicleCount);
+
+    // (un)subscribe all vehicles that need it in a single round trip
+    TraCIConnection::Batch batch;
+
+    // check for vehicles that need subscribing to
+    size_t numSubscribe = 0;
+    ++vehicleListEpoch;
+    for (uint32_t i = 0; i < count; ++i) {
+        TraCIIdTable::Handle driving = vehicleIds.intern(buf.readStringRef());
+        VehicleRecord& record = getVehicleRecord(driving);
+        record.lastSeen = vehicleListEpoch;
+        if (record.subscribed) continue;
+        record.subscribed = true;
+        subscribeToVehicleVariables(batch, vehicleIds.getId(driving));
+        numSubscribe++;
+    }
+
+    // check for vehicles that need unsubscribing from
+    size_t numUnsubscribe = 0;
+    for (TraCIIdTable::Handle subscribed = 0; subscribed < vehicles.size(); ++subscribed) {
+        VehicleRecord& record = vehicles[subscribed];
+        if (!record.subscribed || (record.lastSeen == vehicleListEpoch)) continue;
+        record.subscribed = false;
+        record.attributes = VehicleStaticAttributes();
+        unsubscribeFromVehicleVariables(batch, vehicleIds.getId(subscribed));
+        forgetVehicleIfUnused(subscribed);
+        numUnsubscribe++;
+    }
+
+    if (!batch.empty()) {
+        EV_DEBUG << "Subscribing to " << numSubscribe << " and unsubscribing from " << numUnsubscribe << " vehicles" << endl;
+        connection->query(batch, std::bind(&TraCIScenarioManager::processBatchResponse, this, std::placeholders::_1, std::placeholders::_2));
+    }
+
+    return numSubscribe + numUnsubscribe;
+}
+
+void TraCIScenarioManager::processVehicleSubscription(TraCIIdTable::Handle handle, TraCIBuffer& buf)
+{
+    uint8_t variableNumber_resp;
+    buf >> variableNumber_resp;
+    processVehicleVariables(handle, variableNumber_resp, buf);
+}
+
+void TraCIScenarioManager::processVehicleVariables(TraCIIdTable::Handle handle, uint8_t variableNumber_resp, TraCIBuffer& buf)
+{
+    bool isSubscribed = (handle != TraCIIdTable::invalidHandle) && getVehicleRecord(handle).subscribed;
     double px;
     double py;
     std::string edge;
     double speed;
     double angle_traci;
     int signals;
-    double length;
-    double height;
-    double width;
     int numRead = 0;
+    // where to cache static attributes, in case they are part of the subscription
+    VehicleStaticAttributes* attributes = isSubscribed ? &getVehicleRecord(handle).attributes : nullptr;
 
-    uint8_t variableNumber_resp;
-    buf >> variableNumber_resp;
     for (uint8_t j = 0; j < variableNumber_resp; ++j) {
         uint8_t variable1_resp;
         buf >> variable1_resp;
@@ -896,35 +1846,7 @@ void TraCIScenarioManager::processVehicleSubscription(std::string objectId, TraC
             }
         }
         else if (variable1_resp == ID_LIST) {
-            uint8_t varType;
-            buf >> varType;
-            ASSERT(varType == TYPE_STRINGLIST);
-            uint32_t count;
-            buf >> count;
-            EV_DEBUG << "TraCI reports " << count << " active vehicles." << endl;
-            ASSERT(count == activeVehicleCount);
-            std::set<std::string> drivingVehicles;
-            for (uint32_t i = 0; i < count; ++i) {
-                std::string idstring;
-                buf >> idstring;
-                drivingVehicles.insert(idstring);
-            }
-
-            // check for vehicles that need subscribing to
-            std::set<std::string> needSubscribe;
-            std::set_difference(drivingVehicles.begin(), drivingVehicles.end(), subscribedVehicles.begin(), subscribedVehicles.end(), std::inserter(needSubscribe, needSubscribe.begin()));
-            for (std::set<std::string>::const_iterator i = needSubscribe.begin(); i != needSubscribe.end(); ++i) {
-                subscribedVehicles.insert(*i);
-                subscribeToVehicleVariables(*i);
-            }
-
-            // check for vehicles that need unsubscribing from
-            std::set<std::string> needUnsubscribe;
-            std::set_difference(subscribedVehicles.begin(), subscribedVehicles.end(), drivingVehicles.begin(), drivingVehicles.end(), std::inserter(needUnsubscribe, needUnsubscribe.begin()));
-            for (std::set<std::string>::const_iterator i = needUnsubscribe.begin(); i != needUnsubscribe.end(); ++i) {
-                subscribedVehicles.erase(*i);
-                unsubscribeFromVehicleVariables(*i);
-            }
+            processVehicleList(buf);
         }
         else if (variable1_resp == VAR_POSITION) {
             uint8_t varType;
@@ -962,26 +1884,37 @@ void TraCIScenarioManager::processVehicleSubscription(std::string objectId, TraC
             buf >> signals;
             numRead++;
         }
+        else if (variable1_resp == VAR_TYPE) {
+            uint8_t varType;
+            buf >> varType;
+            ASSERT(varType == TYPE_STRING);
+            std::string typeId;
+            buf >> typeId;
+            if (attributes) attributes->typeId = typeId;
+        }
         else if (variable1_resp == VAR_LENGTH) {
             uint8_t varType;
             buf >> varType;
             ASSERT(varType == TYPE_DOUBLE);
+            double length;
             buf >> length;
-            numRead++;
+            if (attributes) attributes->length = length;
         }
         else if (variable1_resp == VAR_HEIGHT) {
             uint8_t varType;
             buf >> varType;
             ASSERT(varType == TYPE_DOUBLE);
+            double height;
             buf >> height;
-            numRead++;
+            if (attributes) attributes->height = height;
         }
         else if (variable1_resp == VAR_WIDTH) {
             uint8_t varType;
             buf >> varType;
             ASSERT(varType == TYPE_DOUBLE);
+            double width;
             buf >> width;
-            numRead++;
+            if (attributes) attributes->width = width;
         }
         else {
             error("Received unhandled vehicle subscription result");
@@ -992,74 +1925,216 @@ void TraCIScenarioManager::processVehicleSubscription(std::string objectId, TraC
     if (!isSubscribed) return;
 
     // make sure we got updates for all attributes
-    if (numRead != 8) return;
+    if (numRead != 5) return;
+    if (!attributes->isComplete()) return;
 
-    Coord p = connection->traci2omnet(TraCICoord(px, py));
-    if ((p.x < 0) || (p.y < 0)) error("received bad node position (%.2f, %.2f), translated to (%.2f, %.2f)", px, py, p.x, p.y);
+    // subscribing again to change the subscription rate yields the current state again
+    VehicleRecord& record = getVehicleRecord(handle);
+    if (record.lastUpdate == simTime()) return;
+    record.lastUpdate = simTime();
 
-    Heading heading = connection->traci2omnetHeading(angle_traci);
+    TraCICoord traciPosition(px, py);
+    Coord position = connection->traci2omnet(traciPosition);
+    updateVehicle(handle, traciPosition, position, edge, speed, connection->traci2omnetHeading(angle_traci), VehicleSignalSet(signals));
+
+    if ((slowUpdateInterval > 0) && getVehicleRecord(handle).subscribed) updateSubscriptionRate(handle, position, speed);
+}
+
+bool TraCIScenarioManager::isVehicleRelevant(TraCIIdTable::Handle handle, const Coord& position, double speed)
+{
+    VehicleRecord& record = getVehicleRecord(handle);
+    cModule* mod = record.module;
+    if (!mod) {
+        // a dormant vehicle matters as soon as it might get its module before the next slow update would tell
+        if (!record.dormant) return false;
+        if (record.moduleRequested) return true;
+        return lazyModuleConnectionManager->hasNicsWithin(position, lazyModuleDistance + speed * slowUpdateInterval.dbl());
+    }
+
+    // halting as per SUMO's definition
+    if (speed < 0.1) return false;
+
+    auto cas = getSubmodulesOfType<ChannelAccess>(mod, true);
+    // modules without network interfaces might still be relevant in other ways (e.g., as obstacles)
+    if (cas.empty()) return true;
+    for (auto ca : cas) {
+        cModule* nic = ca->getParentModule();
+        if (ChannelAccess::getConnectionManager(nic)->hasNicsNear(position, nic->getId())) return true;
+    }
+    return false;
+}
+
+void TraCIScenarioManager::updateSubscriptionRate(TraCIIdTable::Handle handle, const Coord& position, double speed)
+{
+    VehicleRecord& record = getVehicleRecord(handle);
+    const std::string& vehicleId = vehicleIds.getId(handle);
+    // the TraCI server keeps subscriptions with different begin times side by side, so the previous one needs to go first
+    if (isVehicleRelevant(handle, position, speed)) {
+        if (!record.slowUpdates) return;
+        record.slowUpdates = false;
+        unsubscribeFromVehicleVariables(pendingSubscriptions, vehicleId);
+        subscribeToVehicleState(pendingSubscriptions, vehicleId, simTime());
+    }
+    else {
+        // (re)subscribe for every slow update, else all updates after the first would be at full rate again
+        record.slowUpdates = true;
+        unsubscribeFromVehicleVariables(pendingSubscriptions, vehicleId);
+        subscribeToVehicleState(pendingSubscriptions, vehicleId, simTime() + slowUpdateInterval);
+    }
+}
+
+void TraCIScenarioManager::updateVehicle(TraCIIdTable::Handle handle, const TraCICoord& traciPosition, const Coord& p, const std::string& edge, double speed, Heading heading, VehicleSignalSet signals)
+{
+    const VehicleStaticAttributes* attributes = &getVehicleRecord(handle).attributes;
+    const std::string& objectId = vehicleIds.getId(handle);
 
-    cModule* mod = getManagedModule(objectId);
+    if ((p.x < 0) || (p.y < 0)) error("received bad node position (%.2f, %.2f), translated to (%.2f, %.2f)", traciPosition.x, traciPosition.y, p.x, p.y);
+
+    cModule* mod = getVehicleRecord(handle).module;
 
     // is it in the ROI?
-    bool inRoi = !roi.hasConstraints() ? true : (roi.onAnyRectangle(TraCICoord(px, py)) || roi.partOfRoads(edge));
+    bool inRoi = !roi.hasConstraints() ? true : (roi.onAnyRectangle(traciPosition) || roi.partOfRoads(edge));
     if (!inRoi) {
         if (mod) {
-            deleteManagedModule(objectId);
+            deleteManagedModule(handle);
             EV_DEBUG << "Vehicle #" << objectId << " left region of interest" << endl;
         }
-        else if (unEquippedHosts.find(objectId) != unEquippedHosts.end()) {
-            unEquippedHosts.erase(objectId);
+        else if (getVehicleRecord(handle).unequipped) {
+            forgetUnequippedHost(handle);
             EV_DEBUG << "Vehicle (unequipped) # " << objectId << " left region of interest" << endl;
         }
+        else if (getVehicleRecord(handle).dormant) {
+            forgetDormantVehicle(handle);
+            EV_DEBUG << "Vehicle (dormant) #" << objectId << " left region of interest" << endl;
+        }
         return;
     }
 
-    if (isModuleUnequipped(objectId)) {
+    if (getVehicleRecord(handle).unequipped) {
         return;
     }
 
     if (!mod) {
         // no such module - need to create
-        std::string vType = commandIfc->vehicle(objectId).getTypeId();
-        std::string mType, mName, mDisplayString;
-        TypeMapping::iterator iType, iName, iDisplayString;
-
-        TypeMapping::iterator i;
-        iType = moduleType.find(vType);
-        if (iType == moduleType.end()) {
-            iType = moduleType.find("*");
-            if (iType == moduleType.end()) throw cRuntimeError("cannot find a module type for vehicle type \"%s\"", vType.c_str());
-        }
-        mType = iType->second;
-        // search for module name
-        iName = moduleName.find(vType);
-        if (iName == moduleName.end()) {
-            iName = moduleName.find(std::string("*"));
-            if (iName == moduleName.end()) throw cRuntimeError("cannot find a module name for vehicle type \"%s\"", vType.c_str());
+        ModuleMapping mapping = findModuleMapping("vehicle", attributes->typeId, moduleType, moduleName, moduleDisplayString);
+
+        if (mapping.type != "0") {
+            if (isModuleDeferred(handle, p)) {
+                updateDormantVehicle(handle, p, heading);
+                return;
+            }
+            forgetDormantVehicle(handle);
+            addModule(objectId, mapping.type, mapping.name, mapping.displayString, p, edge, speed, heading, signals, attributes->length, attributes->height, attributes->width);
+            EV_DEBUG << "Added vehicle #" << objectId << endl;
         }
-        mName = iName->second;
-        if (moduleDisplayString.size() != 0) {
-            iDisplayString = moduleDisplayString.find(vType);
-            if (iDisplayString == moduleDisplayString.end()) {
-                iDisplayString = moduleDisplayString.find("*");
-                if (iDisplayString == moduleDisplayString.end()) throw cRuntimeError("cannot find a module display string for vehicle type \"%s\"", vType.c_str());
+    }
+    else {
+        // module existed - update position
+        EV_DEBUG << "module " << objectId << " moving to " << p.x << "," << p.y << endl;
+        updateModulePosition(mod, p, edge, speed, heading, signals);
+    }
+}
+
+void TraCIScenarioManager::processPersonSubscription(TraCIIdTable::Handle handle, TraCIBuffer& buf)
+{
+    bool isSubscribed = (handle != TraCIIdTable::invalidHandle) && getPersonRecord(handle).subscribed;
+    double px;
+    double py;
+    std::string edge;
+    double speed;
+    double angle_traci;
+    int numRead = 0;
+
+    uint8_t variableNumber_resp;
+    buf >> variableNumber_resp;
+    for (uint8_t j = 0; j < variableNumber_resp; ++j) {
+        uint8_t variable1_resp;
+        buf >> variable1_resp;
+        uint8_t isokay;
+        buf >> isokay;
+        if (isokay != RTYPE_OK) {
+            uint8_t varType;
+            buf >> varType;
+            ASSERT(varType == TYPE_STRING);
+            std::string errormsg;
+            buf >> errormsg;
+            if (isSubscribed) {
+                if (isokay == RTYPE_NOTIMPLEMENTED) error("TraCI server reported subscribing to person variable 0x%2x not implemented (\"%s\"). Might need newer version.", variable1_resp, errormsg.c_str());
+                error("TraCI server reported error subscribing to person variable 0x%2x (\"%s\").", variable1_resp, errormsg.c_str());
             }
-            mDisplayString = iDisplayString->second;
+        }
+        else if (variable1_resp == VAR_POSITION) {
+            uint8_t varType;
+            buf >> varType;
+            ASSERT(varType == POSITION_2D);
+            buf >> px;
+            buf >> py;
+            numRead++;
+        }
+        else if (variable1_resp == VAR_ROAD_ID) {
+            uint8_t varType;
+            buf >> varType;
+            ASSERT(varType == TYPE_STRING);
+            buf >> edge;
+            numRead++;
+        }
+        else if (variable1_resp == VAR_SPEED) {
+            uint8_t varType;
+            buf >> varType;
+            ASSERT(varType == TYPE_DOUBLE);
+            buf >> speed;
+            numRead++;
+        }
+        else if (variable1_resp == VAR_ANGLE) {
+            uint8_t varType;
+            buf >> varType;
+            ASSERT(varType == TYPE_DOUBLE);
+            buf >> angle_traci;
+            numRead++;
         }
         else {
-            mDisplayString = "";
+            error("Received unhandled person subscription result");
         }
+    }
 
-        if (mType != "0") {
-            addModule(objectId, mType, mName, mDisplayString, p, edge, speed, heading, VehicleSignalSet(signals), length, height, width);
-            EV_DEBUG << "Added vehicle #" << objectId << endl;
+    // bail out if we didn't want to receive these subscription results
+    if (!isSubscribed) return;
+
+    // make sure we got updates for all attributes
+    if (numRead != 4) return;
+    if (getPersonRecord(handle).typeId.empty()) return;
+
+    const std::string& objectId = personIds.getId(handle);
+
+    Coord p = connection->traci2omnet(TraCICoord(px, py));
+    if ((p.x < 0) || (p.y < 0)) error("received bad person position (%.2f, %.2f), translated to (%.2f, %.2f)", px, py, p.x, p.y);
+
+    Heading heading = connection->traci2omnetHeading(angle_traci);
+
+    cModule* mod = getPersonRecord(handle).module;
+
+    // is it in the ROI?
+    bool inRoi = !roi.hasConstraints() ? true : (roi.onAnyRectangle(TraCICoord(px, py)) || roi.partOfRoads(edge));
+    if (!inRoi) {
+        if (mod) {
+            deletePersonModule(handle);
+            EV_DEBUG << "Person #" << objectId << " left region of interest" << endl;
         }
+        return;
+    }
+
+    if (!mod) {
+        // no such module - need to create
+        ModuleMapping mapping = findModuleMapping("person", getPersonRecord(handle).typeId, personModuleType, personModuleName, personModuleDisplayString);
+        if (mapping.type == "0") return;
+
+        addPersonModule(handle, mapping.type, mapping.name, mapping.displayString, p, edge, speed, heading);
+        EV_DEBUG << "Added person #" << objectId << endl;
     }
     else {
         // module existed - update position
         EV_DEBUG << "module " << objectId << " moving to " << p.x << "," << p.y << endl;
-        updateModulePosition(mod, p, edge, speed, heading, VehicleSignalSet(signals));
+        updateModulePosition(mod, p, edge, speed, heading, {VehicleSignal::undefined});
     }
 }
 
@@ -1071,15 +2146,18 @@ void TraCIScenarioManager::processSubcriptionResult(TraCIBuffer& buf)
     buf >> cmdLengthExt_resp;
     uint8_t commandId_resp;
     buf >> commandId_resp;
-    std::string objectId_resp;
-    buf >> objectId_resp;
+    TraCIBuffer::StringRef objectId_resp = buf.readStringRef();
 
     if (commandId_resp == RESPONSE_SUBSCRIBE_VEHICLE_VARIABLE)
-        processVehicleSubscription(objectId_resp, buf);
+        processVehicleSubscription(vehicleIds.find(objectId_resp), buf);
+    else if (commandId_resp == RESPONSE_SUBSCRIBE_PERSON_VARIABLE)
+        processPersonSubscription(personIds.find(objectId_resp), buf);
     else if (commandId_resp == RESPONSE_SUBSCRIBE_SIM_VARIABLE)
-        processSimSubscription(objectId_resp, buf);
+        processSimSubscription(objectId_resp.str(), buf);
     else if (commandId_resp == RESPONSE_SUBSCRIBE_TL_VARIABLE)
-        processTrafficLightSubscription(objectId_resp, buf);
+        processTrafficLightSubscription(objectId_resp.str(), buf);
+    else if ((commandId_resp == RESPONSE_SUBSCRIBE_JUNCTION_CONTEXT) || (commandId_resp == RESPONSE_SUBSCRIBE_POI_CONTEXT))
+        processVehicleContextSubscription(objectId_resp.str(), buf);
     else {
         error("Received unhandled subscription result");
     }
@@ -20,10 +20,13 @@
 
 #pragma once
 
+#include <fstream>
 #include <map>
 #include <memory>
 #include <list>
 #include <queue>
+#include <set>
+#include <vector>
 
 #include "veins/veins.h"
 
@@ -37,6 +40,7 @@
 #include "veins/modules/mobility/traci/TraCIColor.h"
 #include "veins/modules/mobility/traci/TraCIConnection.h"
 #include "veins/modules/mobility/traci/TraCICoord.h"
+#include "veins/modules/mobility/traci/TraCIIdTable.h"
 #include "veins/modules/mobility/traci/VehicleSignal.h"
 #include "veins/modules/mobility/traci/TraCIRegionOfInterest.h"
 
@@ -100,17 +104,87 @@ public:
         return hosts;
     }
 
+    const std::map<std::string, cModule*>& getManagedPersons()
+    {
+        return managedPersons;
+    }
+
+    /**
+     * makes sure the vehicle with id nodeId gets a module at its next update, even if lazyModuleDistance would defer it.
+     *
+     * Returns false if there is no such vehicle.
+     */
+    bool requestModule(const std::string& nodeId);
+
 protected:
+    /**
+     * how vehicles are tracked
+     */
+    enum class VehicleSubscriptionMode {
+        object, /**< subscribe to the list of all vehicles, then to the variables of each vehicle */
+        departure, /**< subscribe to the variables of each vehicle as it departs, unsubscribe as it arrives */
+        context, /**< one context subscription to the variables of all vehicles around a junction or point of interest */
+    };
+
+    /**
+     * attributes of a vehicle that do not change while it is driving, so are only received once
+     */
+    struct VehicleStaticAttributes {
+        std::string typeId;
+        double length = -1;
+        double height = -1;
+        double width = -1;
+
+        bool isComplete() const
+        {
+            return !typeId.empty() && (length >= 0) && (height >= 0) && (width >= 0);
+        }
+    };
+
+    /**
+     * everything we keep track of per vehicle
+     */
+    struct VehicleRecord {
+        bool subscribed = false; /**< whether we are subscribed to the vehicle */
+        bool subscriptionPending = false; /**< in departure mode: whether the vehicle has departed, but we have not yet subscribed to it */
+        bool unequipped = false; /**< whether the vehicle did not get a module because it is not equipped */
+        cModule* module = nullptr; /**< module managed for the vehicle, if any */
+        std::string moduleName; /**< name the module was requested with (which a reused module is not named exactly, see addModule) */
+        uint64_t lastSeen = 0; /**< vehicleListEpoch of the last vehicle list (or context subscription result) the vehicle was part of */
+        simtime_t lastUpdate = -1; /**< when the vehicle's state was last received from the TraCI server */
+        bool slowUpdates = false; /**< whether the vehicle is subscribed to at the reduced rate of slowUpdateInterval */
+        bool dormant = false; /**< whether the vehicle would get a module, but lazyModuleDistance defers it */
+        bool moduleRequested = false; /**< whether a module was asked for via requestModule */
+        const VehicleObstacle* obstacle = nullptr; /**< obstacle standing in for the module of a dormant vehicle, if vehicleObstacleControl is used */
+        VehicleStaticAttributes attributes;
+    };
+
+    /**
+     * everything we keep track of per person
+     */
+    struct PersonRecord {
+        bool subscribed = false; /**< whether we are subscribed to the person */
+        bool subscriptionPending = false; /**< whether the person has departed, but we have not yet subscribed to it */
+        cModule* module = nullptr; /**< module managed for the person, if any */
+        std::string typeId; /**< type of the person, received once when subscribing */
+    };
+
     simtime_t connectAt; /**< when to connect to TraCI server (must be the initial timestep of the server) */
     simtime_t firstStepAt; /**< when to start synchronizing with the TraCI server (-1: immediately after connecting) */
     simtime_t updateInterval; /**< time interval of hosts' position updates */
+    bool pipelinedStepping; /**< whether to request the next timestep from the TraCI server as soon as the current one has been processed, see TraCIConnection::sendStep */
     // maps from vehicle type to moduleType, moduleName, and moduleDisplayString
     typedef std::map<std::string, std::string> TypeMapping;
     TypeMapping moduleType; /**< module type to be used in the simulation for each managed vehicle */
     TypeMapping moduleName; /**< module name to be used in the simulation for each managed vehicle */
     TypeMapping moduleDisplayString; /**< module displayString to be used in the simulation for each managed vehicle */
+    TypeMapping personModuleType; /**< module type to be used in the simulation for each managed person (empty: do not track persons) */
+    TypeMapping personModuleName; /**< module name to be used in the simulation for each managed person */
+    TypeMapping personModuleDisplayString; /**< module displayString to be used in the simulation for each managed person */
     std::string host;
     int port;
+    std::string traciRecordFile; /**< file to record the TraCI session to (empty: do not record) */
+    std::string traciReplayFile; /**< file to replay a recorded TraCI session from instead of connecting to a server (empty: connect) */
 
     std::string trafficLightModuleType; /**< module type to be used in the simulation for each managed traffic light */
     std::string trafficLightModuleName; /**< module name to be used in the simulation for each managed traffic light */
@@ -120,17 +194,46 @@ protected:
     bool autoShutdown; /**< Shutdown module as soon as no more vehicles are in the simulation */
     double penetrationRate;
     bool ignoreGuiCommands; /**< whether to ignore all TraCI commands that only make sense when the server has a graphical user interface */
+    bool cacheGetters; /**< whether TraCICommandInterface getters remember their results, see TraCICommandInterface::setCacheGetters */
+    bool cacheNetworkGeometry; /**< whether TraCICommandInterface remembers lane shapes, junction positions, and the edges of routes, see TraCICommandInterface::setCacheNetworkGeometry */
+    bool preloadNetworkGeometry; /**< whether to fill the network geometry cache right after connecting */
+    std::string networkGeometryCacheDir; /**< directory to save preloaded network geometry to, named after a hash of netFile (empty: do not save) */
+    std::string netFile; /**< SUMO .net.xml file of the simulation */
+    bool traciStatistics; /**< whether to collect statistics of the messages exchanged with the TraCI server, see TraCIConnection::enableStatistics */
+    std::string traciStatisticsFile; /**< file to periodically write TraCI statistics to (empty: do not write) */
+    simtime_t traciStatisticsInterval; /**< time interval of writing TraCI statistics to traciStatisticsFile */
+    simtime_t nextTraciStatisticsAt; /**< when to next write TraCI statistics to traciStatisticsFile */
+    std::unique_ptr<std::ofstream> traciStatisticsStream; /**< opened traciStatisticsFile, if any */
+    int modulePoolSize; /**< number of vehicle modules to keep for reuse after their vehicle left the simulation (0: delete them) */
+    double lazyModuleDistance; /**< distance to the closest network interface within which vehicles get a module (negative: always) */
+    BaseConnectionManager* lazyModuleConnectionManager; /**< where to look for network interfaces close to vehicles, if lazyModuleDistance is set */
     TraCIRegionOfInterest roi; /**< Can return whether a given position lies within the simulation's region of interest. Modules are destroyed and re-created as managed vehicles leave and re-enter the ROI */
     double areaSum;
+    VehicleSubscriptionMode vehicleSubscriptionMode;
+    std::string contextJunction; /**< in context mode: junction around which to subscribe (empty: around a point of interest added at the center of the ROI rectangles or the road network) */
+    double contextRange; /**< in context mode: radius of the context subscription (negative: cover all ROI rectangles or the whole road network) */
+    bool contextResultReceived; /**< in context mode: whether the context subscription result of the current timestep has been processed */
+    int vehicleListCheckPeriod; /**< in departure mode: number of timesteps after which to compare subscriptions against the list of all vehicles (0: only once after connecting) */
+    int stepsSinceVehicleListCheck; /**< in departure mode: number of timesteps since subscriptions were last compared against the list of all vehicles */
+    TraCIConnection::Batch pendingSubscriptions; /**< vehicle (un)subscription commands to send once the current sim subscription result (or, for changes of subscription rate, timestep) has been processed */
+    simtime_t slowUpdateInterval; /**< in object and departure mode: time interval of updates for vehicles that are not relevant to the network simulation (0: update all vehicles every updateInterval) */
+    std::vector<std::string> pendingSubscriptionIds; /**< in departure mode: vehicles that departed during the current timestep */
+    std::vector<std::string> pendingPersonSubscriptionIds; /**< persons that departed during the current timestep */
 
     AnnotationManager* annotations;
     std::unique_ptr<TraCIConnection> connection;
+    TraCIBuffer simstepResponse; /**< reused for receiving the (large) response to every CMD_SIMSTEP2 */
     std::unique_ptr<TraCICommandInterface> commandIfc;
 
     size_t nextNodeVectorIndex; /**< next OMNeT++ module vector index to use */
     std::map<std::string, cModule*> hosts; /**< vector of all hosts managed by us */
-    std::set<std::string> unEquippedHosts;
-    std::set<std::string> subscribedVehicles; /**< all vehicles we have already subscribed to */
+    TraCIIdTable vehicleIds; /**< handles of all vehicles we keep track of */
+    std::vector<VehicleRecord> vehicles; /**< what we keep track of per vehicle, indexed by handle */
+    size_t unEquippedHostCount; /**< number of vehicles that did not get a module because they are not equipped */
+    uint64_t vehicleListEpoch; /**< number of vehicle lists (or context subscription results) received so far */
+    std::map<std::string, cModule*> managedPersons; /**< modules of all persons managed by us */
+    TraCIIdTable personIds; /**< handles of all persons we keep track of */
+    std::vector<PersonRecord> persons; /**< what we keep track of per person, indexed by handle */
     std::map<std::string, cModule*> trafficLights; /**< vector of all traffic lights managed by us */
     uint32_t activeVehicleCount; /**< number of vehicles, be it parking or driving **/
     uint32_t parkingVehicleCount; /**< number of parking vehicles, derived from parking start/end events */
@@ -143,8 +246,19 @@ protected:
     std::map<const TraCIMobility*, const VehicleObstacle*> vehicleObstacles;
     VehicleObstacleControl* vehicleObstacleControl;
 
+    std::map<std::pair<cModuleType*, std::string>, std::vector<cModule*>> modulePool; /**< vehicle modules kept for reuse, by type and name */
+    size_t pooledModuleCount; /**< number of modules in modulePool */
+    std::set<cModuleType*> unpoolableModuleTypes; /**< types of vehicle modules found to contain simple modules that are not a TraCIReusableModule */
+    uint64_t modulesCreated; /**< number of vehicle modules created */
+    uint64_t modulesReused; /**< number of vehicle modules taken from modulePool instead of being created */
+    uint64_t modulesPooled; /**< number of vehicle modules put into modulePool instead of being deleted */
+
     void executeOneTimestep(); /**< read and execute all commands for the next timestep */
 
+    TraCIStatistics::Histogram* getPhaseStatistics(TraCIStatistics::Phase phase); /**< returns where to record the time spent on phase, or nullptr if not collecting statistics */
+    void writeTraciStatistics(); /**< appends the current TraCI statistics to traciStatisticsFile */
+    void recordTraciStatistics(); /**< records the TraCI statistics as scalars */
+
     virtual void init_traci();
 
     virtual void preInitializeModule(cModule* mod, const std::string& nodeId, const Coord& position, const std::string& road_id, double speed, Heading heading, VehicleSignalSet signals);
@@ -152,13 +266,57 @@ protected:
     void addModule(std::string nodeId, std::string type, std::string name, std::string displayString, const Coord& position, std::string road_id = "", double speed = -1, Heading heading = Heading::nan, VehicleSignalSet signals = {VehicleSignal::undefined}, double length = 0, double height = 0, double width = 0);
     cModule* getManagedModule(std::string nodeId); /**< returns a pointer to the managed module named moduleName, or 0 if no module can be found */
     void deleteManagedModule(std::string nodeId);
+    void deleteManagedModule(TraCIIdTable::Handle handle); /**< like deleteManagedModule(std::string), but keeps the handle of the vehicle */
+    bool poolModule(cModule* mod, const std::string& name); /**< prepares the module of a vehicle that left the simulation for reuse and keeps it in modulePool under the name it was requested with, if possible; returns false if it needs to be deleted instead */
+    cModule* takePooledModule(cModuleType* type, const std::string& name); /**< returns a module of this type and name from modulePool, or nullptr if there is none */
+
+    VehicleRecord& getVehicleRecord(TraCIIdTable::Handle handle); /**< returns the record of a vehicle, making room for it if necessary */
+    void forgetVehicleIfUnused(TraCIIdTable::Handle handle); /**< releases the handle of a vehicle if there is nothing left to keep track of */
+    void forgetUnequippedHost(TraCIIdTable::Handle handle); /**< clears the unequipped mark of a vehicle, if set */
+    bool isModuleDeferred(TraCIIdTable::Handle handle, const Coord& position); /**< whether lazyModuleDistance defers creating a module for a vehicle at position */
+    void updateDormantVehicle(TraCIIdTable::Handle handle, const Coord& position, Heading heading); /**< marks a vehicle as dormant (if not already) and moves its obstacle, if any */
+    void forgetDormantVehicle(TraCIIdTable::Handle handle); /**< clears the dormant mark of a vehicle and removes its obstacle, if any */
+    void forgetVehicle(TraCIIdTable::Handle handle); /**< deletes the module of a vehicle that left the simulation (if any), clears its marks, and releases its handle unless still subscribed to */
 
     bool isModuleUnequipped(std::string nodeId); /**< returns true if this vehicle is Unequipped */
 
     void subscribeToVehicleVariables(std::string vehicleId);
     void unsubscribeFromVehicleVariables(std::string vehicleId);
+    void subscribeToVehicleVariables(TraCIConnection::Batch& batch, std::string vehicleId); /**< queues commands getting static attributes and subscribing to all other attributes in batch, see processBatchResponse */
+    void subscribeToVehicleState(TraCIConnection::Batch& batch, const std::string& vehicleId, simtime_t beginTime); /**< queues command subscribing to the attributes of a vehicle that change while it is driving (starting at beginTime) in batch */
+    bool isVehicleRelevant(TraCIIdTable::Handle handle, const Coord& position, double speed); /**< whether the state of a vehicle matters enough to the network simulation to update it every updateInterval */
+    void updateSubscriptionRate(TraCIIdTable::Handle handle, const Coord& position, double speed); /**< if slowUpdateInterval is set: switches the subscription to a vehicle between full and reduced rate, as needed */
+    void unsubscribeFromVehicleVariables(TraCIConnection::Batch& batch, std::string vehicleId); /**< queues unsubscription command in batch, see processBatchResponse */
+    void processBatchResponse(size_t index, TraCIBuffer& buf); /**< handles the response to a command queued by subscribeToVehicleVariables, unsubscribeFromVehicleVariables, or subscribeToPersonVariables */
+    void processVehicleStaticAttribute(TraCIBuffer& buf); /**< caches a static attribute of a vehicle, as returned by a CMD_GET_VEHICLE_VARIABLE */
     void processSimSubscription(std::string objectId, TraCIBuffer& buf);
-    void processVehicleSubscription(std::string objectId, TraCIBuffer& buf);
+    void processVehicleSubscription(TraCIIdTable::Handle handle, TraCIBuffer& buf);
+    void processVehicleVariables(TraCIIdTable::Handle handle, uint8_t variableNumber, TraCIBuffer& buf);
+    /**
+     * adds, moves, or removes the module of a vehicle (whose static attributes are complete) given its current state
+     *
+     * Takes native values, so it can be fed by any source of vehicle state, not only by TraCI subscription results.
+     */
+    void updateVehicle(TraCIIdTable::Handle handle, const TraCICoord& traciPosition, const Coord& position, const std::string& edge, double speed, Heading heading, VehicleSignalSet signals);
+    size_t processVehicleList(TraCIBuffer& buf); /**< (un)subscribes vehicles so subscriptions match the list of all vehicles, returns the number of vehicles that needed it */
+
+    void queueVehicleSubscription(const TraCIBuffer::StringRef& vehicleId); /**< in departure mode: marks a vehicle to be subscribed to by sendPendingSubscriptions */
+    void queuePersonSubscription(const TraCIBuffer::StringRef& personId); /**< marks a person to be subscribed to by sendPendingSubscriptions */
+    void sendPendingSubscriptions(); /**< sends all queued vehicle and person (un)subscription commands in a single batch */
+    void checkVehicleList(); /**< in departure mode: gets the list of all vehicles, and (un)subscribes vehicles to match it */
+
+    void addPersonModule(TraCIIdTable::Handle handle, std::string type, std::string name, std::string displayString, const Coord& position, std::string road_id, double speed, Heading heading);
+    void deletePersonModule(TraCIIdTable::Handle handle);
+    PersonRecord& getPersonRecord(TraCIIdTable::Handle handle); /**< returns the record of a person, making room for it if necessary */
+    void forgetPersonIfUnused(TraCIIdTable::Handle handle); /**< releases the handle of a person if there is nothing left to keep track of */
+    void subscribeToPersonVariables(TraCIConnection::Batch& batch, std::string personId); /**< queues commands getting the type of and subscribing to all other attributes of a person in batch, see processBatchResponse */
+    void processPersonStaticAttribute(TraCIBuffer& buf); /**< caches the type of a person, as returned by a CMD_GET_PERSON_VARIABLE */
+    void processPersonSubscription(TraCIIdTable::Handle handle, TraCIBuffer& buf);
+
+    void subscribeToVehicleContext(const std::pair<TraCICoord, TraCICoord>& networkBoundaries);
+    void processVehicleContextSubscription(std::string objectId, TraCIBuffer& buf);
+    void removeVehiclesOutsideContext(); /**< removes all vehicles that were not part of the latest context subscription result */
+    void preloadNetworkGeometryCache(); /**< fills the network geometry cache from networkGeometryCacheDir if a matching file was saved there, else by asking the TraCI server (then saving it there) */
     void processSubcriptionResult(TraCIBuffer& buf);
 
     void subscribeToTrafficLightVariables(std::string tlId);
@@ -171,6 +329,11 @@ protected:
      */
     void parseModuleTypes();
 
+    /**
+     * parses the person module types in ini file, leaving them empty if persons are not to be tracked
+     */
+    void parsePersonModuleTypes();
+
     /**
      * transforms a list of mappings of an omnetpp.ini parameter in a list
      */
@@ -26,6 +26,7 @@
 #include <netinet/tcp.h>
 #include <netdb.h>
 #include <arpa/inet.h>
+#include <unistd.h>
 #endif
 
 #include <sstream>
@@ -72,12 +73,17 @@ void TraCIScenarioManagerForker::initialize(int stage)
     if (stage == 1) {
         commandLine = par("commandLine").stringValue();
         configFile = par("configFile").stringValue();
+        socketPath = par("socketPath").stdstringValue();
+        // the default commandLine runs SUMO, which would listen on a TCP port nobody connects to
+        if (!socketPath.empty() && commandLine.find("$socket") == std::string::npos) throw cRuntimeError("socketPath is set, but commandLine \"%s\" does not contain $socket, so the server would not listen on it", commandLine.c_str());
         seed = par("seed");
         killServer();
     }
     TraCIScenarioManager::initialize(stage);
     if (stage == 1) {
-        startServer();
+        if (!socketPath.empty()) host = TraCIConnection::unixSocketPrefix + socketPath;
+        // a replayed session does not need a server
+        if (par("traciReplayFile").stdstringValue().empty()) startServer();
     }
 }
 
@@ -89,8 +95,14 @@ void TraCIScenarioManagerForker::finish()
 
 void TraCIScenarioManagerForker::startServer()
 {
+    if (!socketPath.empty()) {
+#if !(defined(_WIN32) || defined(__WIN32__) || defined(WIN32) || defined(__CYGWIN__) || defined(_WIN64))
+        // remove a socket left behind by an earlier run, so the server can listen on it
+        ::unlink(socketPath.c_str());
+#endif
+    }
     // autoset port, if requested
-    if (port == -1) {
+    else if (port == -1) {
         if (initsocketlibonce() != 0) throw cRuntimeError("Could not init socketlib");
 
         SOCKET sock = ::socket(AF_INET, SOCK_STREAM, 0);
@@ -129,6 +141,7 @@ void TraCIScenarioManagerForker::startServer()
     commandLine = replace(commandLine, "$configFile", configFile);
     commandLine = replace(commandLine, "$seed", seed);
     commandLine = replace(commandLine, "$port", port);
+    commandLine = replace(commandLine, "$socket", socketPath);
 
     server = new TraCILauncher(commandLine);
 }
@@ -50,8 +50,9 @@ public:
     void finish() override;
 
 protected:
-    std::string commandLine; /**< command line for running TraCI server (substituting $configFile, $seed, $port) */
+    std::string commandLine; /**< command line for running TraCI server (substituting $configFile, $seed, $port, $socket) */
     std::string configFile; /**< substitution for $configFile parameter */
+    std::string socketPath; /**< substitution for $socket parameter; if set, connect to the TraCI server via this Unix domain socket instead of TCP */
     int seed; /**< substitution for $seed parameter (-1: current run number) */
 
     TraCILauncher* server;
@@ -0,0 +1,224 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#include "veins/modules/mobility/traci/TraCIScenarioManagerLibsumo.h"
+#include "veins/modules/mobility/traci/TraCIMobility.h"
+
+#ifdef VEINS_LIBSUMO
+#include <libsumo/Simulation.h>
+#include <libsumo/TraCIConstants.h>
+#include <libsumo/Vehicle.h>
+#endif
+
+using Veins::TraCIScenarioManagerLibsumo;
+
+Define_Module(Veins::TraCIScenarioManagerLibsumo);
+
+#ifdef VEINS_LIBSUMO
+namespace {
+
+/**
+ * value of a variable in the subscription results of an object, which libsumo reports as a T
+ */
+template <typename T>
+const T& getSubscriptionResult(const libsumo::TraCIResults& results, int variable)
+{
+    auto result = results.find(variable);
+    if (result == results.end()) throw cRuntimeError("libsumo did not report variable 0x%02x of a subscribed vehicle", variable);
+    return static_cast<const T&>(*result->second);
+}
+
+} // namespace
+#endif
+
+TraCIScenarioManagerLibsumo::TraCIScenarioManagerLibsumo()
+    : simulationLoaded(false)
+{
+}
+
+TraCIScenarioManagerLibsumo::~TraCIScenarioManagerLibsumo()
+{
+    closeSimulation();
+}
+
+void TraCIScenarioManagerLibsumo::initialize(int stage)
+{
+    if (stage == 1) {
+#ifndef VEINS_LIBSUMO
+        throw cRuntimeError("TraCIScenarioManagerLibsumo needs Veins to be configured with --with-libsumo");
+#endif
+        commandLine = par("commandLine").stdstringValue();
+        configFile = par("configFile").stdstringValue();
+        seed = par("seed");
+    }
+    TraCIScenarioManager::initialize(stage);
+    if (stage == 1) {
+        if (!personModuleType.empty()) throw cRuntimeError("TraCIScenarioManagerLibsumo does not support persons (personModuleType must be empty)");
+    }
+}
+
+void TraCIScenarioManagerLibsumo::finish()
+{
+    TraCIScenarioManager::finish();
+    closeSimulation();
+}
+
+void TraCIScenarioManagerLibsumo::handleSelfMsg(cMessage* msg)
+{
+    if (msg == connectAndStartTrigger) {
+        loadSimulation();
+        return;
+    }
+    if (msg == executeOneTimestepTrigger) {
+        stepSimulation();
+        return;
+    }
+    TraCIScenarioManager::handleSelfMsg(msg);
+}
+
+void TraCIScenarioManagerLibsumo::loadSimulation()
+{
+#ifdef VEINS_LIBSUMO
+    // autoset seed, if requested
+    if (seed == -1) {
+        const char* seed_s = cSimulation::getActiveSimulation()->getEnvir()->getConfigEx()->getVariable(CFGVAR_RUNNUMBER);
+        seed = atoi(seed_s);
+    }
+
+    std::vector<std::string> args = cStringTokenizer(commandLine.c_str()).asVector();
+    for (auto& arg : args) {
+        if (arg == "$configFile") arg = configFile;
+        if (arg == "$seed") arg = std::to_string(seed);
+    }
+    EV_DEBUG << "Loading simulation into libsumo" << endl;
+    libsumo::Simulation::load(args);
+    simulationLoaded = true;
+
+    libsumo::TraCIPositionVector boundary = libsumo::Simulation::getNetBoundary();
+    if (boundary.value.size() != 2) error("libsumo reported network boundary of %d points, expected 2", static_cast<int>(boundary.value.size()));
+    coordinateTransformation.reset(new TraCICoordinateTransformation(TraCICoord(boundary.value[0].x, boundary.value[0].y), TraCICoord(boundary.value[1].x, boundary.value[1].y), par("margin")));
+
+    emit(traciInitializedSignal, true);
+#endif
+}
+
+void TraCIScenarioManagerLibsumo::stepSimulation()
+{
+#ifdef VEINS_LIBSUMO
+    simtime_t targetTime = simTime();
+
+    emit(traciTimestepBeginSignal, targetTime);
+
+    libsumo::Simulation::step(targetTime.dbl());
+
+    // vehicles are not part of the list of vehicles after arriving or while teleporting
+    const std::vector<std::string> arrivedIds = libsumo::Simulation::getArrivedIDList();
+    for (const std::string& vehicleId : arrivedIds) {
+        removeVehicle(vehicleId);
+    }
+    for (const std::string& vehicleId : libsumo::Simulation::getStartingTeleportIDList()) {
+        removeVehicle(vehicleId);
+    }
+
+    // subscribe to what changes every step, so all vehicles can be updated from one set of results (libsumo drops subscriptions of vehicles that arrived)
+    const std::set<std::string> arrived(arrivedIds.begin(), arrivedIds.end());
+    for (const std::string& vehicleId : libsumo::Simulation::getDepartedIDList()) {
+        // vehicles can depart and arrive within the same step, after which they cannot be subscribed to
+        if (arrived.count(vehicleId)) continue;
+        libsumo::Vehicle::subscribe(vehicleId, {libsumo::VAR_POSITION, libsumo::VAR_ROAD_ID, libsumo::VAR_SPEED, libsumo::VAR_ANGLE, libsumo::VAR_SIGNALS});
+    }
+
+    const libsumo::SubscriptionResults subscriptionResults = libsumo::Vehicle::getAllSubscriptionResults();
+    activeVehicleCount = 0;
+    for (const auto& vehicleResults : subscriptionResults) {
+        const std::string& vehicleId = vehicleResults.first;
+        const libsumo::TraCIResults& results = vehicleResults.second;
+
+        // vehicles are not on a road while teleporting
+        const std::string& roadId = getSubscriptionResult<libsumo::TraCIString>(results, libsumo::VAR_ROAD_ID).value;
+        if (roadId.empty()) continue;
+        activeVehicleCount++;
+
+        TraCIIdTable::Handle handle = vehicleIds.intern(vehicleId);
+        getVehicleRecord(handle).subscribed = true;
+
+        // get attributes of the vehicle that do not change (once)
+        VehicleStaticAttributes& attributes = getVehicleRecord(handle).attributes;
+        if (!attributes.isComplete()) {
+            attributes.typeId = libsumo::Vehicle::getTypeID(vehicleId);
+            attributes.length = libsumo::Vehicle::getLength(vehicleId);
+            attributes.height = libsumo::Vehicle::getHeight(vehicleId);
+            attributes.width = libsumo::Vehicle::getWidth(vehicleId);
+        }
+
+        const libsumo::TraCIPosition& position = getSubscriptionResult<libsumo::TraCIPosition>(results, libsumo::VAR_POSITION);
+        TraCICoord traciPosition(position.x, position.y);
+        double speed = getSubscriptionResult<libsumo::TraCIDouble>(results, libsumo::VAR_SPEED).value;
+        double angle = getSubscriptionResult<libsumo::TraCIDouble>(results, libsumo::VAR_ANGLE).value;
+        int signals = getSubscriptionResult<libsumo::TraCIInt>(results, libsumo::VAR_SIGNALS).value;
+        updateVehicle(handle, traciPosition, coordinateTransformation->traci2omnet(traciPosition), roadId, speed, coordinateTransformation->traci2omnetHeading(angle), VehicleSignalSet(signals));
+    }
+
+    for (const std::string& vehicleId : libsumo::Simulation::getParkingStartingVehiclesIDList()) {
+        cModule* mod = getManagedModule(vehicleId);
+        if (!mod) continue;
+        for (auto mm : getSubmodulesOfType<TraCIMobility>(mod)) {
+            mm->changeParkingState(true);
+        }
+    }
+    for (const std::string& vehicleId : libsumo::Simulation::getParkingEndingVehiclesIDList()) {
+        cModule* mod = getManagedModule(vehicleId);
+        if (!mod) continue;
+        for (auto mm : getSubmodulesOfType<TraCIMobility>(mod)) {
+            mm->changeParkingState(false);
+        }
+    }
+
+    if (autoShutdown && (libsumo::Simulation::getMinExpectedNumber() == 0)) autoShutdownTriggered = true;
+
+    emit(traciTimestepEndSignal, targetTime);
+
+    if (!autoShutdownTriggered) scheduleAt(simTime() + updateInterval, executeOneTimestepTrigger);
+#endif
+}
+
+void TraCIScenarioManagerLibsumo::removeVehicle(const std::string& vehicleId)
+{
+    TraCIIdTable::Handle handle = vehicleIds.find(vehicleId);
+    if (handle == TraCIIdTable::invalidHandle) return;
+
+    getVehicleRecord(handle).subscribed = false;
+    getVehicleRecord(handle).attributes = VehicleStaticAttributes();
+
+    forgetVehicle(handle);
+}
+
+void TraCIScenarioManagerLibsumo::closeSimulation()
+{
+#ifdef VEINS_LIBSUMO
+    if (!simulationLoaded) return;
+    libsumo::Simulation::close();
+    simulationLoaded = false;
+#endif
+}
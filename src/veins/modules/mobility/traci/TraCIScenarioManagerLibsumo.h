@@ -0,0 +1,65 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <memory>
+
+#include "veins/modules/mobility/traci/TraCIScenarioManager.h"
+#include "veins/modules/mobility/traci/TraCICoordinateTransformation.h"
+
+namespace Veins {
+
+/**
+ * @brief
+ * Runs SUMO in the same process via libsumo, instead of talking to a TraCI server.
+ *
+ * Vehicle states are read by calling into SUMO directly and handed to TraCIScenarioManager::updateVehicle
+ * as native values, so nothing needs to be serialized or sent over a socket.
+ *
+ * Only available if Veins was configured with --with-libsumo (otherwise initialization fails).
+ * As there is no TraCI connection, getCommandInterface() returns nullptr, so no module may use the TraCICommandInterface:
+ * asking for it via TraCIMobility::getCommandInterface or getVehicleCommandInterface fails with an error, which rules out, e.g., DemoBaseApplLayer.
+ * Persons, traffic lights, obstacles, and the vehicleSubscriptionMode of the TraCIScenarioManager are not supported.
+ *
+ * @see TraCIScenarioManager
+ */
+class VEINS_API TraCIScenarioManagerLibsumo : public TraCIScenarioManager {
+public:
+    TraCIScenarioManagerLibsumo();
+    ~TraCIScenarioManagerLibsumo() override;
+    void initialize(int stage) override;
+    void finish() override;
+    void handleSelfMsg(cMessage* msg) override;
+
+protected:
+    std::string commandLine; /**< arguments for loading the simulation (substituting $configFile, $seed) */
+    std::string configFile; /**< substitution for $configFile parameter */
+    int seed; /**< substitution for $seed parameter (-1: current run number) */
+    bool simulationLoaded; /**< whether the simulation has been loaded into libsumo (and not yet closed) */
+    std::unique_ptr<TraCICoordinateTransformation> coordinateTransformation;
+
+    virtual void loadSimulation();
+    virtual void stepSimulation(); /**< counterpart of TraCIScenarioManager::executeOneTimestep */
+    void removeVehicle(const std::string& vehicleId); /**< removes the module of a vehicle that left the simulation, and forgets the vehicle */
+    void closeSimulation();
+};
+
+} // namespace Veins
@@ -0,0 +1,314 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32) || defined(__CYGWIN__) || defined(_WIN64)
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#include "veins/modules/mobility/traci/TraCIScenarioManagerTrace.h"
+
+using Veins::TraCIScenarioManagerTrace;
+
+Define_Module(Veins::TraCIScenarioManagerTrace);
+
+namespace {
+
+/**
+ * header of a binary mobility trace (version 1), as written by fcd2trace.py
+ *
+ * All values are stored in little endian byte order, all offsets are counted from the start of the file.
+ * The header is followed by the data of all timesteps, then by the tables it points to:
+ * - the vehicle table: vehicleCount records of TraceVehicleRecord
+ * - the edge table: edgeCount offsets (uint32_t) of edge names into the string table
+ * - the string table: stringsSize bytes of NUL-terminated strings
+ * - the timestep table: stepCount records of TraceStepRecord
+ * The data of each timestep holds its vehicles column by column, each column starting at a multiple of 8 bytes:
+ * x, y, angle, speed (double, in SUMO coordinates and degrees), then vehicle and edge (uint32_t, indices into their tables).
+ */
+struct TraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    double netBoundary[4];
+    uint32_t vehicleCount;
+    uint32_t edgeCount;
+    uint32_t stepCount;
+    uint32_t reserved;
+    uint64_t vehicleTableOffset;
+    uint64_t edgeTableOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t stepTableOffset;
+};
+
+struct TraceVehicleRecord {
+    double length;
+    double width;
+    double height;
+    uint32_t idOffset;
+    uint32_t typeOffset;
+};
+
+struct TraceStepRecord {
+    double time;
+    uint32_t count;
+    uint32_t reserved;
+    uint64_t dataOffset;
+};
+
+static_assert(sizeof(TraceHeader) == 104, "unexpected padding of TraceHeader");
+static_assert(sizeof(TraceVehicleRecord) == 32, "unexpected padding of TraceVehicleRecord");
+static_assert(sizeof(TraceStepRecord) == 24, "unexpected padding of TraceStepRecord");
+
+const char traceMagic[8] = {'V', 'E', 'I', 'N', 'S', 'T', 'R', 'C'};
+const uint32_t traceVersion = 1;
+const uint32_t traceByteOrderMark = 0x01020304;
+
+} // namespace
+
+TraCIScenarioManagerTrace::MappedFile::MappedFile(const std::string& fileName)
+    : contents(nullptr)
+    , length(0)
+{
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32) || defined(__CYGWIN__) || defined(_WIN64)
+    std::ifstream in(fileName, std::ios::in | std::ios::binary);
+    if (!in.is_open()) throw cRuntimeError("Could not open trace file \"%s\"", fileName.c_str());
+    copy.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    contents = copy.data();
+    length = copy.size();
+#else
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd == -1) throw cRuntimeError("Could not open trace file \"%s\": %s", fileName.c_str(), strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        throw cRuntimeError("Could not read trace file \"%s\": %s", fileName.c_str(), strerror(errno));
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length > 0) {
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw cRuntimeError("Could not map trace file \"%s\": %s", fileName.c_str(), strerror(errno));
+        }
+        contents = static_cast<const uint8_t*>(mapped);
+        // timesteps are played back in order
+        madvise(mapped, length, MADV_SEQUENTIAL);
+    }
+    close(fd);
+#endif
+}
+
+TraCIScenarioManagerTrace::MappedFile::~MappedFile()
+{
+#if !(defined(_WIN32) || defined(__WIN32__) || defined(WIN32) || defined(__CYGWIN__) || defined(_WIN64))
+    if (contents) munmap(const_cast<uint8_t*>(contents), length);
+#endif
+}
+
+TraCIScenarioManagerTrace::TraCIScenarioManagerTrace()
+    : nextStep(0)
+    , currentStep(nullptr)
+{
+}
+
+TraCIScenarioManagerTrace::~TraCIScenarioManagerTrace()
+{
+}
+
+void TraCIScenarioManagerTrace::initialize(int stage)
+{
+    if (stage == 1) {
+        traceFile = par("traceFile").stdstringValue();
+    }
+    TraCIScenarioManager::initialize(stage);
+    if (stage == 1) {
+        if (!personModuleType.empty()) throw cRuntimeError("TraCIScenarioManagerTrace does not support persons (personModuleType must be empty)");
+    }
+}
+
+void TraCIScenarioManagerTrace::finish()
+{
+    TraCIScenarioManager::finish();
+    currentStep = nullptr;
+    traceSteps.clear();
+    trace.reset();
+}
+
+void TraCIScenarioManagerTrace::handleSelfMsg(cMessage* msg)
+{
+    if (msg == connectAndStartTrigger) {
+        loadTrace();
+        return;
+    }
+    if (msg == executeOneTimestepTrigger) {
+        playbackStep();
+        return;
+    }
+    TraCIScenarioManager::handleSelfMsg(msg);
+}
+
+void TraCIScenarioManagerTrace::loadTrace()
+{
+    EV_DEBUG << "Loading trace from " << traceFile << endl;
+    trace.reset(new MappedFile(traceFile));
+    const uint8_t* data = trace->data();
+    size_t size = trace->size();
+
+    // checks that [offset, offset + count * itemSize) lies within the file, and is aligned to alignment
+    auto checkRange = [&](uint64_t offset, uint64_t count, size_t itemSize, size_t alignment, const char* what) {
+        if ((offset > size) || (count > (size - offset) / itemSize) || (offset % alignment != 0)) throw cRuntimeError("Trace file \"%s\" is corrupt: bad %s", traceFile.c_str(), what);
+    };
+
+    TraceHeader header;
+    if (size < sizeof(header)) throw cRuntimeError("Trace file \"%s\" is too short", traceFile.c_str());
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, traceMagic, sizeof(traceMagic)) != 0) throw cRuntimeError("File \"%s\" is not a mobility trace", traceFile.c_str());
+    if (header.version != traceVersion) throw cRuntimeError("Trace file \"%s\" has unsupported version %u (expected %u)", traceFile.c_str(), header.version, traceVersion);
+    if (header.byteOrderMark != traceByteOrderMark) throw cRuntimeError("Trace file \"%s\" uses a different byte order than this machine", traceFile.c_str());
+
+    checkRange(header.stringsOffset, header.stringsSize, 1, 1, "string table");
+    const char* strings = reinterpret_cast<const char*>(data + header.stringsOffset);
+    if ((header.stringsSize == 0) || (strings[header.stringsSize - 1] != '\0')) throw cRuntimeError("Trace file \"%s\" is corrupt: bad string table", traceFile.c_str());
+    auto getString = [&](uint32_t offset) {
+        if (offset >= header.stringsSize) throw cRuntimeError("Trace file \"%s\" is corrupt: bad string offset", traceFile.c_str());
+        return std::string(strings + offset);
+    };
+
+    checkRange(header.vehicleTableOffset, header.vehicleCount, sizeof(TraceVehicleRecord), 1, "vehicle table");
+    traceVehicles.resize(header.vehicleCount);
+    for (uint32_t i = 0; i < header.vehicleCount; ++i) {
+        TraceVehicleRecord record;
+        std::memcpy(&record, data + header.vehicleTableOffset + i * sizeof(record), sizeof(record));
+        TraceVehicle& vehicle = traceVehicles[i];
+        vehicle.id = getString(record.idOffset);
+        vehicle.attributes.typeId = getString(record.typeOffset);
+        vehicle.attributes.length = record.length;
+        vehicle.attributes.width = record.width;
+        vehicle.attributes.height = record.height;
+    }
+
+    checkRange(header.edgeTableOffset, header.edgeCount, sizeof(uint32_t), 1, "edge table");
+    traceEdges.resize(header.edgeCount);
+    for (uint32_t i = 0; i < header.edgeCount; ++i) {
+        uint32_t offset;
+        std::memcpy(&offset, data + header.edgeTableOffset + i * sizeof(offset), sizeof(offset));
+        traceEdges[i] = getString(offset);
+    }
+
+    checkRange(header.stepTableOffset, header.stepCount, sizeof(TraceStepRecord), 1, "timestep table");
+    traceSteps.resize(header.stepCount);
+    for (uint32_t i = 0; i < header.stepCount; ++i) {
+        TraceStepRecord record;
+        std::memcpy(&record, data + header.stepTableOffset + i * sizeof(record), sizeof(record));
+        checkRange(record.dataOffset, record.count, 4 * sizeof(double) + 2 * sizeof(uint32_t), sizeof(double), "timestep data");
+        TraceStep& step = traceSteps[i];
+        step.time = record.time;
+        step.count = record.count;
+        const double* doubles = reinterpret_cast<const double*>(data + record.dataOffset);
+        step.x = doubles;
+        step.y = doubles + record.count;
+        step.angle = doubles + 2 * record.count;
+        step.speed = doubles + 3 * record.count;
+        step.vehicle = reinterpret_cast<const uint32_t*>(doubles + 4 * record.count);
+        step.edge = step.vehicle + record.count;
+        if ((i > 0) && (step.time <= traceSteps[i - 1].time)) throw cRuntimeError("Trace file \"%s\" is corrupt: timesteps out of order", traceFile.c_str());
+    }
+    nextStep = 0;
+    currentStep = nullptr;
+
+    coordinateTransformation.reset(new TraCICoordinateTransformation(TraCICoord(header.netBoundary[0], header.netBoundary[1]), TraCICoord(header.netBoundary[2], header.netBoundary[3]), par("margin").doubleValue()));
+
+    EV_DEBUG << "Loaded trace of " << traceVehicles.size() << " vehicles in " << traceSteps.size() << " timesteps" << endl;
+
+    emit(traciInitializedSignal, true);
+}
+
+void TraCIScenarioManagerTrace::playbackStep()
+{
+    simtime_t targetTime = simTime();
+
+    emit(traciTimestepBeginSignal, targetTime);
+
+    // skip to the most recent timestep of the trace (if the trace is more fine grained than updateInterval)
+    const TraceStep* step = nullptr;
+    while ((nextStep < traceSteps.size()) && (traceSteps[nextStep].time <= targetTime)) {
+        step = &traceSteps[nextStep++];
+    }
+
+    if (step) {
+        size_t stepMark = nextStep;
+        for (uint32_t i = 0; i < step->count; ++i) {
+            if (step->vehicle[i] >= traceVehicles.size()) throw cRuntimeError("Trace file \"%s\" is corrupt: bad vehicle index", traceFile.c_str());
+            traceVehicles[step->vehicle[i]].lastStep = stepMark;
+        }
+
+        // vehicles are not part of a timestep after arriving or while teleporting
+        if (currentStep) {
+            for (uint32_t i = 0; i < currentStep->count; ++i) {
+                TraceVehicle& vehicle = traceVehicles[currentStep->vehicle[i]];
+                if (vehicle.lastStep != stepMark) removeVehicle(vehicle);
+            }
+        }
+
+        for (uint32_t i = 0; i < step->count; ++i) {
+            TraceVehicle& vehicle = traceVehicles[step->vehicle[i]];
+            if (step->edge[i] >= traceEdges.size()) throw cRuntimeError("Trace file \"%s\" is corrupt: bad edge index", traceFile.c_str());
+
+            if (vehicle.handle == TraCIIdTable::invalidHandle) {
+                vehicle.handle = vehicleIds.intern(vehicle.id);
+                getVehicleRecord(vehicle.handle).subscribed = true;
+                getVehicleRecord(vehicle.handle).attributes = vehicle.attributes;
+            }
+
+            TraCICoord traciPosition(step->x[i], step->y[i]);
+            updateVehicle(vehicle.handle, traciPosition, coordinateTransformation->traci2omnet(traciPosition), traceEdges[step->edge[i]], step->speed[i], coordinateTransformation->traci2omnetHeading(step->angle[i]), VehicleSignalSet());
+        }
+        currentStep = step;
+        activeVehicleCount = step->count;
+    }
+
+    if (autoShutdown && (nextStep == traceSteps.size())) autoShutdownTriggered = true;
+
+    emit(traciTimestepEndSignal, targetTime);
+
+    if (!autoShutdownTriggered) scheduleAt(simTime() + updateInterval, executeOneTimestepTrigger);
+}
+
+void TraCIScenarioManagerTrace::removeVehicle(TraceVehicle& vehicle)
+{
+    TraCIIdTable::Handle handle = vehicle.handle;
+    if (handle == TraCIIdTable::invalidHandle) return;
+
+    getVehicleRecord(handle).subscribed = false;
+    getVehicleRecord(handle).attributes = VehicleStaticAttributes();
+
+    forgetVehicle(handle);
+    vehicle.handle = TraCIIdTable::invalidHandle;
+}
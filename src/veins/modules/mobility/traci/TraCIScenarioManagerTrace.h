@@ -0,0 +1,119 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "veins/modules/mobility/traci/TraCIScenarioManager.h"
+#include "veins/modules/mobility/traci/TraCICoordinateTransformation.h"
+
+namespace Veins {
+
+/**
+ * @brief
+ * Plays back a binary mobility trace, instead of talking to a TraCI server.
+ *
+ * The trace is mapped into memory and holds, for each timestep, the position, heading, speed, and edge of every vehicle,
+ * stored column by column (see fcd2trace.py, which converts SUMO FCD output to such a trace).
+ * At every update, the most recent timestep of the trace is handed to TraCIScenarioManager::updateVehicle,
+ * so modules are created, moved, and deleted just as if the trace was being received from SUMO.
+ *
+ * As there is no TraCI connection, getCommandInterface() returns nullptr, so no module may use the TraCICommandInterface:
+ * asking for it via TraCIMobility::getCommandInterface or getVehicleCommandInterface fails with an error, which rules out, e.g., DemoBaseApplLayer.
+ * Persons, traffic lights, obstacles, and the vehicleSubscriptionMode of the TraCIScenarioManager are not supported.
+ *
+ * @see TraCIScenarioManager
+ */
+class VEINS_API TraCIScenarioManagerTrace : public TraCIScenarioManager {
+public:
+    TraCIScenarioManagerTrace();
+    ~TraCIScenarioManagerTrace() override;
+    void initialize(int stage) override;
+    void finish() override;
+    void handleSelfMsg(cMessage* msg) override;
+
+protected:
+    /**
+     * read-only view of a file's contents, memory mapped where available
+     */
+    class MappedFile {
+    public:
+        MappedFile(const std::string& fileName);
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const uint8_t* data() const
+        {
+            return contents;
+        }
+
+        size_t size() const
+        {
+            return length;
+        }
+
+    private:
+        const uint8_t* contents;
+        size_t length;
+        std::vector<uint8_t> copy; /**< contents, if the file could not be mapped */
+    };
+
+    /**
+     * one vehicle of the trace
+     */
+    struct TraceVehicle {
+        std::string id;
+        TraCIIdTable::Handle handle = TraCIIdTable::invalidHandle; /**< handle of the vehicle's id in vehicleIds while it is part of the simulation */
+        VehicleStaticAttributes attributes;
+        size_t lastStep = 0; /**< 1 + index of the last timestep played back the vehicle was part of (0: none) */
+    };
+
+    /**
+     * one timestep of the trace, pointing into the mapped file
+     */
+    struct TraceStep {
+        simtime_t time;
+        uint32_t count; /**< number of vehicles in this timestep */
+        const double* x;
+        const double* y;
+        const double* angle; /**< heading in SUMO degrees */
+        const double* speed;
+        const uint32_t* vehicle; /**< index into traceVehicles */
+        const uint32_t* edge; /**< index into traceEdges */
+    };
+
+    std::string traceFile; /**< file name of the trace */
+    std::unique_ptr<MappedFile> trace;
+    std::vector<TraceVehicle> traceVehicles;
+    std::vector<std::string> traceEdges;
+    std::vector<TraceStep> traceSteps;
+    size_t nextStep; /**< index of the first timestep of the trace that has not been played back yet */
+    const TraceStep* currentStep; /**< timestep played back last, if any */
+    std::unique_ptr<TraCICoordinateTransformation> coordinateTransformation;
+
+    virtual void loadTrace();
+    virtual void playbackStep(); /**< counterpart of TraCIScenarioManager::executeOneTimestep */
+    void removeVehicle(TraceVehicle& vehicle); /**< removes the module of a vehicle that left the trace */
+};
+
+} // namespace Veins
@@ -0,0 +1,144 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "veins/modules/mobility/traci/TraCIStatistics.h"
+
+using Veins::TraCIStatistics;
+
+const size_t TraCIStatistics::Histogram::bucketCount;
+const size_t TraCIStatistics::phaseCount;
+
+void TraCIStatistics::Histogram::record(Clock::duration duration)
+{
+    count++;
+    sum += duration;
+    if (duration > max) max = duration;
+
+    double us = std::chrono::duration<double, std::micro>(duration).count();
+    size_t bucket = 0;
+    if (us >= 1) bucket = std::min(bucketCount - 1, static_cast<size_t>(std::floor(std::log2(us))) + 1);
+    buckets[bucket]++;
+}
+
+double TraCIStatistics::Histogram::getBucketLimit(size_t i)
+{
+    return std::ldexp(1e-6, static_cast<int>(i));
+}
+
+double TraCIStatistics::Histogram::getQuantile(double q) const
+{
+    if (count == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) return std::min(getBucketLimit(i), getMax());
+    }
+    return getMax();
+}
+
+const char* TraCIStatistics::getPhaseName(Phase phase)
+{
+    switch (phase) {
+    case Phase::timestep:
+        return "timestep";
+    case Phase::parse:
+        return "parse";
+    case Phase::addModule:
+        return "addModule";
+    case Phase::deleteModule:
+        return "deleteModule";
+    }
+    return "unknown";
+}
+
+TraCIStatistics::TraCIStatistics()
+    : created(Clock::now())
+{
+}
+
+double TraCIStatistics::getElapsed() const
+{
+    return std::chrono::duration<double>(Clock::now() - created).count();
+}
+
+void TraCIStatistics::writeCsvHeader(std::ostream& out)
+{
+    out << "simTime,wallTime,messagesSent,messagesReceived,bytesSent,bytesReceived,waitTime";
+    for (size_t i = 0; i < phaseCount; ++i) out << "," << getPhaseName(static_cast<Phase>(i)) << "Time";
+    out << "\n";
+}
+
+void TraCIStatistics::writeCsvRow(std::ostream& out, double simTime) const
+{
+    out << simTime << "," << getElapsed() << "," << messagesSent << "," << messagesReceived << "," << bytesSent << "," << bytesReceived << "," << wait.getSum();
+    for (auto& phase : phases) out << "," << phase.getSum();
+    out << "\n";
+}
+
+namespace {
+
+void writeJsonHistogram(std::ostream& out, const TraCIStatistics::Histogram& histogram)
+{
+    out << "{\"count\":" << histogram.getCount() << ",\"sum\":" << histogram.getSum() << ",\"max\":" << histogram.getMax() << ",\"buckets\":[";
+    // omit trailing empty buckets
+    size_t end = TraCIStatistics::Histogram::bucketCount;
+    while ((end > 0) && (histogram.getBucket(end - 1) == 0)) end--;
+    for (size_t i = 0; i < end; ++i) out << ((i > 0) ? "," : "") << histogram.getBucket(i);
+    out << "]}";
+}
+
+void writeJsonCommand(std::ostream& out, const TraCIStatistics::CommandStatistics& command)
+{
+    out << "{\"count\":" << command.count << ",\"bytesSent\":" << command.bytesSent << ",\"bytesReceived\":" << command.bytesReceived << ",\"roundTrip\":";
+    writeJsonHistogram(out, command.roundTrip);
+    out << "}";
+}
+
+} // namespace
+
+void TraCIStatistics::writeJson(std::ostream& out, double simTime) const
+{
+    out << "{\"simTime\":" << simTime << ",\"wallTime\":" << getElapsed();
+    out << ",\"messagesSent\":" << messagesSent << ",\"messagesReceived\":" << messagesReceived << ",\"bytesSent\":" << bytesSent << ",\"bytesReceived\":" << bytesReceived;
+    out << ",\"wait\":";
+    writeJsonHistogram(out, wait);
+    for (size_t i = 0; i < phaseCount; ++i) {
+        out << ",\"" << getPhaseName(static_cast<Phase>(i)) << "\":";
+        writeJsonHistogram(out, phases[i]);
+    }
+    out << ",\"batches\":";
+    writeJsonCommand(out, batches);
+    out << ",\"commands\":{";
+    bool first = true;
+    for (size_t i = 0; i < commands.size(); ++i) {
+        if (commands[i].count == 0) continue;
+        char id[8];
+        std::snprintf(id, sizeof(id), "0x%02x", static_cast<unsigned>(i));
+        out << (first ? "" : ",") << "\"" << id << "\":";
+        writeJsonCommand(out, commands[i]);
+        first = false;
+    }
+    out << "}}\n";
+}
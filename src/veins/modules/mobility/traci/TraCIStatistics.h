@@ -0,0 +1,249 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#include "veins/veins.h"
+
+namespace Veins {
+
+/**
+ * Counts TraCI commands, the bytes exchanged with the TraCI server, and the wall-clock time spent waiting for it or processing its results.
+ *
+ * Kept by TraCIConnection (if enabled via TraCIConnection::enableStatistics) and added to by TraCIScenarioManager.
+ */
+class VEINS_API TraCIStatistics {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * histogram of wall-clock durations, in buckets that double in width: bucket 0 holds durations below 1 us, bucket i those from 2^(i-1) us up to 2^i us
+     */
+    class VEINS_API Histogram {
+    public:
+        static const size_t bucketCount = 32;
+
+        void record(Clock::duration duration);
+
+        uint64_t getCount() const
+        {
+            return count;
+        }
+
+        /**
+         * sum of all durations, in seconds
+         */
+        double getSum() const
+        {
+            return std::chrono::duration<double>(sum).count();
+        }
+
+        double getMean() const
+        {
+            return (count > 0) ? (getSum() / count) : 0;
+        }
+
+        double getMax() const
+        {
+            return std::chrono::duration<double>(max).count();
+        }
+
+        uint64_t getBucket(size_t i) const
+        {
+            return buckets[i];
+        }
+
+        /**
+         * upper limit of durations in bucket i, in seconds
+         */
+        static double getBucketLimit(size_t i);
+
+        /**
+         * estimates the q-quantile (e.g., 0.99) of all durations as the upper limit of the bucket it falls into, in seconds
+         */
+        double getQuantile(double q) const;
+
+    private:
+        uint64_t count = 0;
+        Clock::duration sum = Clock::duration::zero();
+        Clock::duration max = Clock::duration::zero();
+        std::array<uint64_t, bucketCount> buckets{};
+    };
+
+    /**
+     * records the time from its construction to its destruction in a histogram (if not nullptr)
+     */
+    class VEINS_API ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram* histogram)
+            : histogram(histogram)
+            , start(histogram ? Clock::now() : Clock::time_point())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            if (histogram) histogram->record(Clock::now() - start);
+        }
+
+    private:
+        Histogram* histogram;
+        Clock::time_point start;
+    };
+
+    /**
+     * statistics of one kind of TraCI command (or of all batches of commands)
+     */
+    struct CommandStatistics {
+        uint64_t count = 0; /**< number of commands sent (including those sent as part of a batch) */
+        uint64_t bytesSent = 0; /**< size of messages sent on their own (not as part of a batch) */
+        uint64_t bytesReceived = 0; /**< size of responses to messages sent on their own */
+        Histogram roundTrip; /**< time from sending a message to having received the response */
+    };
+
+    /**
+     * what TraCIScenarioManager spends time on
+     */
+    enum class Phase {
+        timestep, /**< all of executeOneTimestep */
+        parse, /**< processing subscription results (including adding, updating, and deleting modules) */
+        addModule,
+        deleteModule,
+    };
+    static const size_t phaseCount = 4;
+    static const char* getPhaseName(Phase phase);
+
+    TraCIStatistics();
+
+    CommandStatistics& getCommand(uint8_t commandId)
+    {
+        return commands[commandId];
+    }
+
+    const CommandStatistics& getCommand(uint8_t commandId) const
+    {
+        return commands[commandId];
+    }
+
+    CommandStatistics& getBatches()
+    {
+        return batches;
+    }
+
+    const CommandStatistics& getBatches() const
+    {
+        return batches;
+    }
+
+    /**
+     * time spent blocked receiving messages from the TraCI server
+     */
+    Histogram& getWait()
+    {
+        return wait;
+    }
+
+    const Histogram& getWait() const
+    {
+        return wait;
+    }
+
+    Histogram& getPhase(Phase phase)
+    {
+        return phases[static_cast<size_t>(phase)];
+    }
+
+    const Histogram& getPhase(Phase phase) const
+    {
+        return phases[static_cast<size_t>(phase)];
+    }
+
+    void recordSent(size_t bytes)
+    {
+        messagesSent++;
+        bytesSent += bytes;
+    }
+
+    void recordReceived(size_t bytes)
+    {
+        messagesReceived++;
+        bytesReceived += bytes;
+    }
+
+    uint64_t getMessagesSent() const
+    {
+        return messagesSent;
+    }
+
+    uint64_t getMessagesReceived() const
+    {
+        return messagesReceived;
+    }
+
+    uint64_t getBytesSent() const
+    {
+        return bytesSent;
+    }
+
+    uint64_t getBytesReceived() const
+    {
+        return bytesReceived;
+    }
+
+    /**
+     * wall-clock time since the statistics were created, in seconds
+     */
+    double getElapsed() const;
+
+    /**
+     * writes the names of the columns written by writeCsvRow
+     */
+    static void writeCsvHeader(std::ostream& out);
+
+    /**
+     * writes totals (but not statistics of single commands) as one line of comma-separated values
+     * @param simTime: simulation time to write in the first column
+     */
+    void writeCsvRow(std::ostream& out, double simTime) const;
+
+    /**
+     * writes everything, including histograms, as one line of JSON
+     * @param simTime: simulation time to write along
+     */
+    void writeJson(std::ostream& out, double simTime) const;
+
+private:
+    Clock::time_point created;
+    std::array<CommandStatistics, 256> commands;
+    CommandStatistics batches;
+    Histogram wait;
+    std::array<Histogram, phaseCount> phases;
+    uint64_t messagesSent = 0;
+    uint64_t messagesReceived = 0;
+    uint64_t bytesSent = 0;
+    uint64_t bytesReceived = 0;
+};
+
+} // namespace Veins
@@ -21,9 +21,15 @@
 #include <sstream>
 #include <map>
 #include <set>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <exception>
 
 #include "veins/modules/obstacle/ObstacleControl.h"
 
+using Veins::Coord;
+using Veins::Obstacle;
 using Veins::ObstacleControl;
 
 Define_Module(Veins::ObstacleControl);
@@ -37,11 +43,30 @@ void ObstacleControl::initialize(int stage)
     if (stage == 1) {
         obstacles.clear();
         cacheEntries.clear();
+        transmissionAttenuations.clear();
 
         annotations = AnnotationManagerAccess().getIfExists();
         if (annotations) annotationGroup = annotations->createGroup("obstacles");
 
         obstaclesXml = par("obstacles");
+        annotateInCmdenv = par("annotateInCmdenv");
+
+        int numThreads = par("numThreads");
+        if (numThreads < 1) throw cRuntimeError("numThreads must be at least 1");
+        threadPool.reset(numThreads > 1 ? new ThreadPool(numThreads) : nullptr);
+        int minBatch = par("minParallelBatchSize");
+        minParallelBatchSize = std::max(1, minBatch);
+
+        simplificationTolerance = par("simplificationTolerance");
+        mergeAdjacentObstacles = par("mergeAdjacentObstacles");
+        simplificationCheckSamples = par("simplificationCheckSamples");
+        statsObstaclesBefore = 0;
+        statsObstaclesAfter = 0;
+        statsVerticesBefore = 0;
+        statsVerticesAfter = 0;
+        statsMaxAttenuationErrorDb = 0;
+        statsSumAttenuationErrorDb = 0;
+        statsAttenuationErrorSamples = 0;
 
         addFromXml(obstaclesXml);
     }
@@ -49,8 +74,20 @@ void ObstacleControl::initialize(int stage)
 
 void ObstacleControl::finish()
 {
+    if ((simplificationTolerance > 0) || mergeAdjacentObstacles) {
+        recordScalar("obstaclesBeforeSimplification", statsObstaclesBefore);
+        recordScalar("obstaclesAfterSimplification", statsObstaclesAfter);
+        recordScalar("obstacleVerticesBeforeSimplification", statsVerticesBefore);
+        recordScalar("obstacleVerticesAfterSimplification", statsVerticesAfter);
+        if (statsAttenuationErrorSamples > 0) {
+            recordScalar("simplificationMaxAttenuationErrorDb", statsMaxAttenuationErrorDb);
+            recordScalar("simplificationMeanAttenuationErrorDb", statsSumAttenuationErrorDb / statsAttenuationErrorSamples);
+        }
+    }
+
     obstacleOwner.clear();
     obstacles.clear();
+    threadPool.reset();
 }
 
 void ObstacleControl::handleMessage(cMessage* msg)
@@ -74,6 +111,8 @@ void ObstacleControl::addFromXml(cXMLElement* xml)
         throw cRuntimeError("Obstacle definition root tag was \"%s\", but expected \"obstacles\"", rootTag.c_str());
     }
 
+    std::vector<Obstacle> toAdd;
+
     cXMLElementList list = xml->getChildren();
     for (cXMLElementList::const_iterator i = list.begin(); i != list.end(); ++i) {
         cXMLElement* e = *i;
@@ -117,12 +156,14 @@ void ObstacleControl::addFromXml(cXMLElement* xml)
                 sh.push_back(Coord(xya[0], xya[1]));
             }
             obs.setShape(sh);
-            add(obs);
+            toAdd.push_back(std::move(obs));
         }
         else {
             throw cRuntimeError("Found unknown tag in obstacle definition: \"%s\"", tag.c_str());
         }
     }
+
+    addAll(std::move(toAdd));
 }
 
 void ObstacleControl::addFromTypeAndShape(std::string id, std::string typeId, std::vector<Coord> shape)
@@ -137,25 +178,340 @@ void ObstacleControl::addFromTypeAndShape(std::string id, std::string typeId, st
 
 void ObstacleControl::add(Obstacle obstacle)
 {
-    Obstacle* o = new Obstacle(obstacle);
-    obstacleOwner.emplace_back(o);
-
-    size_t fromRow = std::max(0, int(o->getBboxP1().x / GRIDCELL_SIZE));
-    size_t toRow = std::max(0, int(o->getBboxP2().x / GRIDCELL_SIZE));
-    size_t fromCol = std::max(0, int(o->getBboxP1().y / GRIDCELL_SIZE));
-    size_t toCol = std::max(0, int(o->getBboxP2().y / GRIDCELL_SIZE));
-    for (size_t row = fromRow; row <= toRow; ++row) {
+    addAll(std::vector<Obstacle>{std::move(obstacle)});
+}
+
+void ObstacleControl::addAll(std::vector<Obstacle> toAdd)
+{
+    if (toAdd.empty()) return;
+
+    simplifyObstacles(toAdd);
+
+    std::vector<Obstacle*> added;
+    added.reserve(toAdd.size());
+    obstacleOwner.reserve(obstacleOwner.size() + toAdd.size());
+    for (auto& obstacle : toAdd) {
+        Obstacle* o = new Obstacle(std::move(obstacle));
+        obstacleOwner.emplace_back(o);
+        added.push_back(o);
+    }
+
+    // size the grid once for the whole batch
+    std::vector<size_t> rowsNeeded(obstacles.size(), 0);
+    for (size_t col = 0; col < obstacles.size(); ++col) rowsNeeded[col] = obstacles[col].size();
+    for (auto o : added) {
+        size_t toRow = std::max(0, int(o->getBboxP2().x / GRIDCELL_SIZE));
+        size_t toCol = std::max(0, int(o->getBboxP2().y / GRIDCELL_SIZE));
+        if (rowsNeeded.size() < toCol + 1) rowsNeeded.resize(toCol + 1, 0);
+        size_t fromCol = std::max(0, int(o->getBboxP1().y / GRIDCELL_SIZE));
         for (size_t col = fromCol; col <= toCol; ++col) {
-            if (obstacles.size() < col + 1) obstacles.resize(col + 1);
-            if (obstacles[col].size() < row + 1) obstacles[col].resize(row + 1);
-            (obstacles[col])[row].push_back(o);
+            rowsNeeded[col] = std::max(rowsNeeded[col], toRow + 1);
+        }
+    }
+    if (obstacles.size() < rowsNeeded.size()) obstacles.resize(rowsNeeded.size());
+    for (size_t col = 0; col < rowsNeeded.size(); ++col) {
+        if (obstacles[col].size() < rowsNeeded[col]) obstacles[col].resize(rowsNeeded[col]);
+    }
+
+    for (auto o : added) {
+        size_t fromRow = std::max(0, int(o->getBboxP1().x / GRIDCELL_SIZE));
+        size_t toRow = std::max(0, int(o->getBboxP2().x / GRIDCELL_SIZE));
+        size_t fromCol = std::max(0, int(o->getBboxP1().y / GRIDCELL_SIZE));
+        size_t toCol = std::max(0, int(o->getBboxP2().y / GRIDCELL_SIZE));
+        for (size_t row = fromRow; row <= toRow; ++row) {
+            for (size_t col = fromCol; col <= toCol; ++col) {
+                (obstacles[col])[row].push_back(o);
+            }
         }
     }
 
     // visualize using AnnotationManager
-    if (annotations) o->visualRepresentation = annotations->drawPolygon(o->getShape(), "red", annotationGroup);
+    if (annotations && (hasGUI() || annotateInCmdenv)) {
+        std::vector<std::vector<Coord>> shapes;
+        shapes.reserve(added.size());
+        for (auto o : added) shapes.push_back(o->getShape());
+        std::vector<AnnotationManager::Polygon*> polygons = annotations->drawPolygons(shapes, "red", annotationGroup);
+        ASSERT(polygons.size() == added.size());
+        for (size_t i = 0; i < added.size(); ++i) added[i]->visualRepresentation = polygons[i];
+    }
 
     cacheEntries.clear();
+    transmissionAttenuations.clear();
+}
+
+namespace {
+
+double distanceToSegment(const Coord& p, const Coord& a, const Coord& b)
+{
+    double dx = b.x - a.x;
+    double dy = b.y - a.y;
+    double len2 = dx * dx + dy * dy;
+    double t = (len2 > 0) ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2 : 0;
+    t = std::max(0.0, std::min(1.0, t));
+    double ex = a.x + t * dx - p.x;
+    double ey = a.y + t * dy - p.y;
+    return sqrt(ex * ex + ey * ey);
+}
+
+double signedArea(const Obstacle::Coords& shape)
+{
+    double area = 0;
+    for (size_t i = 0, j = shape.size() - 1; i < shape.size(); j = i++) {
+        area += (shape[j].x * shape[i].y) - (shape[i].x * shape[j].y);
+    }
+    return area / 2;
+}
+
+/**
+ * remove duplicate vertices (including a closing vertex that repeats the first one) and spikes (a-b-a)
+ */
+Obstacle::Coords cleanShape(Obstacle::Coords shape)
+{
+    bool changed = true;
+    while (changed && (shape.size() >= 3)) {
+        changed = false;
+        for (size_t i = 0; i < shape.size(); ++i) {
+            size_t next = (i + 1) % shape.size();
+            if (shape[i] == shape[next]) {
+                shape.erase(shape.begin() + std::max(i, next));
+                changed = true;
+                break;
+            }
+            size_t prev = (i + shape.size() - 1) % shape.size();
+            if (shape[prev] == shape[next]) {
+                // drop the tip of the spike and one copy of its base
+                shape.erase(shape.begin() + std::max(i, next));
+                shape.erase(shape.begin() + std::min(i, next));
+                changed = true;
+                break;
+            }
+        }
+    }
+    return shape;
+}
+
+bool hasDuplicateVertices(const Obstacle::Coords& shape)
+{
+    for (size_t i = 0; i < shape.size(); ++i) {
+        for (size_t j = i + 1; j < shape.size(); ++j) {
+            if (shape[i] == shape[j]) return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * mark vertices of the open polyline shape[from..to] to keep, recursing via an explicit stack
+ */
+void douglasPeucker(const Obstacle::Coords& shape, size_t from, size_t to, double tolerance, std::vector<bool>& keep)
+{
+    std::vector<std::pair<size_t, size_t>> todo = {{from, to}};
+    while (!todo.empty()) {
+        size_t a = todo.back().first;
+        size_t b = todo.back().second;
+        todo.pop_back();
+
+        double maxDistance = -1;
+        size_t farthest = a;
+        for (size_t i = a + 1; i < b; ++i) {
+            double d = distanceToSegment(shape[i], shape[a], shape[b % shape.size()]);
+            if (d > maxDistance) {
+                maxDistance = d;
+                farthest = i;
+            }
+        }
+        if (maxDistance <= tolerance) continue;
+
+        keep[farthest] = true;
+        todo.emplace_back(a, farthest);
+        todo.emplace_back(farthest, b);
+    }
+}
+
+double toDb(double factor)
+{
+    return -10 * log10(std::max(factor, 1e-30));
+}
+
+} // namespace
+
+Obstacle::Coords ObstacleControl::simplifyShape(const Obstacle::Coords& shape, double tolerance)
+{
+    Obstacle::Coords clean = cleanShape(shape);
+    if ((tolerance <= 0) || (clean.size() <= 3)) return clean;
+
+    // start the ring at its lowest leftmost vertex, which is a corner of the convex hull and thus kept anyway
+    auto lowest = std::min_element(clean.begin(), clean.end(), [](const Coord& a, const Coord& b) {
+        return (a.x < b.x) || ((a.x == b.x) && (a.y < b.y));
+    });
+    std::rotate(clean.begin(), lowest, clean.end());
+
+    // split the ring at this vertex and the vertex farthest from it
+    size_t farthest = 0;
+    double maxDistance = 0;
+    for (size_t i = 1; i < clean.size(); ++i) {
+        double d = clean[0].distance(clean[i]);
+        if (d > maxDistance) {
+            maxDistance = d;
+            farthest = i;
+        }
+    }
+
+    std::vector<bool> keep(clean.size(), false);
+    keep[0] = true;
+    keep[farthest] = true;
+    douglasPeucker(clean, 0, farthest, tolerance, keep);
+    douglasPeucker(clean, farthest, clean.size(), tolerance, keep);
+
+    Obstacle::Coords simplified;
+    for (size_t i = 0; i < clean.size(); ++i) {
+        if (keep[i]) simplified.push_back(clean[i]);
+    }
+    if (simplified.size() < 3) return clean;
+    return simplified;
+}
+
+bool ObstacleControl::mergeShapes(const Obstacle::Coords& a, const Obstacle::Coords& b, Obstacle::Coords& merged)
+{
+    Obstacle::Coords sa = cleanShape(a);
+    Obstacle::Coords sb = cleanShape(b);
+    if ((sa.size() < 3) || (sb.size() < 3)) return false;
+
+    // make both outlines counterclockwise, so a shared edge is traversed in opposite directions
+    if (signedArea(sa) < 0) std::reverse(sa.begin(), sa.end());
+    if (signedArea(sb) < 0) std::reverse(sb.begin(), sb.end());
+
+    size_t n = sa.size();
+    size_t m = sb.size();
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            if (!(sa[i] == sb[(j + 1) % m]) || !(sa[(i + 1) % n] == sb[j])) continue;
+
+            // walk a from the far end of the shared edge all the way around, then continue along b
+            Obstacle::Coords result;
+            result.reserve(n + m - 2);
+            for (size_t k = 0; k < n; ++k) result.push_back(sa[(i + 1 + k) % n]);
+            for (size_t k = 0; k < m - 2; ++k) result.push_back(sb[(j + 2 + k) % m]);
+
+            // remove the remainder of the shared boundary
+            result = cleanShape(result);
+            if ((result.size() < 3) || hasDuplicateVertices(result)) return false;
+
+            merged = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ObstacleControl::simplifyObstacles(std::vector<Obstacle>& toAdd)
+{
+    if ((simplificationTolerance <= 0) && !mergeAdjacentObstacles) return;
+
+    std::vector<Obstacle> originals = toAdd;
+    std::vector<std::vector<size_t>> sources; // indices into originals that make up each resulting obstacle
+    std::vector<Obstacle> result;
+
+    std::vector<bool> done(toAdd.size(), false);
+    if (mergeAdjacentObstacles) {
+        // find candidate neighbours via exactly matching edges
+        using Point = std::pair<double, double>;
+        std::map<std::pair<Point, Point>, std::vector<size_t>> edgeOwners;
+        for (size_t o = 0; o < toAdd.size(); ++o) {
+            const Obstacle::Coords& shape = toAdd[o].getShape();
+            for (size_t i = 0, j = shape.size() - 1; i < shape.size(); j = i++) {
+                Point p1(shape[j].x, shape[j].y);
+                Point p2(shape[i].x, shape[i].y);
+                edgeOwners[std::make_pair(std::min(p1, p2), std::max(p1, p2))].push_back(o);
+            }
+        }
+        std::vector<std::set<size_t>> neighbours(toAdd.size());
+        for (auto& edge : edgeOwners) {
+            for (auto o1 : edge.second) {
+                for (auto o2 : edge.second) {
+                    if ((o1 != o2) && (toAdd[o1].getType() == toAdd[o2].getType())) neighbours[o1].insert(o2);
+                }
+            }
+        }
+
+        for (size_t o = 0; o < toAdd.size(); ++o) {
+            if (done[o] || neighbours[o].empty()) continue;
+            done[o] = true;
+
+            Obstacle::Coords shape = toAdd[o].getShape();
+            std::vector<size_t> members = {o};
+            std::set<size_t> candidates = neighbours[o];
+            while (!candidates.empty()) {
+                size_t c = *candidates.begin();
+                candidates.erase(candidates.begin());
+                if (done[c]) continue;
+                Obstacle::Coords merged;
+                if (!mergeShapes(shape, toAdd[c].getShape(), merged)) continue;
+                done[c] = true;
+                shape = merged;
+                members.push_back(c);
+                for (auto n : neighbours[c]) {
+                    if (!done[n]) candidates.insert(n);
+                }
+            }
+
+            Obstacle obs(toAdd[o].getId(), toAdd[o].getType(), getAttenuationPerCut(toAdd[o].getType()), getAttenuationPerMeter(toAdd[o].getType()));
+            obs.setShape(shape);
+            result.push_back(std::move(obs));
+            sources.push_back(members);
+        }
+    }
+    for (size_t o = 0; o < toAdd.size(); ++o) {
+        if (done[o]) continue;
+        result.push_back(std::move(toAdd[o]));
+        sources.push_back({o});
+    }
+
+    size_t verticesBefore = 0;
+    size_t verticesAfter = 0;
+    for (auto& o : originals) verticesBefore += o.getShape().size();
+    for (auto& o : result) {
+        o.setShape(simplifyShape(o.getShape(), simplificationTolerance));
+        verticesAfter += o.getShape().size();
+    }
+
+    // compare attenuation of changed obstacles along random links through their bounding box
+    if (simplificationCheckSamples > 0) {
+        std::mt19937 rng(0); // private generator, so checking does not disturb the simulation's random number streams
+        for (size_t r = 0; r < result.size(); ++r) {
+            const Obstacle& simplified = result[r];
+            if ((sources[r].size() == 1) && (simplified.getShape().size() == originals[sources[r][0]].getShape().size())) continue;
+
+            Coord p1 = simplified.getBboxP1();
+            Coord p2 = simplified.getBboxP2();
+            double margin = std::max(p2.x - p1.x, p2.y - p1.y) / 2;
+            std::uniform_real_distribution<double> xs(p1.x - margin, p2.x + margin);
+            std::uniform_real_distribution<double> ys(p1.y - margin, p2.y + margin);
+            for (int i = 0; i < simplificationCheckSamples; ++i) {
+                Coord senderPos(xs(rng), ys(rng));
+                Coord receiverPos(xs(rng), ys(rng));
+                double before = 1;
+                for (auto o : sources[r]) before *= originals[o].calculateAttenuation(senderPos, receiverPos);
+                double after = simplified.calculateAttenuation(senderPos, receiverPos);
+                double error = std::abs(toDb(before) - toDb(after));
+                statsMaxAttenuationErrorDb = std::max(statsMaxAttenuationErrorDb, error);
+                statsSumAttenuationErrorDb += error;
+                statsAttenuationErrorSamples++;
+            }
+        }
+    }
+
+    EV_INFO << "Simplified " << originals.size() << " obstacles with " << verticesBefore << " vertices to " << result.size() << " obstacles with " << verticesAfter << " vertices" << endl;
+    if (statsAttenuationErrorSamples > 0) {
+        EV_INFO << "Attenuation error on " << statsAttenuationErrorSamples << " sample links so far: max " << statsMaxAttenuationErrorDb << " dB, mean " << (statsSumAttenuationErrorDb / statsAttenuationErrorSamples) << " dB" << endl;
+    }
+
+    statsObstaclesBefore += originals.size();
+    statsObstaclesAfter += result.size();
+    statsVerticesBefore += verticesBefore;
+    statsVerticesAfter += verticesAfter;
+
+    toAdd = std::move(result);
 }
 
 void ObstacleControl::erase(const Obstacle* obstacle)
@@ -184,23 +540,147 @@ void ObstacleControl::erase(const Obstacle* obstacle)
     }
 
     cacheEntries.clear();
+    transmissionAttenuations.clear();
 }
 
-double ObstacleControl::calculateAttenuation(const Coord& senderPos, const Coord& receiverPos) const
+void ObstacleControl::checkConfigured() const
 {
-    Enter_Method_Silent();
-
     if ((perCut.size() == 0) || (perMeter.size() == 0)) {
         throw cRuntimeError("Unable to use SimpleObstacleShadowing: No obstacle types have been configured");
     }
     if (obstacles.size() == 0) {
         throw cRuntimeError("Unable to use SimpleObstacleShadowing: No obstacles have been added");
     }
+}
+
+void ObstacleControl::storeInCache(const CacheKey& key, double factor, size_t reserve) const
+{
+    if (cacheEntries.size() + reserve > 1000) cacheEntries.clear();
+    cacheEntries[key] = factor;
+}
+
+void ObstacleControl::calculateTransmissionAttenuations(int senderId, simtime_t sendStart, simtime_t lastReceptionStart, const std::vector<std::pair<int, Link>>& receivers) const
+{
+    Enter_Method_Silent();
+
+    // drop transmissions that have started arriving at all of their receivers
+    for (auto i = transmissionAttenuations.begin(); i != transmissionAttenuations.end();) {
+        if (i->second.first < simTime()) {
+            i = transmissionAttenuations.erase(i);
+        }
+        else {
+            ++i;
+        }
+    }
+
+    std::vector<Link> links;
+    links.reserve(receivers.size());
+    for (auto& receiver : receivers) {
+        links.push_back(receiver.second);
+    }
+    std::vector<double> factors;
+    calculateAttenuations(links, factors);
+
+    auto& entry = transmissionAttenuations[std::make_pair(senderId, sendStart)];
+    entry.first = lastReceptionStart;
+    entry.second.clear();
+    for (size_t i = 0; i < receivers.size(); ++i) {
+        entry.second[receivers[i].first] = std::make_pair(links[i], factors[i]);
+    }
+}
+
+const ObstacleControl::TransmissionAttenuations* ObstacleControl::findTransmissionAttenuations(int senderId, simtime_t sendStart) const
+{
+    auto i = transmissionAttenuations.find(std::make_pair(senderId, sendStart));
+    if (i == transmissionAttenuations.end()) return nullptr;
+    return &i->second.second;
+}
+
+double ObstacleControl::calculateAttenuation(const Coord& senderPos, const Coord& receiverPos, double budget) const
+{
+    Enter_Method_Silent();
+
+    checkConfigured();
 
     // return cached result, if available
     CacheKey cacheKey(senderPos, receiverPos);
     CacheEntries::const_iterator cacheEntryIter = cacheEntries.find(cacheKey);
-    if (cacheEntryIter != cacheEntries.end()) return cacheEntryIter->second;
+    if (cacheEntryIter != cacheEntries.end()) {
+        if (cacheEntryIter->second >= 0) return cacheEntryIter->second;
+        // an upper bound is good enough if it already exceeds the budget
+        if (-cacheEntryIter->second < budget) return -cacheEntryIter->second;
+    }
+
+    std::vector<const Obstacle*> hits;
+    double factor = computeAttenuation(senderPos, receiverPos, annotations ? &hits : nullptr, budget);
+
+    // draw a "hit!" bubble
+    for (auto o : hits) annotations->drawBubble(o->getBboxP1(), "hit");
+
+    // cache result (as an upper bound, if computation might have stopped early)
+    storeInCache(cacheKey, (factor < budget) ? -factor : factor);
+
+    return factor;
+}
+
+void ObstacleControl::calculateAttenuations(const std::vector<Link>& links, std::vector<double>& factors) const
+{
+    Enter_Method_Silent();
+
+    checkConfigured();
+
+    factors.resize(links.size());
+
+    // answer what we can from the cache, collect the rest
+    std::vector<size_t> misses;
+    for (size_t i = 0; i < links.size(); ++i) {
+        CacheEntries::const_iterator cacheEntryIter = cacheEntries.find(CacheKey(links[i].first, links[i].second));
+        if ((cacheEntryIter != cacheEntries.end()) && (cacheEntryIter->second >= 0)) {
+            factors[i] = cacheEntryIter->second;
+        }
+        else {
+            misses.push_back(i);
+        }
+    }
+    if (misses.empty()) return;
+
+    // evaluate misses, in parallel if worthwhile (workers only read the obstacle index)
+    std::vector<std::vector<const Obstacle*>> hits(annotations ? misses.size() : 0);
+    std::vector<std::exception_ptr> errors(misses.size());
+    auto evaluate = [&](size_t m) {
+        const Link& link = links[misses[m]];
+        try {
+            factors[misses[m]] = computeAttenuation(link.first, link.second, annotations ? &hits[m] : nullptr);
+        }
+        catch (...) {
+            // errors must not escape a worker thread, so keep them for the calling thread
+            errors[m] = std::current_exception();
+        }
+    };
+    if (threadPool && (misses.size() >= minParallelBatchSize)) {
+        threadPool->parallelFor(misses.size(), evaluate);
+    }
+    else {
+        for (size_t m = 0; m < misses.size(); ++m) evaluate(m);
+    }
+    for (auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+
+    // cache results and draw "hit!" bubbles on the calling thread
+    if (cacheEntries.size() + misses.size() > 1000) cacheEntries.clear();
+    for (size_t m = 0; m < misses.size(); ++m) {
+        const Link& link = links[misses[m]];
+        cacheEntries[CacheKey(link.first, link.second)] = factors[misses[m]];
+        if (annotations) {
+            for (auto o : hits[m]) annotations->drawBubble(o->getBboxP1(), "hit");
+        }
+    }
+}
+
+double ObstacleControl::computeAttenuation(const Coord& senderPos, const Coord& receiverPos, std::vector<const Obstacle*>* hits, double budget) const
+{
+    double bailBelow = std::max(budget, 1e-30);
 
     // calculate bounding box of transmission
     Coord bboxP1 = Coord(std::min(senderPos.x, receiverPos.x), std::min(senderPos.y, receiverPos.y));
@@ -235,19 +715,15 @@ double ObstacleControl::calculateAttenuation(const Coord& senderPos, const Coord
 
                 factor *= o->calculateAttenuation(senderPos, receiverPos);
 
-                // draw a "hit!" bubble
-                if (annotations && (factor != factorOld)) annotations->drawBubble(o->getBboxP1(), "hit");
+                // remember obstacle for drawing a "hit!" bubble
+                if (hits && (factor != factorOld)) hits->push_back(o);
 
-                // bail if attenuation is already extremely high
-                if (factor < 1e-30) break;
+                // bail if attenuation is already extremely high (or exceeds the budget)
+                if (factor < bailBelow) return factor;
             }
         }
     }
 
-    // cache result
-    if (cacheEntries.size() >= 1000) cacheEntries.clear();
-    cacheEntries[cacheKey] = factor;
-
     return factor;
 }
 
@@ -22,12 +22,14 @@
 
 #include <list>
 #include <memory>
+#include <unordered_map>
 
 #include "veins/veins.h"
 
 #include "veins/base/utils/Coord.h"
 #include "veins/modules/obstacle/Obstacle.h"
 #include "veins/modules/world/annotations/AnnotationManager.h"
+#include "veins/modules/utility/ThreadPool.h"
 
 namespace Veins {
 
@@ -40,6 +42,8 @@ namespace Veins {
  */
 class VEINS_API ObstacleControl : public cSimpleModule {
 public:
+    using Link = std::pair<Coord, Coord>; /**< (sender position, receiver position) */
+
     ~ObstacleControl() override;
     void initialize(int stage) override;
     int numInitStages() const override
@@ -53,6 +57,13 @@ public:
     void addFromXml(cXMLElement* xml);
     void addFromTypeAndShape(std::string id, std::string typeId, std::vector<Coord> shape);
     void add(Obstacle obstacle);
+    /**
+     * add a batch of obstacles at once.
+     *
+     * The spatial index is resized only once for the whole batch and
+     * annotations (if any) are drawn in one go after it has been built.
+     */
+    void addAll(std::vector<Obstacle> obstacles);
     void erase(const Obstacle* obstacle);
     bool isTypeSupported(std::string type);
     double getAttenuationPerCut(std::string type);
@@ -60,8 +71,56 @@ public:
 
     /**
      * calculate additional attenuation by obstacles, return signal strength
+     *
+     * If budget is positive, computation may stop as soon as the attenuation factor drops below it.
+     * Any result smaller than budget is then only an upper bound of the true factor.
+     */
+    double calculateAttenuation(const Coord& senderPos, const Coord& receiverPos, double budget = 0) const;
+
+    /**
+     * calculate additional attenuation by obstacles for a batch of links.
+     *
+     * Writes one factor per entry of links to factors.
+     * Links not found in the cache are evaluated in parallel on the read-only obstacle index;
+     * the cache is updated and annotations are drawn on the calling thread only.
+     * Errors raised while evaluating a link are rethrown on the calling thread, once all links have been evaluated.
+     */
+    void calculateAttenuations(const std::vector<Link>& links, std::vector<double>& factors) const;
+
+    /**
+     * attenuation factors of a transmission (along with the link each was calculated for), by the id of the receiving antenna
      */
-    double calculateAttenuation(const Coord& senderPos, const Coord& receiverPos) const;
+    using TransmissionAttenuations = std::unordered_map<int, std::pair<Link, double>>;
+
+    /**
+     * calculate additional attenuation of the transmission by antenna senderId starting at sendStart along each of receivers (pairs of antenna id and link) in one batch.
+     *
+     * Each link should hold the positions of sender and receiver at the time that receiver starts receiving.
+     * The results are kept for findTransmissionAttenuations until the last of these times, lastReceptionStart, has passed.
+     */
+    void calculateTransmissionAttenuations(int senderId, simtime_t sendStart, simtime_t lastReceptionStart, const std::vector<std::pair<int, Link>>& receivers) const;
+
+    /**
+     * returns the attenuation factors calculated by calculateTransmissionAttenuations for a transmission, or nullptr if there are none
+     */
+    const TransmissionAttenuations* findTransmissionAttenuations(int senderId, simtime_t sendStart) const;
+
+    /**
+     * simplify a closed polygon using the Douglas-Peucker algorithm.
+     *
+     * Duplicate vertices (including a repeated first vertex) and spikes are dropped first.
+     * Every removed vertex lies within tolerance of the returned outline.
+     * If tolerance is not positive, only the cleanup is performed.
+     */
+    static Obstacle::Coords simplifyShape(const Obstacle::Coords& shape, double tolerance);
+
+    /**
+     * merge two polygons that share at least one edge into their union.
+     *
+     * Returns false (and leaves merged untouched) if the polygons share no edge
+     * or their union would not be a simple polygon.
+     */
+    static bool mergeShapes(const Obstacle::Coords& a, const Obstacle::Coords& b, Obstacle::Coords& merged);
 
 protected:
     struct CacheKey {
@@ -95,9 +154,28 @@ protected:
     using ObstacleGridCell = std::list<Obstacle*>;
     using ObstacleGridRow = std::vector<ObstacleGridCell>;
     using Obstacles = std::vector<ObstacleGridRow>;
-    typedef std::map<CacheKey, double> CacheEntries;
+    typedef std::map<CacheKey, double> CacheEntries; /**< exact factors, or upper bounds (stored negated) of factors that fell below a budget */
+
+    /**
+     * calculate attenuation without consulting the cache or drawing annotations.
+     *
+     * Only reads the obstacle index, so it is safe to call concurrently.
+     * If hits is not null, all obstacles that attenuated the signal are appended to it.
+     * Stops as soon as the factor drops below budget (or below 1e-30).
+     */
+    double computeAttenuation(const Coord& senderPos, const Coord& receiverPos, std::vector<const Obstacle*>* hits, double budget = 0) const;
+    void checkConfigured() const;
+    void storeInCache(const CacheKey& key, double factor, size_t reserve = 1) const;
+
+    /**
+     * merge adjacent obstacles of the same type and simplify their outlines, as configured.
+     *
+     * If requested, compares the attenuation of the original and simplified obstacles along random links.
+     */
+    void simplifyObstacles(std::vector<Obstacle>& obstacles);
 
     cXMLElement* obstaclesXml; /**< obstacles to add at startup */
+    bool annotateInCmdenv; /**< whether to draw obstacles via the AnnotationManager when running without a GUI */
 
     Obstacles obstacles;
     std::vector<std::unique_ptr<Obstacle>> obstacleOwner;
@@ -106,6 +184,20 @@ protected:
     std::map<std::string, double> perCut;
     std::map<std::string, double> perMeter;
     mutable CacheEntries cacheEntries;
+    mutable std::map<std::pair<int, simtime_t>, std::pair<simtime_t, TransmissionAttenuations>> transmissionAttenuations; /**< see calculateTransmissionAttenuations, last reception start and factors by sending antenna and start of transmission */
+    std::unique_ptr<ThreadPool> threadPool; /**< workers for batch queries (null if only the calling thread is to be used) */
+    size_t minParallelBatchSize; /**< smallest number of uncached links for which a batch query uses the thread pool */
+
+    double simplificationTolerance; /**< maximum distance (in m) of a removed vertex from the simplified outline (0: do not simplify) */
+    bool mergeAdjacentObstacles; /**< whether to merge obstacles of the same type that share an edge */
+    int simplificationCheckSamples; /**< number of random links per changed obstacle used to quantify the attenuation error */
+    size_t statsObstaclesBefore; /**< number of obstacles before merging */
+    size_t statsObstaclesAfter; /**< number of obstacles after merging */
+    size_t statsVerticesBefore; /**< number of vertices before simplification */
+    size_t statsVerticesAfter; /**< number of vertices after simplification */
+    double statsMaxAttenuationErrorDb; /**< largest attenuation difference (in dB) observed on a sample link */
+    double statsSumAttenuationErrorDb; /**< sum of attenuation differences (in dB) over all sample links */
+    size_t statsAttenuationErrorSamples; /**< number of sample links */
 };
 
 class VEINS_API ObstacleControlAccess {
@@ -24,16 +24,17 @@
 #include "veins/modules/mobility/traci/TraCIMobility.h"
 
 using Veins::Coord;
+using Veins::Heading;
 using Veins::VehicleObstacle;
 
 namespace {
 
-bool isPointInObstacle(Coord point, const VehicleObstacle::Coords& shape)
+bool isPointInObstacle(Coord point, const Coord* shape, size_t numCorners)
 {
     bool isInside = false;
-    auto i = shape.begin();
-    auto j = (shape.rbegin() + 1).base();
-    for (; i != shape.end(); j = i++) {
+    const Coord* i = shape;
+    const Coord* j = shape + numCorners - 1;
+    for (; i != shape + numCorners; j = i++) {
         bool inYRangeUp = (point.y >= i->y) && (point.y < j->y);
         bool inYRangeDown = (point.y >= j->y) && (point.y < i->y);
         bool inYRange = inYRangeUp || inYRangeDown;
@@ -64,14 +65,37 @@ double segmentsIntersectAt(Coord p1From, Coord p1To, Coord p2From, Coord p2To)
 
 } // namespace
 
+Coord VehicleObstacle::getPositionAt(simtime_t t) const
+{
+    if (!traciMobility) return position;
+    return traciMobility->getPositionAt(t);
+}
+
+Heading VehicleObstacle::getHeading() const
+{
+    if (!traciMobility) return heading;
+    return traciMobility->getHeading();
+}
+
+Coord VehicleObstacle::getVelocity() const
+{
+    if (!traciMobility) return Coord();
+    return traciMobility->getHostSpeed();
+}
+
+double VehicleObstacle::getYawRate() const
+{
+    if (!traciMobility) return 0;
+    return traciMobility->getCurrentYawRate();
+}
+
 VehicleObstacle::Coords VehicleObstacle::getShape(simtime_t t) const
 {
     double l = getLength();
     double o = getHostPositionOffset(); // this is the shift we have to undo in order to (given the OMNeT++ host position) get the car's front bumper position
     double w = getWidth() / 2;
-    const TraCIMobility* m = getTraCIMobility();
-    Coord p = m->getPositionAt(t);
-    double a = m->getHeading().getRad();
+    Coord p = getPositionAt(t);
+    double a = getHeading().getRad();
 
     Coords shape;
     shape.push_back(p + Coord(-(l - o), -w).rotatedYaw(-a));
@@ -87,8 +111,7 @@ bool VehicleObstacle::maybeInBounds(double x1, double y1, double x2, double y2,
     double l = getLength();
     double o = getHostPositionOffset(); // this is the shift we have to undo in order to (given the OMNeT++ host position) get the car's front bumper position
     double w = getWidth() / 2;
-    const TraCIMobility* m = getTraCIMobility();
-    Coord p = m->getPositionAt(t);
+    Coord p = getPositionAt(t);
 
     double lw = std::max(l, w);
 
@@ -107,20 +130,24 @@ bool VehicleObstacle::maybeInBounds(double x1, double y1, double x2, double y2,
 
 double VehicleObstacle::getIntersectionPoint(const Coord& senderPos, const Coord& receiverPos, simtime_t t) const
 {
-    const double not_a_number = std::numeric_limits<double>::quiet_NaN();
-
     VehicleObstacle::Coords shape = getShape(t);
+    return getIntersectionPoint(shape.data(), shape.size(), senderPos, receiverPos);
+}
+
+double VehicleObstacle::getIntersectionPoint(const Coord* shape, size_t numCorners, const Coord& senderPos, const Coord& receiverPos)
+{
+    const double not_a_number = std::numeric_limits<double>::quiet_NaN();
 
     // shortcut if sender is inside
-    bool senderInside = isPointInObstacle(senderPos, shape);
+    bool senderInside = isPointInObstacle(senderPos, shape, numCorners);
     if (senderInside) return 0;
 
     // get a list of points (in [0, 1]) along the line between sender and receiver where the beam intersects with this obstacle
     std::multiset<double> intersectAt;
     bool doesIntersect = false;
-    VehicleObstacle::Coords::const_iterator i = shape.begin();
-    VehicleObstacle::Coords::const_iterator j = (shape.rbegin() + 1).base();
-    for (; i != shape.end(); j = i++) {
+    const Coord* i = shape;
+    const Coord* j = shape + numCorners - 1;
+    for (; i != shape + numCorners; j = i++) {
         Coord c1 = *i;
         Coord c2 = *j;
 
@@ -134,7 +161,7 @@ double VehicleObstacle::getIntersectionPoint(const Coord& senderPos, const Coord
 
     // shortcut if no intersections
     if (!doesIntersect) {
-        bool receiverInside = isPointInObstacle(receiverPos, shape);
+        bool receiverInside = isPointInObstacle(receiverPos, shape, numCorners);
         if (receiverInside) return senderPos.distance(receiverPos);
         return not_a_number;
     }
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "veins/base/utils/Coord.h"
+#include "veins/base/utils/Heading.h"
 
 namespace Veins {
 
@@ -55,6 +56,14 @@ public:
     {
         this->traciMobility = traciMobility;
     }
+    /**
+     * sets where a vehicle without TraCIMobility is (i.e., the position of its front bumper if hostPositionOffset is 0) and where it is heading
+     */
+    void setPose(const Coord& position, Heading heading)
+    {
+        this->position = position;
+        this->heading = heading;
+    }
     void setLength(double d)
     {
         this->length = d;
@@ -97,6 +106,26 @@ public:
         return height;
     }
 
+    /**
+     * position of the vehicle at time t, as reported by its TraCIMobility (or, if it has none, as set by setPose)
+     */
+    Coord getPositionAt(simtime_t t) const;
+
+    /**
+     * heading of the vehicle, as reported by its TraCIMobility (or, if it has none, as set by setPose)
+     */
+    Heading getHeading() const;
+
+    /**
+     * displacement of the vehicle per second (zero unless it has a TraCIMobility that sets the host speed)
+     */
+    Coord getVelocity() const;
+
+    /**
+     * rate at which the vehicle turns in radians per second (zero unless it has a TraCIMobility that extrapolates turns)
+     */
+    double getYawRate() const;
+
     Coords getShape(simtime_t t) const;
 
     bool maybeInBounds(double x1, double y1, double x2, double y2, simtime_t t) const;
@@ -106,6 +135,11 @@ public:
      */
     double getIntersectionPoint(const Coord& senderPos, const Coord& receiverPos, simtime_t t) const;
 
+    /**
+     * return closest point (in meters) along (senderPos--receiverPos) where the polygon given by numCorners points at shape overlaps, or NAN if it doesn't
+     */
+    static double getIntersectionPoint(const Coord* shape, size_t numCorners, const Coord& senderPos, const Coord& receiverPos);
+
 protected:
     std::vector<ChannelAccess*> channelAccessModules;
     TraCIMobility* traciMobility;
@@ -113,5 +147,7 @@ protected:
     double hostPositionOffset;
     double width;
     double height;
+    Coord position; /**< see setPose */
+    Heading heading; /**< see setPose */
 };
 } // namespace Veins
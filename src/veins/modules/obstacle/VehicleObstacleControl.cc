@@ -30,13 +30,18 @@
 #include "veins/base/connectionManager/ChannelAccess.h"
 #include "veins/base/toolbox/Signal.h"
 
+using Veins::Coord;
+using Veins::Move;
 using Veins::Signal;
 using Veins::VehicleObstacle;
 using Veins::VehicleObstacleControl;
 
 Define_Module(Veins::VehicleObstacleControl);
 
-VehicleObstacleControl::~VehicleObstacleControl() = default;
+VehicleObstacleControl::~VehicleObstacleControl()
+{
+    for (auto o : vehicleObstacles) delete o;
+}
 
 void VehicleObstacleControl::initialize(int stage)
 {
@@ -45,11 +50,24 @@ void VehicleObstacleControl::initialize(int stage)
         if (annotations) {
             vehicleAnnotationGroup = annotations->createGroup("vehicleObstacles");
         }
+
+        // keep footprints up to date whenever a vehicle moves
+        getSimulation()->getSystemModule()->subscribe(BaseMobility::mobilityStateChangedSignal, this);
+    }
+}
+
+void VehicleObstacleControl::receiveSignal(cComponent* source, simsignal_t signalID, cObject* obj, cObject* details)
+{
+    if (signalID == BaseMobility::mobilityStateChangedSignal) {
+        auto i = obstaclesByMobility.find(dynamic_cast<const TraCIMobility*>(obj));
+        if (i == obstaclesByMobility.end()) return;
+        updateFootprint(footprintIndex.at(i->second));
     }
 }
 
 void VehicleObstacleControl::finish()
 {
+    getSimulation()->getSystemModule()->unsubscribe(BaseMobility::mobilityStateChangedSignal, this);
 }
 
 void VehicleObstacleControl::handleMessage(cMessage* msg)
@@ -70,27 +88,84 @@ const VehicleObstacle* VehicleObstacleControl::add(VehicleObstacle obstacle)
 {
     auto* o = new VehicleObstacle(obstacle);
     vehicleObstacles.push_back(o);
+    footprints.emplace_back();
+    footprintIndex[o] = vehicleObstacles.size() - 1;
+    if (o->getTraCIMobility()) obstaclesByMobility[o->getTraCIMobility()] = o;
+    updateFootprint(vehicleObstacles.size() - 1);
 
     return o;
 }
 
 void VehicleObstacleControl::erase(const VehicleObstacle* obstacle)
 {
-    bool erasedOne = false;
-    for (auto k = vehicleObstacles.begin(); k != vehicleObstacles.end();) {
-        VehicleObstacle* o = *k;
-        if (o == obstacle) {
-            erasedOne = true;
-            k = vehicleObstacles.erase(k);
-        }
-        else {
-            ++k;
-        }
+    auto i = footprintIndex.find(obstacle);
+    ASSERT(i != footprintIndex.end());
+    ASSERT(vehicleObstacles[i->second] == obstacle);
+
+    // move the last entry into the gap to keep storage contiguous
+    size_t index = i->second;
+    footprintIndex.erase(i);
+    if (obstacle->getTraCIMobility()) obstaclesByMobility.erase(obstacle->getTraCIMobility());
+    if (index != vehicleObstacles.size() - 1) {
+        vehicleObstacles[index] = vehicleObstacles.back();
+        footprints[index] = footprints.back();
+        footprintIndex[vehicleObstacles[index]] = index;
     }
-    ASSERT(erasedOne);
+    vehicleObstacles.pop_back();
+    footprints.pop_back();
+
     delete obstacle;
 }
 
+void VehicleObstacleControl::setPose(const VehicleObstacle* obstacle, const Coord& position, Heading heading)
+{
+    auto i = footprintIndex.find(obstacle);
+    ASSERT(i != footprintIndex.end());
+    ASSERT(!obstacle->getTraCIMobility());
+    vehicleObstacles[i->second]->setPose(position, heading);
+    updateFootprint(i->second);
+}
+
+void VehicleObstacleControl::updateFootprint(size_t i)
+{
+    const VehicleObstacle* o = vehicleObstacles[i];
+    Footprint& f = footprints[i];
+
+    f.t = simTime();
+    f.velocity = o->getVelocity();
+    // like Move::getPositionAt, vehicles that are (practically) standing still do not turn
+    f.yawRate = math::almost_equal(f.velocity.length(), 0.0) ? 0 : o->getYawRate();
+    f.position = o->getPositionAt(f.t);
+
+    VehicleObstacle::Coords shape = o->getShape(f.t);
+    ASSERT(shape.size() == 4);
+    f.bboxP1 = Coord(shape[0].x, shape[0].y);
+    f.bboxP2 = Coord(shape[0].x, shape[0].y);
+    f.radius = 0;
+    for (size_t k = 0; k < 4; ++k) {
+        f.corners[k] = shape[k];
+        f.bboxP1.x = std::min(f.bboxP1.x, shape[k].x);
+        f.bboxP1.y = std::min(f.bboxP1.y, shape[k].y);
+        f.bboxP2.x = std::max(f.bboxP2.x, shape[k].x);
+        f.bboxP2.y = std::max(f.bboxP2.y, shape[k].y);
+        f.radius = std::max(f.radius, (shape[k] - f.position).length());
+    }
+}
+
+Coord VehicleObstacleControl::getFootprintPosition(const Footprint& f, simtime_t t)
+{
+    return Move::extrapolatePosition(f.position, f.velocity, f.yawRate, (t - f.t).dbl());
+}
+
+void VehicleObstacleControl::getFootprintCorners(const Footprint& f, simtime_t t, const Coord& position, Coord corners[4])
+{
+    double angle = f.yawRate * (t - f.t).dbl();
+    for (size_t k = 0; k < 4; ++k) {
+        Coord offset = f.corners[k] - f.position;
+        corners[k] = position + (angle == 0 ? offset : offset.rotatedYaw(angle));
+    }
+}
+
 Signal VehicleObstacleControl::getVehicleAttenuationSingle(double h1, double h2, double h, double d, double d1, Signal attenuationPrototype)
 {
     Signal attenuation = Signal(attenuationPrototype.getSpectrum());
@@ -291,20 +366,32 @@ std::vector<std::pair<double, double>> VehicleObstacleControl::getPotentialObsta
     double y1 = std::min(senderPos.y, receiverPos.y);
     double y2 = std::max(senderPos.y, receiverPos.y);
 
-    for (auto o : vehicleObstacles) {
+    for (size_t i = 0; i < vehicleObstacles.size(); ++i) {
+        const VehicleObstacle* o = vehicleObstacles[i];
+        const Footprint& f = footprints[i];
+
+        // move cached footprint to the time of transmission (if vehicles are moving in-between updates)
+        Coord position = getFootprintPosition(f, sStart);
+
+        // a turning footprint stays within radius of its position
+        Coord bboxP1 = f.bboxP1 + (position - f.position);
+        Coord bboxP2 = f.bboxP2 + (position - f.position);
+        if (f.yawRate != 0) {
+            bboxP1 = Coord(position.x - f.radius, position.y - f.radius);
+            bboxP2 = Coord(position.x + f.radius, position.y + f.radius);
+        }
+
+        if (bboxP2.x < x1) continue;
+        if (bboxP1.x > x2) continue;
+        if (bboxP2.y < y1) continue;
+        if (bboxP1.y > y2) continue;
+
         auto caModules = o->getChannelAccessModules();
         double l = o->getLength();
         double w = o->getWidth();
         double h = o->getHeight();
 
-        auto hp_approx = o->getTraCIMobility()->getPositionAt(simTime());
-
-        EV << "checking vehicle in proximity of " << hp_approx.info() << " with height: " << h << " width: " << w << " length: " << l << endl;
-
-        if (!o->maybeInBounds(x1, y1, x2, y2, sStart)) {
-            EV_TRACE << "bounding boxes don't overlap: ignore" << std::endl;
-            continue;
-        }
+        EV << "checking vehicle in proximity of " << f.bboxP1.info() << " with height: " << h << " width: " << w << " length: " << l << endl;
 
         // check if this is either the sender or the receiver
         bool ignoreMe = false;
@@ -323,7 +410,9 @@ std::vector<std::pair<double, double>> VehicleObstacleControl::getPotentialObsta
         if (ignoreMe) continue;
 
         // this is a potential obstacle
-        double p1d = o->getIntersectionPoint(senderPos, receiverPos, sStart);
+        Coord corners[4];
+        getFootprintCorners(f, sStart, position, corners);
+        double p1d = VehicleObstacle::getIntersectionPoint(corners, 4, senderPos, receiverPos);
         double maxd = senderPos.distance(receiverPos);
         if (!std::isnan(p1d) && p1d > 0 && p1d < maxd) {
             auto it = potentialObstacles.begin();
@@ -355,7 +444,10 @@ std::vector<std::pair<double, double>> VehicleObstacleControl::getPotentialObsta
 
 void VehicleObstacleControl::drawVehicleObstacles(const simtime_t& t) const
 {
-    for (auto o : vehicleObstacles) {
-        annotations->drawPolygon(o->getShape(t), "black", vehicleAnnotationGroup);
+    for (auto& f : footprints) {
+        Coord corners[4];
+        getFootprintCorners(f, t, getFootprintPosition(f, t), corners);
+        VehicleObstacle::Coords shape(corners, corners + 4);
+        annotations->drawPolygon(shape, "black", vehicleAnnotationGroup);
     }
 }
@@ -21,6 +21,8 @@
 #pragma once
 
 #include <list>
+#include <map>
+#include <vector>
 
 #include "veins/veins.h"
 
@@ -42,8 +44,22 @@ class Signal;
  * Transmissions that cross one of the polygon's lines will have
  * their receive power set to zero.
  */
-class VEINS_API VehicleObstacleControl : public cSimpleModule {
+class VEINS_API VehicleObstacleControl : public cSimpleModule, public cListener {
 public:
+    /**
+     * footprint of a vehicle as of its last position update, extrapolated to other times along the same arc as its position (see Move::getPositionAt).
+     */
+    struct Footprint {
+        Coord corners[4]; /**< rotated rectangle covered by the vehicle at time t */
+        Coord bboxP1; /**< lower corner of axis-aligned bounding box at time t */
+        Coord bboxP2; /**< upper corner of axis-aligned bounding box at time t */
+        Coord position; /**< position of the vehicle (which the footprint turns around) at time t */
+        double radius; /**< largest distance of a corner from position */
+        Coord velocity; /**< displacement per second (zero unless the mobility module sets the host speed) */
+        double yawRate; /**< turning rate in radians per second (zero unless the mobility module extrapolates turns) */
+        simtime_t t; /**< time of last position update */
+    };
+
     ~VehicleObstacleControl() override;
     void initialize(int stage) override;
     int numInitStages() const override
@@ -54,9 +70,16 @@ public:
     void handleMessage(cMessage* msg) override;
     void handleSelfMsg(cMessage* msg);
 
+    void receiveSignal(cComponent* source, simsignal_t signalID, cObject* obj, cObject* details) override;
+
     const VehicleObstacle* add(VehicleObstacle obstacle);
     void erase(const VehicleObstacle* obstacle);
 
+    /**
+     * moves an obstacle without TraCIMobility, see VehicleObstacle::setPose
+     */
+    void setPose(const VehicleObstacle* obstacle, const Coord& position, Heading heading);
+
     /**
      * get distance and height of potential obstacles
      */
@@ -89,10 +112,28 @@ public:
 protected:
     AnnotationManager* annotations;
 
-    using VehicleObstacles = std::list<VehicleObstacle*>;
+    using VehicleObstacles = std::vector<VehicleObstacle*>;
     VehicleObstacles vehicleObstacles;
+    std::vector<Footprint> footprints; /**< cached footprint of vehicleObstacles[i] at index i */
+    std::map<const VehicleObstacle*, size_t> footprintIndex; /**< index into vehicleObstacles and footprints by obstacle */
+    std::map<const TraCIMobility*, const VehicleObstacle*> obstaclesByMobility; /**< obstacles by mobility module, for those that have one */
     AnnotationManager::Group* vehicleAnnotationGroup;
     void drawVehicleObstacles(const simtime_t& t) const;
+
+    /**
+     * recompute the cached footprint at index i from the vehicle's current position and heading
+     */
+    void updateFootprint(size_t i);
+
+    /**
+     * position of the vehicle of footprint f at time t
+     */
+    static Coord getFootprintPosition(const Footprint& f, simtime_t t);
+
+    /**
+     * corners of footprint f at time t, given the position of its vehicle at that time (see getFootprintPosition)
+     */
+    static void getFootprintCorners(const Footprint& f, simtime_t t, const Coord& position, Coord corners[4]);
 };
 
 class VEINS_API VehicleObstacleControlAccess {
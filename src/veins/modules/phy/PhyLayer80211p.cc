@@ -64,6 +64,45 @@ void PhyLayer80211p::initialize(int stage)
     BasePhyLayer::initialize(stage);
 }
 
+void PhyLayer80211p::prepareForReuse()
+{
+    finish();
+
+    // AirFrames being received were meant for the vehicle that left
+    AirFrameVector channel;
+    channelInfo.getAirFrames(0, simTime(), channel);
+    for (auto frame : channel) {
+        cancelAndDelete(frame);
+    }
+    channelInfo = ChannelInfo();
+
+    cancelEvent(txOverTimer);
+    cancelEvent(radioSwitchingOverTimer);
+}
+
+void PhyLayer80211p::reinitialize(int stage)
+{
+    if (stage == 0) {
+        // analogue models do not keep state of their own, but radio, decider, and antenna (e.g., its random offsets) belong to the vehicle
+        radio = initializeRadio();
+        initializeDecider(par("decider").xmlValue());
+        initializeAntenna(par("antenna").xmlValue());
+
+        // register with the connection manager on the first position update, as on initialization
+        isRegistered = false;
+    }
+}
+
+void PhyLayer80211p::handleMessage(cMessage* msg)
+{
+    if (isForPreviousVehicle(msg)) {
+        EV_TRACE << "Dropping " << msg->getName() << ", which was meant for the previous vehicle" << endl;
+        delete msg;
+        return;
+    }
+    BasePhyLayer::handleMessage(msg);
+}
+
 unique_ptr<AnalogueModel> PhyLayer80211p::getAnalogueModelFromName(std::string name, ParameterMap& params)
 {
 
@@ -230,9 +269,21 @@ unique_ptr<AnalogueModel> PhyLayer80211p::initializeSimpleObstacleShadowing(Para
 
     ParameterMap::iterator it;
 
+    bool batchReceivers = false;
+    it = params.find("batchReceivers");
+    if (it != params.end()) {
+        batchReceivers = it->second.boolValue();
+    }
+
+    bool useAttenuationBudget = false;
+    it = params.find("useAttenuationBudget");
+    if (it != params.end()) {
+        useAttenuationBudget = it->second.boolValue();
+    }
+
     ObstacleControl* obstacleControlP = ObstacleControlAccess().getIfExists();
     if (!obstacleControlP) throw cRuntimeError("initializeSimpleObstacleShadowing(): cannot find ObstacleControl module");
-    return make_unique<SimpleObstacleShadowing>(this, *obstacleControlP, useTorus, playgroundSize);
+    return make_unique<SimpleObstacleShadowing>(this, *obstacleControlP, useTorus, playgroundSize, batchReceivers, useAttenuationBudget);
 }
 
 unique_ptr<AnalogueModel> PhyLayer80211p::initializeVehicleObstacleShadowing(ParameterMap& params)
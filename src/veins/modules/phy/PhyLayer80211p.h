@@ -28,6 +28,7 @@
 #include "veins/base/connectionManager/BaseConnectionManager.h"
 #include "veins/modules/phy/Decider80211pToPhy80211pInterface.h"
 #include "veins/base/utils/Move.h"
+#include "veins/modules/mobility/traci/TraCIReusableModule.h"
 
 namespace Veins {
 
@@ -42,9 +43,11 @@ namespace Veins {
  * @see PhyLayer80211p
  * @see Decider80211p
  */
-class VEINS_API PhyLayer80211p : public BasePhyLayer, public Mac80211pToPhy11pInterface, public Decider80211pToPhy80211pInterface {
+class VEINS_API PhyLayer80211p : public BasePhyLayer, public Mac80211pToPhy11pInterface, public Decider80211pToPhy80211pInterface, public TraCIReusableModule {
 public:
     void initialize(int stage) override;
+    void prepareForReuse() override;
+    void reinitialize(int stage) override;
     /**
      * @brief Set the carrier sense threshold
      * @param ccaThreshold_dBm the cca threshold in dBm
@@ -173,6 +176,11 @@ protected:
 
     virtual simtime_t getFrameDuration(int payloadLengthBits, MCS mcs) const override;
 
+    /**
+     * Drops messages (e.g., AirFrames) meant for the vehicle this module was previously used for.
+     */
+    void handleMessage(cMessage* msg) override;
+
     void handleSelfMessage(cMessage* msg) override;
     int getRadioState() override;
     simtime_t setRadioState(int rs) override;
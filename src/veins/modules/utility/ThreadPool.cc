@@ -0,0 +1,132 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <algorithm>
+
+#include "veins/modules/utility/ThreadPool.h"
+
+namespace Veins {
+
+ThreadPool::ThreadPool(size_t numThreads)
+    : job(nullptr)
+    , jobSize(0)
+    , nextItem(0)
+    , busyWorkers(0)
+    , generation(0)
+    , stopping(false)
+{
+    for (size_t i = 1; i < numThreads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void ThreadPool::parallelFor(size_t n, const std::function<void(size_t)>& fn)
+{
+    if (n == 0) return;
+
+    if (workers.empty() || n == 1) {
+        for (size_t i = 0; i < n; ++i) fn(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobSize = n;
+        nextItem = 0;
+        busyWorkers = workers.size();
+        firstError = nullptr;
+        ++generation;
+    }
+    workAvailable.notify_all();
+
+    // the calling thread helps out
+    runItems();
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        workDone.wait(lock, [this] { return busyWorkers == 0; });
+        job = nullptr;
+        error = firstError;
+        firstError = nullptr;
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void ThreadPool::workerLoop()
+{
+    unsigned long seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [this, seenGeneration] { return stopping || (generation != seenGeneration); });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+
+        runItems();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --busyWorkers;
+        }
+        workDone.notify_one();
+    }
+}
+
+void ThreadPool::runItems()
+{
+    while (true) {
+        size_t from;
+        size_t to;
+        const std::function<void(size_t)>* fn;
+        {
+            // hand out items in chunks to keep contention on the mutex low
+            std::lock_guard<std::mutex> lock(mutex);
+            if (nextItem >= jobSize) return;
+            size_t chunk = std::max<size_t>(1, jobSize / (4 * size()));
+            from = nextItem;
+            to = std::min(jobSize, from + chunk);
+            nextItem = to;
+            fn = job;
+        }
+        try {
+            for (size_t i = from; i < to; ++i) (*fn)(i);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!firstError) firstError = std::current_exception();
+            nextItem = jobSize;
+        }
+    }
+}
+
+} // namespace Veins
@@ -0,0 +1,86 @@
+//
+// Copyright (C) 2019 The Veins authors
+//
+// Documentation for these modules is at http://veins.car2x.org/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "veins/veins.h"
+
+namespace Veins {
+
+/**
+ * A fixed-size pool of worker threads for data-parallel loops.
+ *
+ * Work items must not touch OMNeT++ state (modules, messages, RNGs,
+ * logging), as the simulation kernel is not thread-safe.
+ */
+class VEINS_API ThreadPool {
+public:
+    /**
+     * Create a pool that uses numThreads threads in total (including the calling thread).
+     */
+    explicit ThreadPool(size_t numThreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * number of threads working on a loop, including the calling thread
+     */
+    size_t size() const
+    {
+        return workers.size() + 1;
+    }
+
+    /**
+     * Call fn(i) for every i in [0, n), distributed over all threads of the pool.
+     *
+     * Blocks until all items have been processed.
+     * If an item throws, the first exception is rethrown on the calling thread.
+     */
+    void parallelFor(size_t n, const std::function<void(size_t)>& fn);
+
+private:
+    void workerLoop();
+    void runItems();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+
+    const std::function<void(size_t)>* job; /**< loop body of the current job, if any */
+    size_t jobSize; /**< number of items in the current job */
+    size_t nextItem; /**< next item of the current job to hand out */
+    size_t busyWorkers; /**< number of workers still processing the current job */
+    unsigned long generation; /**< incremented for every new job */
+    bool stopping;
+    std::exception_ptr firstError;
+};
+
+} // namespace Veins
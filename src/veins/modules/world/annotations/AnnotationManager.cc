@@ -236,6 +236,35 @@ AnnotationManager::Polygon* AnnotationManager::drawPolygon(std::vector<Coord> co
     return drawPolygon(std::list<Coord>(coords.begin(), coords.end()), color, group);
 }
 
+std::vector<AnnotationManager::Polygon*> AnnotationManager::drawPolygons(const std::vector<std::vector<Coord>>& shapes, std::string color, Group* group)
+{
+    std::vector<Polygon*> polygons;
+    polygons.reserve(shapes.size());
+    for (auto& shape : shapes) {
+        Polygon* p = new Polygon(std::list<Coord>(shape.begin(), shape.end()), color);
+        p->group = group;
+        annotations.push_back(p);
+        polygons.push_back(p);
+    }
+
+    if (par("draw")) {
+        TraCIScenarioManager* traci = TraCIScenarioManagerAccess().get();
+        bool mirror = traci && traci->isConnected();
+        std::vector<std::string> ids;
+        std::vector<std::list<Coord>> coords;
+        for (auto p : polygons) {
+            showPolygonFigure(p);
+            if (!mirror) continue;
+            ids.push_back(makeTraCIPolygonId());
+            coords.push_back(p->coords);
+            p->traciPolygonsIds.push_back(ids.back());
+        }
+        if (!ids.empty()) traci->getCommandInterface()->addPolygons(ids, "Annotation", TraCIColor::fromTkColor(color), false, 4, coords);
+    }
+
+    return polygons;
+}
+
 void AnnotationManager::drawBubble(Coord p1, std::string text)
 {
     std::string pxOld = getDisplayString().getTagArg("p", 0);
@@ -336,27 +365,13 @@ void AnnotationManager::show(const Annotation* annotation)
     }
     else if (const Polygon* p = dynamic_cast<const Polygon*>(annotation)) {
 
-        ASSERT(p->coords.size() >= 2);
-
-        if (hasGUI()) {
-            cPolygonFigure* figure = new cPolygonFigure();
-            std::vector<cFigure::Point> points;
-            for (std::list<Coord>::const_iterator i = p->coords.begin(); i != p->coords.end(); ++i) {
-                points.push_back(cFigure::Point(i->x, i->y));
-            }
-            figure->setPoints(points);
-            figure->setLineColor(cFigure::Color(p->color.c_str()));
-            figure->setFilled(false);
-            annotation->figure = figure;
-            annotationLayer->addFigure(annotation->figure);
-        }
+        showPolygonFigure(p);
 
         TraCIScenarioManager* traci = TraCIScenarioManagerAccess().get();
         if (traci && traci->isConnected()) {
-            std::stringstream nameBuilder;
-            nameBuilder << "Annotation" << getEnvir()->getUniqueNumber();
-            traci->getCommandInterface()->addPolygon(nameBuilder.str(), "Annotation", TraCIColor::fromTkColor(p->color), false, 4, p->coords);
-            annotation->traciPolygonsIds.push_back(nameBuilder.str());
+            std::string id = makeTraCIPolygonId();
+            traci->getCommandInterface()->addPolygon(id, "Annotation", TraCIColor::fromTkColor(p->color), false, 4, p->coords);
+            annotation->traciPolygonsIds.push_back(id);
         }
     }
     else {
@@ -364,6 +379,31 @@ void AnnotationManager::show(const Annotation* annotation)
     }
 }
 
+void AnnotationManager::showPolygonFigure(const Polygon* polygon)
+{
+    ASSERT(polygon->coords.size() >= 2);
+
+    if (!hasGUI()) return;
+
+    cPolygonFigure* figure = new cPolygonFigure();
+    std::vector<cFigure::Point> points;
+    for (std::list<Coord>::const_iterator i = polygon->coords.begin(); i != polygon->coords.end(); ++i) {
+        points.push_back(cFigure::Point(i->x, i->y));
+    }
+    figure->setPoints(points);
+    figure->setLineColor(cFigure::Color(polygon->color.c_str()));
+    figure->setFilled(false);
+    polygon->figure = figure;
+    annotationLayer->addFigure(polygon->figure);
+}
+
+std::string AnnotationManager::makeTraCIPolygonId()
+{
+    std::stringstream nameBuilder;
+    nameBuilder << "Annotation" << getEnvir()->getUniqueNumber();
+    return nameBuilder.str();
+}
+
 void AnnotationManager::hide(const Annotation* annotation)
 {
     if (annotation->figure) {
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <list>
+#include <vector>
 
 #include "veins/veins.h"
 
@@ -145,6 +146,12 @@ public:
     Line* drawLine(Coord p1, Coord p2, std::string color, Group* group = nullptr);
     Polygon* drawPolygon(std::list<Coord> coords, std::string color, Group* group = nullptr);
     Polygon* drawPolygon(std::vector<Coord> coords, std::string color, Group* group = nullptr);
+    /**
+     * draws a batch of polygons, creating all annotations before any of them is shown.
+     *
+     * If connected to a TraCI server, all polygons are mirrored to it in a single message.
+     */
+    std::vector<Polygon*> drawPolygons(const std::vector<std::vector<Coord>>& shapes, std::string color, Group* group = nullptr);
     void drawBubble(Coord p1, std::string text);
     void erase(const Annotation* annotation);
     void eraseAll(Group* group = nullptr);
@@ -167,6 +174,16 @@ protected:
     Groups groups;
 
     cGroupFigure* annotationLayer;
+
+    /**
+     * adds a figure for a polygon to the annotation layer (if running with a GUI)
+     */
+    void showPolygonFigure(const Polygon* polygon);
+
+    /**
+     * returns a new id for an annotation mirrored to the TraCI server
+     */
+    std::string makeTraCIPolygonId();
 };
 
 class VEINS_API AnnotationManagerAccess {
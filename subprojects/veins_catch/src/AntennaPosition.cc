@@ -43,6 +43,11 @@ SCENARIO("Using AntennaPosition", "[toolbox]")
             REQUIRE(p.getPositionAt(1).x == 2);
         }
 
+        THEN("it was taken at t=0")
+        {
+            REQUIRE(p.getTime() == timeA);
+        }
+
         WHEN("compared with a different antenna")
         {
             int hostB = 2;
@@ -54,3 +59,28 @@ SCENARIO("Using AntennaPosition", "[toolbox]")
         }
     }
 }
+
+SCENARIO("Using AntennaPosition of a turning host", "[toolbox]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr)); // necessary so simtime_t works
+
+    GIVEN("An AntennaPosition at (0, 0, 0) moving by (1, 0, 0) each second after 0, turning by a quarter circle every 2 seconds")
+    {
+        const double pi = 3.14159265358979323846;
+        auto p = AntennaPosition(1, Coord(0, 0, 0), Coord(1, 0, 0), SimTime(0, SIMTIME_S), pi / 4);
+
+        THEN("it stays on a circle of radius 4/pi around (0, 4/pi, 0)")
+        {
+            Coord center(0, 4 / pi, 0);
+            for (int i = 1; i <= 8; ++i) {
+                REQUIRE(p.getPositionAt(i).distance(center) == Approx(4 / pi));
+            }
+        }
+
+        THEN("it completes a quarter circle at t=2")
+        {
+            REQUIRE(p.getPositionAt(2).x == Approx(4 / pi));
+            REQUIRE(p.getPositionAt(2).y == Approx(4 / pi));
+        }
+    }
+}
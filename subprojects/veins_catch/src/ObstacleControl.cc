@@ -0,0 +1,95 @@
+#include "catch2/catch.hpp"
+
+#include "veins/modules/obstacle/ObstacleControl.h"
+
+using Veins::Coord;
+using Veins::Obstacle;
+using Veins::ObstacleControl;
+
+SCENARIO("Simplifying obstacle shapes", "[obstacles]")
+{
+
+    GIVEN("A square with nearly collinear extra vertices and a repeated closing vertex")
+    {
+        Obstacle::Coords shape = {{0, 0}, {5, 0.01}, {10, 0}, {10, 5}, {10.02, 7}, {10, 10}, {0, 10}, {0, 0}};
+
+        WHEN("simplifying with a tolerance of 0.1 m")
+        {
+            auto simplified = ObstacleControl::simplifyShape(shape, 0.1);
+
+            THEN("only the four corners remain")
+            {
+                REQUIRE(simplified.size() == 4);
+                REQUIRE(simplified[0] == Coord(0, 0));
+                REQUIRE(simplified[1] == Coord(10, 0));
+                REQUIRE(simplified[2] == Coord(10, 10));
+                REQUIRE(simplified[3] == Coord(0, 10));
+            }
+        }
+
+        WHEN("simplifying with a tolerance of 0.001 m")
+        {
+            auto simplified = ObstacleControl::simplifyShape(shape, 0.001);
+
+            THEN("only the closing vertex is dropped")
+            {
+                REQUIRE(simplified.size() == 7);
+            }
+        }
+
+        WHEN("simplifying with a tolerance of 0 m")
+        {
+            auto simplified = ObstacleControl::simplifyShape(shape, 0);
+
+            THEN("only the closing vertex is dropped")
+            {
+                REQUIRE(simplified.size() == 7);
+            }
+        }
+    }
+}
+
+SCENARIO("Merging obstacle shapes", "[obstacles]")
+{
+
+    GIVEN("Two squares sharing an edge, one of them clockwise")
+    {
+        Obstacle::Coords a = {{0, 0}, {10, 0}, {10, 10}, {0, 10}};
+        Obstacle::Coords b = {{10, 0}, {10, 10}, {20, 10}, {20, 0}};
+
+        THEN("they merge into one rectangle")
+        {
+            Obstacle::Coords merged;
+            REQUIRE(ObstacleControl::mergeShapes(a, b, merged));
+            REQUIRE(merged.size() == 6);
+
+            auto simplified = ObstacleControl::simplifyShape(merged, 0.1);
+            REQUIRE(simplified.size() == 4);
+        }
+    }
+
+    GIVEN("Two squares sharing two consecutive edges")
+    {
+        Obstacle::Coords a = {{0, 0}, {10, 0}, {10, 5}, {10, 10}, {0, 10}};
+        Obstacle::Coords b = {{10, 0}, {20, 0}, {20, 10}, {10, 10}, {10, 5}};
+
+        THEN("the whole shared boundary is removed")
+        {
+            Obstacle::Coords merged;
+            REQUIRE(ObstacleControl::mergeShapes(a, b, merged));
+            REQUIRE(merged.size() == 6);
+        }
+    }
+
+    GIVEN("Two squares that only touch at a corner")
+    {
+        Obstacle::Coords a = {{0, 0}, {10, 0}, {10, 10}, {0, 10}};
+        Obstacle::Coords b = {{10, 10}, {20, 10}, {20, 20}, {10, 20}};
+
+        THEN("they are not merged")
+        {
+            Obstacle::Coords merged;
+            REQUIRE_FALSE(ObstacleControl::mergeShapes(a, b, merged));
+        }
+    }
+}
@@ -6,10 +6,22 @@
 #include "testutils/Simulation.h"
 
 using Veins::Coord;
+using Veins::Heading;
 using Veins::Signal;
 using Veins::Spectrum;
+using Veins::VehicleObstacle;
 using Veins::VehicleObstacleControl;
 
+namespace {
+
+class TestVehicleObstacleControl : public VehicleObstacleControl {
+public:
+    using VehicleObstacleControl::getFootprintCorners;
+    using VehicleObstacleControl::getFootprintPosition;
+};
+
+} // namespace
+
 SCENARIO("Using VehicleObstacleControl", "[vehicleObstacles]")
 {
     DummySimulation ds(new cNullEnvir(0, nullptr, nullptr)); // necessary so simtime_t works
@@ -87,3 +99,100 @@ SCENARIO("Using VehicleObstacleControl", "[vehicleObstacles]")
         }
     }
 }
+
+SCENARIO("Using a VehicleObstacle without TraCIMobility", "[vehicleObstacles]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr)); // necessary so simtime_t works
+
+    GIVEN("A 4m long and 2m wide vehicle with its front bumper at (10,10), heading east")
+    {
+        VehicleObstacle obstacle(std::vector<Veins::ChannelAccess*>(), nullptr, 4, 0, 2, 1.5);
+        obstacle.setPose(Coord(10, 10), Heading(0));
+
+        THEN("its shape extends from its front bumper backwards")
+        {
+            VehicleObstacle::Coords shape = obstacle.getShape(0);
+            REQUIRE(shape.size() == 4);
+            REQUIRE(shape[0].x == Approx(6));
+            REQUIRE(shape[0].y == Approx(9));
+            REQUIRE(shape[2].x == Approx(10));
+            REQUIRE(shape[2].y == Approx(11));
+        }
+
+        THEN("it stays where it is")
+        {
+            REQUIRE(obstacle.getVelocity() == Coord(0, 0));
+            REQUIRE(obstacle.maybeInBounds(0, 0, 20, 20, 100));
+            REQUIRE_FALSE(obstacle.maybeInBounds(20, 20, 30, 30, 100));
+        }
+
+        THEN("a transmission passing lengthwise is blocked at its rear bumper")
+        {
+            REQUIRE(obstacle.getIntersectionPoint(Coord(0, 10), Coord(20, 10), 0) == Approx(6));
+        }
+
+        WHEN("it is moved")
+        {
+            obstacle.setPose(Coord(30, 10), Heading(0));
+
+            THEN("its shape moves along")
+            {
+                REQUIRE(obstacle.getShape(0)[0].x == Approx(26));
+            }
+        }
+    }
+}
+
+SCENARIO("Extrapolating the footprint of a vehicle", "[vehicleObstacles]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr)); // necessary so simtime_t works
+
+    GIVEN("The footprint of a 4m long and 2m wide vehicle with its front bumper at (10,10), driving east at 10 m/s")
+    {
+        VehicleObstacleControl::Footprint f;
+        f.corners[0] = Coord(6, 9);
+        f.corners[1] = Coord(10, 9);
+        f.corners[2] = Coord(10, 11);
+        f.corners[3] = Coord(6, 11);
+        f.position = Coord(10, 10);
+        f.radius = Coord(4, 1).length();
+        f.velocity = Coord(10, 0);
+        f.yawRate = 0;
+        f.t = 0;
+
+        WHEN("it does not turn")
+        {
+            THEN("it moves along a straight line")
+            {
+                Coord position = TestVehicleObstacleControl::getFootprintPosition(f, 1);
+                Coord corners[4];
+                TestVehicleObstacleControl::getFootprintCorners(f, 1, position, corners);
+                REQUIRE(position.x == Approx(20));
+                REQUIRE(position.y == Approx(10));
+                REQUIRE(corners[0].x == Approx(16));
+                REQUIRE(corners[0].y == Approx(9));
+            }
+        }
+
+        WHEN("it turns left by 90 degrees per second")
+        {
+            f.yawRate = M_PI / 2;
+
+            THEN("it moves along the same arc as its host, turning along")
+            {
+                Coord position = TestVehicleObstacleControl::getFootprintPosition(f, 1);
+                Coord expected = Veins::Move::extrapolatePosition(f.position, f.velocity, f.yawRate, 1);
+                REQUIRE(position.x == Approx(expected.x));
+                REQUIRE(position.y == Approx(expected.y));
+
+                // now heading north, its rear bumper is 4m south of its front bumper
+                Coord corners[4];
+                TestVehicleObstacleControl::getFootprintCorners(f, 1, position, corners);
+                REQUIRE(corners[0].x == Approx(position.x + 1));
+                REQUIRE(corners[0].y == Approx(position.y - 4));
+                REQUIRE(corners[2].x == Approx(position.x - 1));
+                REQUIRE(corners[2].y == Approx(position.y));
+            }
+        }
+    }
+}
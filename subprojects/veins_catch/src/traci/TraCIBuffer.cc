@@ -0,0 +1,144 @@
+#include "catch2/catch.hpp"
+
+#include <sstream>
+
+#include "veins/modules/mobility/traci/TraCIBuffer.h"
+#include "veins/modules/mobility/traci/TraCIConstants.h"
+#include "veins/modules/mobility/traci/TraCICoord.h"
+
+using Veins::TraCIBuffer;
+using Veins::TraCICoord;
+using namespace Veins::TraCIConstants;
+
+namespace {
+
+/**
+ * builds a SIMSTEP response as sent by SUMO when Veins is subscribed to numVehicles vehicles
+ * (the same 8 variables TraCIScenarioManager::subscribeToVehicleVariables asks for)
+ */
+TraCIBuffer makeSimstepResponse(uint32_t numVehicles)
+{
+    TraCIBuffer buf;
+    buf << numVehicles;
+    for (uint32_t i = 0; i < numVehicles; ++i) {
+        std::ostringstream id;
+        id << "flow0." << i;
+
+        TraCIBuffer vars;
+        vars << static_cast<uint8_t>(8);
+        vars << VAR_POSITION << RTYPE_OK << TraCICoord(100.0 + i, 200.0 + i);
+        vars << VAR_ROAD_ID << RTYPE_OK << TYPE_STRING << std::string("-39539626#5");
+        vars << VAR_SPEED << RTYPE_OK << TYPE_DOUBLE << 13.89;
+        vars << VAR_ANGLE << RTYPE_OK << TYPE_DOUBLE << 87.5;
+        vars << VAR_SIGNALS << RTYPE_OK << TYPE_INTEGER << static_cast<int32_t>(8);
+        vars << VAR_LENGTH << RTYPE_OK << TYPE_DOUBLE << 5.0;
+        vars << VAR_HEIGHT << RTYPE_OK << TYPE_DOUBLE << 1.5;
+        vars << VAR_WIDTH << RTYPE_OK << TYPE_DOUBLE << 1.8;
+
+        std::string objectId = id.str();
+        uint32_t length = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint32_t) + objectId.size() + vars.size();
+        buf << static_cast<uint8_t>(0) << length << RESPONSE_SUBSCRIBE_VEHICLE_VARIABLE << objectId;
+        buf.reserve(vars.size());
+        for (size_t k = 0; k < vars.size(); ++k) buf << vars.data()[k];
+    }
+    return buf;
+}
+
+/**
+ * parses a response built by makeSimstepResponse the way TraCIScenarioManager does, returns the sum of all x positions
+ */
+double parseSimstepResponse(TraCIBuffer& buf)
+{
+    double sum = 0;
+    uint32_t count;
+    buf >> count;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint8_t cmdLength;
+        uint32_t cmdLengthExt;
+        uint8_t commandId;
+        buf >> cmdLength >> cmdLengthExt >> commandId;
+        TraCIBuffer::StringRef objectId = buf.readStringRef();
+        (void) objectId;
+
+        uint8_t numVars;
+        buf >> numVars;
+        for (uint8_t j = 0; j < numVars; ++j) {
+            uint8_t variable;
+            uint8_t status;
+            buf >> variable >> status;
+            if (variable == VAR_POSITION) {
+                TraCICoord p = buf.read<TraCICoord>();
+                sum += p.x;
+            }
+            else if (variable == VAR_ROAD_ID) {
+                buf.read<uint8_t>();
+                buf.readStringRef();
+            }
+            else if (variable == VAR_SIGNALS) {
+                buf.readTypeChecked<int32_t>(TYPE_INTEGER);
+            }
+            else {
+                buf.readTypeChecked<double>(TYPE_DOUBLE);
+            }
+        }
+    }
+    return sum;
+}
+
+} // namespace
+
+SCENARIO("TraCIBuffer uses TraCI byte order", "[traci]")
+{
+    GIVEN("A buffer with an integer, a double, and a string written to it")
+    {
+        TraCIBuffer buf;
+        buf << static_cast<int32_t>(0x01020304) << 1.5 << std::string("veh0");
+
+        THEN("the integer is stored in network byte order")
+        {
+            REQUIRE(buf.size() == 4 + 8 + 4 + 4);
+            REQUIRE(buf.data()[0] == 0x01);
+            REQUIRE(buf.data()[3] == 0x04);
+        }
+
+        THEN("all values can be read back in order")
+        {
+            REQUIRE(buf.read<int32_t>() == 0x01020304);
+            REQUIRE(buf.read<double>() == 1.5);
+            REQUIRE(buf.readStringRef() == std::string("veh0"));
+            REQUIRE(buf.eof());
+        }
+
+        THEN("reading past its end fails")
+        {
+            buf.read<int32_t>();
+            buf.read<double>();
+            buf.read<int32_t>();
+            REQUIRE_THROWS(buf.read<double>());
+        }
+    }
+}
+
+SCENARIO("TraCIBuffer parses a SIMSTEP response", "[traci]")
+{
+    GIVEN("A SIMSTEP response for 5000 subscribed vehicles")
+    {
+        const uint32_t numVehicles = 5000;
+        TraCIBuffer response = makeSimstepResponse(numVehicles);
+        std::string bytes = response.str();
+
+        THEN("all subscription results are parsed")
+        {
+            TraCIBuffer buf(bytes);
+            double sum = parseSimstepResponse(buf);
+            REQUIRE(buf.eof());
+            REQUIRE(sum == Approx(100.0 * numVehicles + (numVehicles - 1) * numVehicles / 2.0));
+        }
+
+        BENCHMARK("parse SIMSTEP response for 5000 vehicles")
+        {
+            TraCIBuffer buf(bytes);
+            parseSimstepResponse(buf);
+        }
+    }
+}
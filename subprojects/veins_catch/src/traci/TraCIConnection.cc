@@ -0,0 +1,248 @@
+#include "catch2/catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "veins/modules/mobility/traci/TraCIConnection.h"
+#include "veins/modules/mobility/traci/TraCIConstants.h"
+#include "testutils/Simulation.h"
+
+using Veins::TraCIBuffer;
+using Veins::TraCIConnection;
+using namespace Veins::TraCIConstants;
+
+namespace {
+
+void appendStatus(TraCIBuffer& buf, uint8_t commandId, uint8_t resultCode, std::string description = "")
+{
+    Veins::appendTraCICommand(buf, commandId, TraCIBuffer() << resultCode << description);
+}
+
+/**
+ * parameters of a CMD_SUBSCRIBE_VEHICLE_VARIABLE command (no variables: unsubscribe)
+ */
+TraCIBuffer subscription(std::string vehicleId, std::vector<uint8_t> variables)
+{
+    TraCIBuffer buf;
+    buf << simtime_t(0) << SimTime::getMaxTime() << vehicleId << static_cast<uint8_t>(variables.size());
+    for (uint8_t variable : variables) buf << variable;
+    return buf;
+}
+
+/**
+ * writes a recorded TraCI session holding a single GET_VERSION command and its response
+ */
+void writeSession(const char* fileName)
+{
+    TraCIBuffer request;
+    request << static_cast<uint32_t>(4 + 2) << static_cast<uint8_t>(2) << CMD_GETVERSION;
+
+    TraCIBuffer response;
+    appendStatus(response, CMD_GETVERSION, RTYPE_OK);
+    Veins::appendTraCICommand(response, CMD_GETVERSION, TraCIBuffer() << static_cast<int32_t>(20) << std::string("SUMO 1.2.0"));
+
+    std::ofstream out(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    out << "veins-traci-session-1\n";
+    for (auto msg : {std::make_pair('S', &request), std::make_pair('R', &response)}) {
+        TraCIBuffer length;
+        length << static_cast<uint32_t>(msg.second->size());
+        out << msg.first << length.str() << msg.second->str();
+    }
+}
+
+} // namespace
+
+SCENARIO("TraCIConnection replays a recorded session", "[traci]")
+{
+    GIVEN("A recorded session of a single GET_VERSION command")
+    {
+        const char* fileName = "TraCIConnection-session.bin";
+        writeSession(fileName);
+        std::unique_ptr<TraCIConnection> connection(TraCIConnection::replay(nullptr, fileName));
+        std::remove(fileName);
+
+        REQUIRE(connection->isReplaying());
+
+        THEN("sending the same command yields the recorded response")
+        {
+            TraCIBuffer buf = connection->query(CMD_GETVERSION, TraCIBuffer());
+            buf.read<uint8_t>();
+            REQUIRE(buf.read<uint8_t>() == CMD_GETVERSION);
+            REQUIRE(buf.read<int32_t>() == 20);
+            REQUIRE(buf.read<std::string>() == "SUMO 1.2.0");
+        }
+
+        THEN("sending a different command is reported as divergence")
+        {
+            REQUIRE_THROWS(connection->query(CMD_CLOSE, TraCIBuffer()));
+        }
+
+        THEN("sending more commands than recorded is reported as divergence")
+        {
+            connection->query(CMD_GETVERSION, TraCIBuffer());
+            REQUIRE_THROWS(connection->query(CMD_GETVERSION, TraCIBuffer()));
+        }
+    }
+}
+
+SCENARIO("TraCIConnection::Batch demultiplexes responses", "[traci]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr)); // necessary so simtime_t works
+
+    GIVEN("A batch subscribing to two vehicles and unsubscribing from a third")
+    {
+        TraCIConnection::Batch batch;
+        batch.add(CMD_SUBSCRIBE_VEHICLE_VARIABLE, subscription("veh0", {VAR_SPEED}));
+        batch.add(CMD_SUBSCRIBE_VEHICLE_VARIABLE, subscription("veh1", {VAR_SPEED}));
+        batch.add(CMD_SUBSCRIBE_VEHICLE_VARIABLE, subscription("veh2", {}));
+
+        THEN("all commands are queued back to back")
+        {
+            REQUIRE(batch.size() == 3);
+            REQUIRE(batch.getCommands().size() == 2 * Veins::traCICommandLength(subscription("veh0", {VAR_SPEED})) + Veins::traCICommandLength(subscription("veh2", {})));
+        }
+
+        WHEN("the server responds to all of them in one message")
+        {
+            // a subscription response long enough to need an extended length field
+            TraCIBuffer vars;
+            vars << std::string(300, 'x');
+
+            TraCIBuffer response;
+            appendStatus(response, CMD_SUBSCRIBE_VEHICLE_VARIABLE, RTYPE_OK);
+            Veins::appendTraCICommand(response, RESPONSE_SUBSCRIBE_VEHICLE_VARIABLE, TraCIBuffer() << std::string("veh0"));
+            appendStatus(response, CMD_SUBSCRIBE_VEHICLE_VARIABLE, RTYPE_OK);
+            Veins::appendTraCICommand(response, RESPONSE_SUBSCRIBE_VEHICLE_VARIABLE, TraCIBuffer() << std::string("veh1") << vars.str());
+            appendStatus(response, CMD_SUBSCRIBE_VEHICLE_VARIABLE, RTYPE_OK);
+
+            THEN("each command gets its own response")
+            {
+                std::vector<size_t> responseSizes;
+                batch.demultiplex(response, [&](size_t index, TraCIBuffer& buf) {
+                    REQUIRE(index == responseSizes.size());
+                    responseSizes.push_back(buf.remaining());
+                    if (index < 2) {
+                        uint8_t cmdLength;
+                        buf >> cmdLength;
+                        if (cmdLength == 0) buf.read<uint32_t>();
+                        REQUIRE(buf.read<uint8_t>() == RESPONSE_SUBSCRIBE_VEHICLE_VARIABLE);
+                        REQUIRE(buf.read<std::string>() == (index == 0 ? "veh0" : "veh1"));
+                        buf.readRaw(vars, buf.remaining());
+                    }
+                });
+                REQUIRE(response.eof());
+                REQUIRE(responseSizes.size() == 3);
+                REQUIRE(responseSizes[0] == 1 + 1 + 4 + 4);
+                REQUIRE(responseSizes[1] > 0xFF);
+                REQUIRE(responseSizes[2] == 0);
+            }
+        }
+
+        WHEN("the server reports an error for one of them")
+        {
+            TraCIBuffer response;
+            appendStatus(response, CMD_SUBSCRIBE_VEHICLE_VARIABLE, RTYPE_OK);
+            Veins::appendTraCICommand(response, RESPONSE_SUBSCRIBE_VEHICLE_VARIABLE, TraCIBuffer() << std::string("veh0"));
+            appendStatus(response, CMD_SUBSCRIBE_VEHICLE_VARIABLE, RTYPE_ERR, "no such vehicle");
+            appendStatus(response, CMD_SUBSCRIBE_VEHICLE_VARIABLE, RTYPE_OK);
+
+            THEN("the error is reported for this command only, which gets no response")
+            {
+                std::vector<TraCIConnection::Result> results;
+                batch.demultiplex(response, [](size_t index, TraCIBuffer& buf) { REQUIRE(buf.eof() == (index != 0)); }, &results);
+                REQUIRE(results.size() == 3);
+                REQUIRE(results[0].success);
+                REQUIRE_FALSE(results[1].success);
+                REQUIRE(results[1].message == "no such vehicle");
+                REQUIRE(results[2].success);
+            }
+
+            THEN("without results, the error throws")
+            {
+                REQUIRE_THROWS(batch.demultiplex(response, [](size_t, TraCIBuffer&) {}));
+            }
+        }
+    }
+
+    GIVEN("A batch asking for the version twice")
+    {
+        TraCIConnection::Batch batch;
+        batch.add(CMD_GETVERSION);
+        batch.add(CMD_GETVERSION);
+
+        WHEN("the server responds with responses that echo the id of the next command")
+        {
+            TraCIBuffer response;
+            for (int i = 0; i < 2; ++i) {
+                appendStatus(response, CMD_GETVERSION, RTYPE_OK);
+                Veins::appendTraCICommand(response, CMD_GETVERSION, TraCIBuffer() << static_cast<int32_t>(20) << std::string("SUMO 1.2.0"));
+            }
+
+            THEN("each command still gets its own response")
+            {
+                size_t count = 0;
+                batch.demultiplex(response, [&](size_t index, TraCIBuffer& buf) {
+                    REQUIRE(index == count++);
+                    buf.read<uint8_t>();
+                    REQUIRE(buf.read<uint8_t>() == CMD_GETVERSION);
+                    REQUIRE(buf.read<int32_t>() == 20);
+                    REQUIRE(buf.read<std::string>() == "SUMO 1.2.0");
+                    REQUIRE(buf.eof());
+                });
+                REQUIRE(response.eof());
+                REQUIRE(count == 2);
+            }
+        }
+    }
+
+    GIVEN("A batch ending in a simulation step")
+    {
+        TraCIConnection::Batch batch;
+        batch.add(CMD_SIMSTEP2, TraCIBuffer() << 1.0);
+
+        THEN("no further commands can be added")
+        {
+            REQUIRE_THROWS(batch.add(CMD_GET_VEHICLE_VARIABLE, TraCIBuffer()));
+        }
+    }
+}
+
+SCENARIO("TraCIConnection tells getters from commands that change state", "[traci]")
+{
+    THEN("retrieving and subscribing to values does not change state")
+    {
+        REQUIRE_FALSE(TraCIConnection::mayChangeState(CMD_GETVERSION));
+        REQUIRE_FALSE(TraCIConnection::mayChangeState(CMD_GET_VEHICLE_VARIABLE));
+        REQUIRE_FALSE(TraCIConnection::mayChangeState(CMD_SUBSCRIBE_VEHICLE_VARIABLE));
+        REQUIRE_FALSE(TraCIConnection::mayChangeState(CMD_SUBSCRIBE_SIM_CONTEXT));
+    }
+
+    THEN("steps and setters may change state")
+    {
+        REQUIRE(TraCIConnection::mayChangeState(CMD_SIMSTEP2));
+        REQUIRE(TraCIConnection::mayChangeState(CMD_SET_VEHICLE_VARIABLE));
+    }
+
+    GIVEN("A batch of subscriptions")
+    {
+        DummySimulation ds(new cNullEnvir(0, nullptr, nullptr)); // necessary so simtime_t works
+
+        TraCIConnection::Batch batch;
+        batch.add(CMD_SUBSCRIBE_VEHICLE_VARIABLE, subscription("veh0", {VAR_SPEED}));
+        REQUIRE_FALSE(batch.mayChangeState());
+
+        WHEN("a setter is added")
+        {
+            batch.add(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << std::string("veh0"));
+
+            THEN("the batch may change state until it is cleared")
+            {
+                REQUIRE(batch.mayChangeState());
+                batch.clear();
+                REQUIRE_FALSE(batch.mayChangeState());
+            }
+        }
+    }
+}
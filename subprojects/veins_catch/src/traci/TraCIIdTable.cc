@@ -0,0 +1,59 @@
+#include "catch2/catch.hpp"
+
+#include "veins/modules/mobility/traci/TraCIIdTable.h"
+
+using Veins::TraCIBuffer;
+using Veins::TraCIIdTable;
+
+SCENARIO("TraCIIdTable assigns dense handles", "[traci]")
+{
+    GIVEN("A table with three ids interned")
+    {
+        TraCIIdTable table;
+        TraCIIdTable::Handle a = table.intern("veh0");
+        TraCIIdTable::Handle b = table.intern("veh1");
+        TraCIIdTable::Handle c = table.intern("veh2");
+
+        THEN("handles are dense and map back to their ids")
+        {
+            REQUIRE(a == 0);
+            REQUIRE(b == 1);
+            REQUIRE(c == 2);
+            REQUIRE(table.size() == 3);
+            REQUIRE(table.getHandleBound() == 3);
+            REQUIRE(table.getId(b) == "veh1");
+        }
+
+        THEN("interning a known id returns its handle")
+        {
+            REQUIRE(table.intern("veh1") == b);
+            REQUIRE(table.size() == 3);
+        }
+
+        THEN("ids can be looked up straight from a buffer")
+        {
+            TraCIBuffer buf;
+            buf << std::string("veh2") << std::string("veh3");
+            REQUIRE(table.find(buf.readStringRef()) == c);
+            REQUIRE(table.find(buf.readStringRef()) == TraCIIdTable::invalidHandle);
+        }
+
+        WHEN("an id is released")
+        {
+            table.release(b);
+
+            THEN("it is no longer known")
+            {
+                REQUIRE(table.find("veh1") == TraCIIdTable::invalidHandle);
+                REQUIRE(table.size() == 2);
+            }
+
+            THEN("its handle is reused for the next new id")
+            {
+                REQUIRE(table.intern("veh3") == b);
+                REQUIRE(table.getId(b) == "veh3");
+                REQUIRE(table.getHandleBound() == 3);
+            }
+        }
+    }
+}
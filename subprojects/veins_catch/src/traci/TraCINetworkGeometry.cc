@@ -0,0 +1,55 @@
+#include "catch2/catch.hpp"
+
+#include <cstdio>
+
+#include "veins/modules/mobility/traci/TraCINetworkGeometry.h"
+
+using Veins::Coord;
+using Veins::TraCINetworkGeometry;
+
+SCENARIO("TraCINetworkGeometry stores lane shapes and junction positions", "[traci]")
+{
+    GIVEN("The geometry of two lanes and a junction")
+    {
+        TraCINetworkGeometry geometry;
+        geometry.addLaneShape("lane0", {Coord(0, 0), Coord(10, 0)});
+        geometry.addLaneShape("lane1", {Coord(10, 0), Coord(10, 5), Coord(20, 5)});
+        geometry.addJunctionPosition("junction0", Coord(10, 0));
+
+        THEN("each lane gets its own shape back")
+        {
+            std::list<Coord> shape;
+            REQUIRE(geometry.findLaneShape("lane1", shape));
+            REQUIRE(shape == std::list<Coord>({Coord(10, 0), Coord(10, 5), Coord(20, 5)}));
+            REQUIRE(geometry.findLaneShape("lane0", shape));
+            REQUIRE(shape == std::list<Coord>({Coord(0, 0), Coord(10, 0)}));
+            REQUIRE_FALSE(geometry.findLaneShape("lane2", shape));
+        }
+
+        WHEN("it is saved and loaded again")
+        {
+            const char* fileName = "TraCINetworkGeometry.netgeo";
+            geometry.save(fileName, "key");
+            TraCINetworkGeometry loaded;
+            bool loadedWithOtherKey = loaded.load(fileName, "other key");
+            bool loadedWithSameKey = loaded.load(fileName, "key");
+            std::remove(fileName);
+
+            THEN("it is only accepted with the same key, and then complete")
+            {
+                REQUIRE_FALSE(loadedWithOtherKey);
+                REQUIRE(loadedWithSameKey);
+                REQUIRE(loaded.isComplete());
+                REQUIRE(loaded.getLaneIds() == std::list<std::string>({"lane0", "lane1"}));
+
+                std::list<Coord> shape;
+                REQUIRE(loaded.findLaneShape("lane1", shape));
+                REQUIRE(shape.size() == 3);
+                REQUIRE(shape.back() == Coord(20, 5));
+                Coord position;
+                REQUIRE(loaded.findJunctionPosition("junction0", position));
+                REQUIRE(position == Coord(10, 0));
+            }
+        }
+    }
+}
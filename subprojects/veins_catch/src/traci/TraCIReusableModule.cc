@@ -0,0 +1,75 @@
+#include "catch2/catch.hpp"
+
+#include "veins/modules/mobility/traci/TraCIReusableModule.h"
+#include "testutils/Simulation.h"
+
+using Veins::TraCIReusableModule;
+
+namespace {
+
+class TestReusableModule : public TraCIReusableModule {
+public:
+    void prepareForReuse() override
+    {
+    }
+
+    void reinitialize(int stage) override
+    {
+    }
+
+    using TraCIReusableModule::isForPreviousVehicle;
+};
+
+/**
+ * a message as the simulation kernel leaves it after sending it in event sentIn, either to another module or (if toGate is -1) to the sender itself
+ */
+void send(cMessage& msg, eventnumber_t sentIn, int toGate)
+{
+    msg.setPreviousEventNumber(sentIn);
+    msg.setArrival(1, toGate);
+}
+
+} // namespace
+
+SCENARIO("Telling messages for a reused module apart", "[traci]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr)); // necessary so simtime_t works
+
+    GIVEN("A module that was pooled and handed to a new vehicle in event 10, as when one vehicle arrives and another departs in the same timestep")
+    {
+        const eventnumber_t pooledAt = 10;
+
+        THEN("a frame another module sent before is for the previous vehicle")
+        {
+            cMessage frame("frame");
+            send(frame, 9, 0);
+            REQUIRE(TestReusableModule::isForPreviousVehicle(&frame, pooledAt));
+        }
+
+        THEN("a message sent to it after it was handed to the new vehicle is for the new one")
+        {
+            cMessage wsm("wsm");
+            send(wsm, 10, 0);
+            REQUIRE_FALSE(TestReusableModule::isForPreviousVehicle(&wsm, pooledAt));
+            send(wsm, 11, 0);
+            REQUIRE_FALSE(TestReusableModule::isForPreviousVehicle(&wsm, pooledAt));
+        }
+
+        THEN("timers it scheduled again while being reinitialized are never dropped")
+        {
+            cMessage timer("timer");
+            send(timer, 10, -1);
+            REQUIRE_FALSE(TestReusableModule::isForPreviousVehicle(&timer, pooledAt));
+        }
+    }
+
+    GIVEN("A module that was never pooled")
+    {
+        THEN("no message is for a previous vehicle")
+        {
+            cMessage frame("frame");
+            send(frame, 0, 0);
+            REQUIRE_FALSE(TestReusableModule::isForPreviousVehicle(&frame, -1));
+        }
+    }
+}
@@ -0,0 +1,229 @@
+#include "catch2/catch.hpp"
+
+#include "veins/modules/mobility/traci/TraCIScenarioManager.h"
+#include "veins/modules/mobility/traci/TraCIConstants.h"
+#include "veins/modules/obstacle/VehicleObstacleControl.h"
+#include "testutils/Simulation.h"
+
+using Veins::Coord;
+using Veins::Heading;
+using Veins::TraCIBuffer;
+using Veins::TraCIConnection;
+using Veins::TraCIIdTable;
+using Veins::TraCIScenarioManager;
+using Veins::VehicleObstacleControl;
+
+namespace {
+
+class TestVehicleObstacleControl : public VehicleObstacleControl {
+public:
+    size_t size() const
+    {
+        return vehicleObstacles.size();
+    }
+};
+
+/**
+ * exposes the vehicle bookkeeping of TraCIScenarioManager, without connecting to a TraCI server
+ */
+class TestScenarioManager : public TraCIScenarioManager {
+public:
+    TestScenarioManager(VehicleObstacleControl* obstacles)
+    {
+        vehicleObstacleControl = obstacles;
+        lazyModuleDistance = 100;
+        lazyModuleConnectionManager = nullptr;
+        unEquippedHostCount = 0;
+    }
+
+    TraCIIdTable::Handle subscribe(const std::string& nodeId)
+    {
+        TraCIIdTable::Handle handle = vehicleIds.intern(nodeId);
+        VehicleRecord& record = getVehicleRecord(handle);
+        record.subscribed = true;
+        record.attributes.typeId = "car";
+        record.attributes.length = 4;
+        record.attributes.height = 1.5;
+        record.attributes.width = 2;
+        return handle;
+    }
+
+    /**
+     * what every backend does for a vehicle that left the simulation
+     */
+    void arrive(TraCIIdTable::Handle handle)
+    {
+        getVehicleRecord(handle).subscribed = false;
+        getVehicleRecord(handle).attributes = VehicleStaticAttributes();
+        forgetVehicle(handle);
+    }
+
+    TraCIIdTable::Handle find(const std::string& nodeId) const
+    {
+        return vehicleIds.find(nodeId);
+    }
+
+    bool isDormant(TraCIIdTable::Handle handle)
+    {
+        return getVehicleRecord(handle).dormant;
+    }
+
+    bool isModuleRequested(TraCIIdTable::Handle handle)
+    {
+        return getVehicleRecord(handle).moduleRequested;
+    }
+
+    void setSlowUpdateInterval(simtime_t interval)
+    {
+        slowUpdateInterval = interval;
+    }
+
+    const TraCIConnection::Batch& getPendingSubscriptions() const
+    {
+        return pendingSubscriptions;
+    }
+
+    using TraCIScenarioManager::isModuleDeferred;
+    using TraCIScenarioManager::updateDormantVehicle;
+    using TraCIScenarioManager::updateSubscriptionRate;
+};
+
+/**
+ * a CMD_SUBSCRIBE_VEHICLE_VARIABLE command as queued in a batch
+ */
+struct Subscription {
+    simtime_t beginTime;
+    std::string vehicleId;
+    uint8_t variableCount;
+};
+
+std::vector<Subscription> readSubscriptions(const TraCIConnection::Batch& batch)
+{
+    std::vector<Subscription> subscriptions;
+    TraCIBuffer buf = batch.getCommands();
+    while (!buf.eof()) {
+        buf.read<uint8_t>(); // command length
+        REQUIRE(buf.read<uint8_t>() == Veins::TraCIConstants::CMD_SUBSCRIBE_VEHICLE_VARIABLE);
+        Subscription subscription;
+        subscription.beginTime = buf.read<simtime_t>();
+        buf.read<simtime_t>(); // end time
+        subscription.vehicleId = buf.read<std::string>();
+        subscription.variableCount = buf.read<uint8_t>();
+        for (uint8_t i = 0; i < subscription.variableCount; ++i) buf.read<uint8_t>();
+        subscriptions.push_back(subscription);
+    }
+    return subscriptions;
+}
+
+} // namespace
+
+SCENARIO("Forgetting dormant vehicles", "[traci]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr)); // necessary so simtime_t works
+
+    TestVehicleObstacleControl obstacles;
+    TestScenarioManager manager(&obstacles);
+
+    GIVEN("A vehicle that is dormant, with an obstacle standing in for its module")
+    {
+        TraCIIdTable::Handle handle = manager.subscribe("veh0");
+        manager.updateDormantVehicle(handle, Coord(50, 50), Heading(0));
+
+        REQUIRE(manager.isDormant(handle));
+        REQUIRE(obstacles.size() == 1);
+
+        WHEN("its module is requested")
+        {
+            REQUIRE(manager.requestModule("veh0"));
+
+            THEN("it is no longer deferred")
+            {
+                REQUIRE(manager.isModuleRequested(handle));
+                REQUIRE_FALSE(manager.isModuleDeferred(handle, Coord(50, 50)));
+            }
+
+            AND_WHEN("it arrives before its module was created")
+            {
+                manager.arrive(handle);
+
+                THEN("its obstacle is removed and its handle released")
+                {
+                    REQUIRE(obstacles.size() == 0);
+                    REQUIRE(manager.find("veh0") == TraCIIdTable::invalidHandle);
+                }
+
+                THEN("a vehicle reusing its id starts afresh")
+                {
+                    TraCIIdTable::Handle reused = manager.subscribe("veh0");
+                    REQUIRE_FALSE(manager.isDormant(reused));
+                    REQUIRE_FALSE(manager.isModuleRequested(reused));
+                }
+            }
+        }
+
+        WHEN("it arrives while still dormant")
+        {
+            manager.arrive(handle);
+
+            THEN("its obstacle is removed and its handle released")
+            {
+                REQUIRE(obstacles.size() == 0);
+                REQUIRE(manager.find("veh0") == TraCIIdTable::invalidHandle);
+            }
+        }
+    }
+
+    GIVEN("No vehicle")
+    {
+        THEN("a module cannot be requested")
+        {
+            REQUIRE_FALSE(manager.requestModule("veh0"));
+        }
+    }
+}
+
+SCENARIO("Changing the subscription rate of vehicles", "[traci]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr)); // necessary so simtime_t works
+
+    TestVehicleObstacleControl obstacles;
+    TestScenarioManager manager(&obstacles);
+    manager.setSlowUpdateInterval(1);
+
+    GIVEN("A vehicle without a module")
+    {
+        TraCIIdTable::Handle handle = manager.subscribe("veh0");
+
+        WHEN("it is found not to matter")
+        {
+            manager.updateSubscriptionRate(handle, Coord(50, 50), 10);
+
+            THEN("its subscription is cancelled before subscribing again at the reduced rate")
+            {
+                std::vector<Subscription> subscriptions = readSubscriptions(manager.getPendingSubscriptions());
+                REQUIRE(subscriptions.size() == 2);
+                REQUIRE(subscriptions[0].vehicleId == "veh0");
+                REQUIRE(subscriptions[0].variableCount == 0);
+                REQUIRE(subscriptions[1].vehicleId == "veh0");
+                REQUIRE(subscriptions[1].variableCount > 0);
+                REQUIRE(subscriptions[1].beginTime == simTime() + 1);
+            }
+
+            AND_WHEN("it is dormant and its module is requested")
+            {
+                manager.updateDormantVehicle(handle, Coord(50, 50), Heading(0));
+                REQUIRE(manager.requestModule("veh0"));
+                manager.updateSubscriptionRate(handle, Coord(50, 50), 10);
+
+                THEN("its subscription is cancelled again before subscribing at full rate")
+                {
+                    std::vector<Subscription> subscriptions = readSubscriptions(manager.getPendingSubscriptions());
+                    REQUIRE(subscriptions.size() == 4);
+                    REQUIRE(subscriptions[2].variableCount == 0);
+                    REQUIRE(subscriptions[3].variableCount > 0);
+                    REQUIRE(subscriptions[3].beginTime == simTime());
+                }
+            }
+        }
+    }
+}
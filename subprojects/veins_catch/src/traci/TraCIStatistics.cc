@@ -0,0 +1,54 @@
+#include "catch2/catch.hpp"
+
+#include <sstream>
+
+#include "veins/modules/mobility/traci/TraCIStatistics.h"
+
+using Veins::TraCIStatistics;
+
+SCENARIO("TraCIStatistics sorts durations into buckets", "[traci]")
+{
+    GIVEN("A histogram of a fast and two slow round trips")
+    {
+        TraCIStatistics::Histogram histogram;
+        histogram.record(std::chrono::microseconds(3));
+        histogram.record(std::chrono::milliseconds(10));
+        histogram.record(std::chrono::milliseconds(12));
+
+        THEN("count, sum, and maximum are exact")
+        {
+            REQUIRE(histogram.getCount() == 3);
+            REQUIRE(histogram.getSum() == Approx(0.022003));
+            REQUIRE(histogram.getMax() == Approx(0.012));
+        }
+
+        THEN("each duration falls into the bucket reaching up to the next power of two microseconds")
+        {
+            REQUIRE(histogram.getBucket(2) == 1); // 2 us to 4 us
+            REQUIRE(histogram.getBucket(14) == 2); // 8192 us to 16384 us
+        }
+
+        THEN("quantiles are estimated by bucket, but never beyond the maximum")
+        {
+            REQUIRE(histogram.getQuantile(0.3) == Approx(4e-6));
+            REQUIRE(histogram.getQuantile(0.99) == Approx(0.012));
+        }
+    }
+
+    GIVEN("Statistics of a single command")
+    {
+        TraCIStatistics statistics;
+        statistics.getCommand(0xa4).count = 1;
+        statistics.getCommand(0xa4).roundTrip.record(std::chrono::microseconds(100));
+
+        THEN("only that command is written as JSON")
+        {
+            std::ostringstream out;
+            statistics.writeJson(out, 5);
+            std::string json = out.str();
+            REQUIRE(json.find("\"0xa4\":{\"count\":1,") != std::string::npos);
+            REQUIRE(json.find("\"0x00\"") == std::string::npos);
+            REQUIRE(json.back() == '\n');
+        }
+    }
+}